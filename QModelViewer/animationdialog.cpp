@@ -158,6 +158,25 @@ void AnimationDialog::enableTimePointsCombo(bool b)
     ui->comboBoxTimePoints->setEnabled(b);
 }
 
+// Adds the time points past the end of the current list, keeping the
+// selected time point
+void AnimationDialog::appendTimePoints(const QStringList& labels)
+{
+    for (int i = timePointLabels.size(); i < labels.size(); ++i)
+    {
+        ui->comboBoxTimePoints->addItem(labels[i]);
+    }
+    timePointLabels = labels;
+    if (timePointLabels.size() > 1)
+    {
+        ui->pushButtonSet->setEnabled(true);
+        ui->comboBoxAnimationType->setEnabled(true);
+#if !defined(DONT_DISABLE_LABELS)
+        ui->labelAnimationType->setEnabled(true);
+#endif
+    }
+}
+
 void AnimationDialog::reinitialize()
 {
     // Controls
@@ -42,6 +42,7 @@ public:
     void        enableAdvance(bool b);
     void        enableSet(bool b);
     void        enableTimePointsCombo(bool b);
+    void        appendTimePoints(const QStringList& labels);
 
     AnimationType animationType;
     int           numberOfSteps;
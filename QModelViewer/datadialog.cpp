@@ -15,6 +15,7 @@ DataDialog::DataDialog(QWidget *parent, MvDoc *doc)
     ui->tabWidget->removeTab(2);
 
     connect(ui->comboBoxDataType, QOverload<int>::of(&QComboBox::currentIndexChanged), [=](int idx) { doc->setScalarDataTypeTo(idx); });
+    connect(ui->comboBoxReferenceTime, QOverload<int>::of(&QComboBox::currentIndexChanged), [=](int idx) { doc->setReferenceTimePoint(idx); });
     connect(ui->pushButtonDone, &QAbstractButton::clicked, [=]() { hide(); });
 }
 
@@ -42,10 +43,12 @@ void DataDialog::reinitialize()
 {
     // scalar
     QSignalBlocker comboBlocker(ui->comboBoxDataType);
+    QSignalBlocker referenceBlocker(ui->comboBoxReferenceTime);
 
     ui->lineEditScalarMin->setText("");
     ui->lineEditScalarMax->setText("");
     ui->comboBoxDataType->clear();
+    ui->comboBoxReferenceTime->clear();
 
     // vector
     ui->lineEditVectorMin->setText("");
@@ -95,6 +98,7 @@ void DataDialog::setPathlineTimeRange(double *range) // std::pair<double> range
 void DataDialog::activate(bool b)
 {
     ui->comboBoxDataType->setEnabled(b);
+    ui->comboBoxReferenceTime->setEnabled(b);
 }
 
 void DataDialog::setCurrentIndex(int index)
@@ -110,3 +114,12 @@ void DataDialog::setDataTypeLabels(QStringList labels, int idx)
     ui->comboBoxDataType->insertItems(0, labels);
     ui->comboBoxDataType->setCurrentIndex(idx);
 }
+
+void DataDialog::setReferenceTimeLabels(QStringList labels, int idx)
+{
+    QSignalBlocker comboBlocker(ui->comboBoxReferenceTime);
+
+    ui->comboBoxReferenceTime->clear();
+    ui->comboBoxReferenceTime->insertItems(0, labels);
+    ui->comboBoxReferenceTime->setCurrentIndex(idx);
+}
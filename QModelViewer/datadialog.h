@@ -20,6 +20,7 @@ public:
     void        activate(bool b);
 
     void        setDataTypeLabels(QStringList labels, int idx);
+    void        setReferenceTimeLabels(QStringList labels, int idx);
 
     void        setCurrentIndex(int index);
 
@@ -99,7 +99,7 @@ char *DataFilesDialog::GetModflow6DataFiles(QWidget *parent /* = nullptr */)
             //_chdir(name.left(pos).toLocal8Bit().data());
             QDir::setCurrent(name.left(pos));
         }
-        dataFileList = new char[name.size() + 20];
+        dataFileList = new char[name.size() + dlg.comparisonHeadFile.size() + 20];
         strcpy(dataFileList, name.toLocal8Bit().data());
         strcat(dataFileList, "\n");
     }
@@ -114,7 +114,7 @@ char *DataFilesDialog::GetModflow6DataFiles(QWidget *parent /* = nullptr */)
         QString headOrConcFile = dlg.headOrConcFile;
         QString budgetFile     = dlg.budgetFile;
 
-        dataFileList           = new char[gridFile.size() + headOrConcFile.size() + budgetFile.size() + 20];
+        dataFileList           = new char[gridFile.size() + headOrConcFile.size() + budgetFile.size() + dlg.comparisonHeadFile.size() + 20];
         // no name file
         strcpy(dataFileList, "\n");
         strcat(dataFileList, gridFile.toLocal8Bit().data());
@@ -124,5 +124,11 @@ char *DataFilesDialog::GetModflow6DataFiles(QWidget *parent /* = nullptr */)
         strcat(dataFileList, budgetFile.toLocal8Bit().data());
         strcat(dataFileList, "\n");
     }
+    // The optional comparison head file follows the other files
+    if (!dlg.comparisonHeadFile.isEmpty())
+    {
+        strcat(dataFileList, dlg.comparisonHeadFile.toLocal8Bit().data());
+        strcat(dataFileList, "\n");
+    }
     return dataFileList;
 }
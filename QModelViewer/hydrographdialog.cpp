@@ -0,0 +1,49 @@
+#include "hydrographdialog.h"
+#include "ui_hydrographdialog.h"
+
+#include <mvdoc.h>
+
+HydrographDialog::HydrographDialog(QWidget *parent, MvDoc *doc)
+    : QDialog(parent, Qt::WindowCloseButtonHint)
+    , ui(new Ui::HydrographDialog)
+    , doc(doc)
+    , _geometry(nullptr)
+{
+    ui->setupUi(this);
+
+    connect(ui->pushButtonClear, &QAbstractButton::clicked, [=]() { ui->plot->clear(); });
+    connect(ui->pushButtonDone, &QAbstractButton::clicked, [=]() { hide(); });
+}
+
+HydrographDialog::~HydrographDialog()
+{
+    delete ui;
+    delete _geometry;
+}
+
+void HydrographDialog::hideEvent(QHideEvent *e)
+{
+    delete _geometry;
+    _geometry = new QRect(geometry());
+}
+
+void HydrographDialog::showEvent(QShowEvent *e)
+{
+    if (_geometry)
+    {
+        setGeometry(*_geometry);
+    }
+}
+
+void HydrographDialog::reinitialize()
+{
+    ui->plot->clear();
+}
+
+void HydrographDialog::addHydrograph(const QString &label, const QVector<double> &times,
+                                     const QVector<double> &values, double inactiveValue)
+{
+    // the time points may have changed since the last cell was picked
+    ui->plot->setTimes(times, inactiveValue);
+    ui->plot->addSeries(label, values);
+}
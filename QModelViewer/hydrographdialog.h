@@ -0,0 +1,36 @@
+#ifndef HYDROGRAPHDIALOG_H
+#define HYDROGRAPHDIALOG_H
+
+#include <QDialog>
+#include <QVector>
+
+namespace Ui {
+class HydrographDialog;
+}
+
+class MvDoc;
+
+class HydrographDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit HydrographDialog(QWidget *parent, MvDoc *doc);
+    ~HydrographDialog();
+
+    void        reinitialize();
+
+    // Adds the values of a picked cell at the given times to the plot
+    void        addHydrograph(const QString &label, const QVector<double> &times,
+                              const QVector<double> &values, double inactiveValue);
+
+    void        hideEvent(QHideEvent *event) override;
+    void        showEvent(QShowEvent *e) override;
+
+private:
+    Ui::HydrographDialog *ui;
+    MvDoc *               doc;
+    QRect *               _geometry;
+};
+
+#endif // HYDROGRAPHDIALOG_H
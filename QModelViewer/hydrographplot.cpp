@@ -0,0 +1,202 @@
+#include "hydrographplot.h"
+
+#include <QPainter>
+#include <QPainterPath>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+// Returns evenly spaced values in [lo, hi] at a step of 1, 2 or 5 times
+// a power of ten, with no more than maxTicks values
+QVector<double> ticks(double lo, double hi, int maxTicks)
+{
+    QVector<double> result;
+    double          span = hi - lo;
+    if (!(span > 0))
+    {
+        return result;
+    }
+    double step = std::pow(10.0, std::floor(std::log10(span / maxTicks)));
+    for (double m : {1.0, 2.0, 5.0, 10.0})
+    {
+        if (span / (step * m) <= maxTicks)
+        {
+            step *= m;
+            break;
+        }
+    }
+    for (double t = std::ceil(lo / step) * step; t <= hi + step * 1.0e-9; t += step)
+    {
+        result.append(std::abs(t) < step * 1.0e-9 ? 0.0 : t);
+    }
+    return result;
+}
+
+const Qt::GlobalColor seriesColors[] = {Qt::blue, Qt::red, Qt::darkGreen, Qt::magenta,
+                                        Qt::darkYellow, Qt::darkCyan, Qt::darkBlue, Qt::darkRed};
+} // namespace
+
+HydrographPlot::HydrographPlot(QWidget* parent)
+    : QWidget(parent)
+    , inactiveValue(1.0e30)
+{
+    setMinimumSize(320, 200);
+}
+
+void HydrographPlot::setTimes(const QVector<double>& t, double inactive)
+{
+    times         = t;
+    inactiveValue = inactive;
+    update();
+}
+
+void HydrographPlot::addSeries(const QString& label, const QVector<double>& values)
+{
+    series.append({label, values});
+    update();
+}
+
+void HydrographPlot::clear()
+{
+    series.clear();
+    update();
+}
+
+bool HydrographPlot::isActive(double value) const
+{
+    return std::isfinite(value) && std::abs(value) < std::abs(inactiveValue) * 0.999;
+}
+
+void HydrographPlot::paintEvent(QPaintEvent* event)
+{
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().color(QPalette::Base));
+
+    // data range
+    bool   any  = false;
+    double ymin = 0, ymax = 0;
+    for (const Series& s : series)
+    {
+        for (int i = 0; i < s.values.size() && i < times.size(); ++i)
+        {
+            double v = s.values[i];
+            if (!isActive(v))
+            {
+                continue;
+            }
+            ymin = any ? std::min(ymin, v) : v;
+            ymax = any ? std::max(ymax, v) : v;
+            any  = true;
+        }
+    }
+    painter.setPen(palette().color(QPalette::Text));
+    if (!any)
+    {
+        QString text = series.isEmpty() ? tr("Click a cell in the view to plot its values at all time points.")
+                                        : tr("The picked cells are dry or inactive at all time points.");
+        painter.drawText(rect().adjusted(10, 10, -10, -10), Qt::AlignCenter | Qt::TextWordWrap, text);
+        return;
+    }
+    auto   range = std::minmax_element(times.begin(), times.end());
+    double xmin  = *range.first;
+    double xmax  = *range.second;
+    if (xmax == xmin)
+    {
+        xmin -= 1;
+        xmax += 1;
+    }
+    double pad = (ymax - ymin) * 0.05;
+    if (pad == 0)
+    {
+        pad = (ymin != 0) ? std::abs(ymin) * 0.01 : 1;
+    }
+    ymin -= pad;
+    ymax += pad;
+
+    QVector<double> xticks = ticks(xmin, xmax, 6);
+    QVector<double> yticks = ticks(ymin, ymax, 6);
+    QFontMetrics    fm(font());
+    int             labelWidth = 0;
+    for (double t : yticks)
+    {
+        labelWidth = std::max(labelWidth, fm.boundingRect(QString::number(t, 'g', 6)).width());
+    }
+    QRect plot = rect().adjusted(labelWidth + 12, fm.height(), -fm.height(), -2 * fm.height() - 8);
+    if (plot.width() < 10 || plot.height() < 10)
+    {
+        return;
+    }
+    auto px = [&](double x) { return plot.left() + (x - xmin) / (xmax - xmin) * plot.width(); };
+    auto py = [&](double y) { return plot.bottom() - (y - ymin) / (ymax - ymin) * plot.height(); };
+
+    // grid lines and axis labels
+    painter.setPen(QPen(palette().color(QPalette::Mid), 0, Qt::DotLine));
+    for (double t : xticks)
+    {
+        painter.drawLine(QPointF(px(t), plot.top()), QPointF(px(t), plot.bottom()));
+    }
+    for (double t : yticks)
+    {
+        painter.drawLine(QPointF(plot.left(), py(t)), QPointF(plot.right(), py(t)));
+    }
+    painter.setPen(palette().color(QPalette::Text));
+    painter.drawRect(plot);
+    for (double t : xticks)
+    {
+        painter.drawText(QRectF(px(t) - 50, plot.bottom() + 4, 100, fm.height()),
+                         Qt::AlignHCenter | Qt::AlignTop, QString::number(t, 'g', 6));
+    }
+    for (double t : yticks)
+    {
+        painter.drawText(QRectF(0, py(t) - fm.height() / 2.0, plot.left() - 6, fm.height()),
+                         Qt::AlignRight | Qt::AlignVCenter, QString::number(t, 'g', 6));
+    }
+    painter.drawText(QRectF(plot.left(), plot.bottom() + 4 + fm.height(), plot.width(), fm.height()),
+                     Qt::AlignHCenter | Qt::AlignTop, tr("Time"));
+
+    // one line per cell, broken where the cell is dry or inactive
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setClipRect(plot);
+    const int numColors = sizeof(seriesColors) / sizeof(seriesColors[0]);
+    for (int k = 0; k < series.size(); ++k)
+    {
+        const Series& s = series[k];
+        QPainterPath  path;
+        bool          penDown = false;
+        painter.setPen(QPen(QColor(seriesColors[k % numColors]), 1.5));
+        for (int i = 0; i < s.values.size() && i < times.size(); ++i)
+        {
+            if (!isActive(s.values[i]))
+            {
+                penDown = false;
+                continue;
+            }
+            QPointF p(px(times[i]), py(s.values[i]));
+            if (penDown)
+            {
+                path.lineTo(p);
+            }
+            else
+            {
+                path.moveTo(p);
+                // a point with no neighbors is drawn as a dot
+                painter.drawEllipse(p, 1.5, 1.5);
+            }
+            penDown = true;
+        }
+        painter.drawPath(path);
+    }
+
+    // legend
+    int y = plot.top() + 4;
+    for (int k = 0; k < series.size(); ++k, y += fm.height())
+    {
+        int x = plot.left() + 8;
+        painter.setPen(QPen(QColor(seriesColors[k % numColors]), 1.5));
+        painter.drawLine(x, y + fm.height() / 2, x + 20, y + fm.height() / 2);
+        painter.setPen(palette().color(QPalette::Text));
+        painter.drawText(QRect(x + 26, y, plot.width() - 40, fm.height()), Qt::AlignLeft | Qt::AlignVCenter, series[k].label);
+    }
+}
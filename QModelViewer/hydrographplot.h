@@ -0,0 +1,37 @@
+#ifndef HYDROGRAPHPLOT_H
+#define HYDROGRAPHPLOT_H
+
+#include <QVector>
+#include <QWidget>
+
+// Plots the values of picked cells against time, one line per cell.
+// Values equal to the inactive cell value are drawn as gaps.
+class HydrographPlot : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit HydrographPlot(QWidget* parent = nullptr);
+
+    void        setTimes(const QVector<double>& times, double inactiveValue);
+    void        addSeries(const QString& label, const QVector<double>& values);
+    void        clear();
+
+protected:
+    void        paintEvent(QPaintEvent* event) override;
+
+private:
+    struct Series
+    {
+        QString         label;
+        QVector<double> values;
+    };
+
+    QVector<double> times;
+    QVector<Series> series;
+    double          inactiveValue;
+
+    bool        isActive(double value) const;
+};
+
+#endif // HYDROGRAPHPLOT_H
@@ -2,9 +2,11 @@
 
 #include <QApplication>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QGuiApplication>
 #include <QIcon>
 #include <QSurfaceFormat>
+#include <QTimer>
 
 #include <QVTKOpenGLNativeWidget.h>
 
@@ -16,6 +18,9 @@ int main(int argc, char** argv)
   int* leak1968 = (int*)malloc(1968);
 #endif
 
+  QElapsedTimer startupTimer;
+  startupTimer.start();
+
   // needed to ensure appropriate OpenGL context is created for VTK rendering.
   QSurfaceFormat::setDefaultFormat(QVTKOpenGLNativeWidget::defaultFormat());
 
@@ -32,6 +37,16 @@ int main(int argc, char** argv)
   MainWindow window;
   window.show();
 
+  // With --startup-time, print the time taken to create and show the main
+  // window and quit as soon as the event loop is idle
+  if (app.arguments().contains("--startup-time"))
+  {
+    QTimer::singleShot(0, [&]() {
+      qInfo().noquote() << QString("Startup time: %1 ms").arg(startupTimer.elapsed());
+      app.quit();
+    });
+  }
+
   int ret = app.exec();
 
 #if defined(_DEBUG)
@@ -329,6 +329,12 @@ void MainWindow::createActions()
     dataAction->setStatusTip(tr("Show or hide the Data Toolbox"));
     connect(dataAction, &QAction::triggered, doc, &MvDoc::onToolboxData);
 
+    // Toolbox->Hydrograph
+    hydrographAction = new QAction(tr("&Hydrograph"), this);
+    hydrographAction->setCheckable(true);
+    hydrographAction->setStatusTip(tr("Plot the values of a cell at all time points by clicking it"));
+    connect(hydrographAction, &QAction::triggered, doc, &MvDoc::onToolboxHydrograph);
+
 
     // Toolbox->Color Bar
     colorBarAction = new QAction(tr("&Color Bar"), this);
@@ -406,6 +412,12 @@ void MainWindow::createActions()
     animationAction->setStatusTip(tr("Show or hide the Animtion Toolbox"));
     connect(animationAction, &QAction::triggered, doc, &MvDoc::onToolboxAnimation);
 
+    // Toolbox->Watch Model Output
+    watchOutputAction = new QAction(tr("&Watch Model Output"), this);
+    watchOutputAction->setCheckable(true);
+    watchOutputAction->setStatusTip(tr("Add time steps as a running model writes them"));
+    connect(watchOutputAction, &QAction::triggered, doc, &MvDoc::onToolboxWatchOutput);
+
     // Help->Contents
     contentsAction = new QAction(tr("&Contents"), this);
     contentsAction->setStatusTip(tr("Display the online help"));
@@ -426,8 +438,12 @@ void MainWindow::updateFileActions()
     qDebug() << "updateFileActions\n";
 #endif
     
+    // File->New and File->Open
+    newAct->setEnabled(!this->doc->isLoading());
+    openAct->setEnabled(!this->doc->isLoading());
+
     // File->Close
-    closeAct->setEnabled(this->doc->_manager->GetDataFileList() && !this->isAnimating());
+    closeAct->setEnabled(this->doc->_manager->GetDataFileList() && !this->isAnimating() && !this->doc->isLoading());
 
     // File->Save
     saveAction->setEnabled(this->doc->_manager->GetDataFileList() != nullptr &&
@@ -593,6 +609,9 @@ void MainWindow::updateToolboxActions()
     // Toolbox->Data
     doc->onUpdateToolboxData(dataAction);
 
+    // Toolbox->Hydrograph
+    doc->onUpdateToolboxHydrograph(hydrographAction);
+
     // Toolbox->Color Bar
     doc->onUpdateToolboxColorBar(colorBarAction);
 
@@ -628,6 +647,9 @@ void MainWindow::updateToolboxActions()
 
     // Toolbox->Animation
     doc->onUpdateToolboxAnimation(animationAction);
+
+    // Toolbox->Watch Model Output
+    doc->onUpdateToolboxWatchOutput(watchOutputAction);
 }
 
 bool MainWindow::isAnimating() const
@@ -822,6 +844,9 @@ void MainWindow::createMenus()
     // Toolbox->Data
     toolboxMenu->addAction(dataAction);
 
+    // Toolbox->Hydrograph
+    toolboxMenu->addAction(hydrographAction);
+
     // -----------------------------
     toolboxMenu->addSeparator();
 
@@ -870,6 +895,9 @@ void MainWindow::createMenus()
     // Toolbox->Animation
     toolboxMenu->addAction(animationAction);
 
+    // Toolbox->Watch Model Output
+    toolboxMenu->addAction(watchOutputAction);
+
     ///////////////////////////////////////////////////////////////////////////
     // Help
 
@@ -925,7 +953,7 @@ void MainWindow::setModelName(const QString &name)
 
 void MainWindow::closeEvent(QCloseEvent *event)
 {
-    if (doc->maybeSave())
+    if (!doc->isLoading() && doc->maybeSave())
     {
         writeSettings();
         event->accept();
@@ -938,7 +966,7 @@ void MainWindow::closeEvent(QCloseEvent *event)
 
 void MainWindow::onFileNew()
 {
-    if (doc->maybeSave())
+    if (!doc->isLoading() && doc->maybeSave())
     {
         doc->onFileNew();
     }
@@ -1296,7 +1324,7 @@ void MainWindow::openRecentFile()
     QAction *action = qobject_cast<QAction *>(sender());
     if (action)
     {
-        if (doc->maybeSave())
+        if (!doc->isLoading() && doc->maybeSave())
         {
             doc->loadFile(action->data().toString());
         }
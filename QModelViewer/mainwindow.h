@@ -200,6 +200,7 @@ private:
 
     // Toolbox
     QAction *            dataAction;
+    QAction *            hydrographAction;
 
     QAction *            colorBarAction;
     QAction *            lightingAction;
@@ -215,6 +216,7 @@ private:
 
     QAction *            cropAction;
     QAction *            animationAction;
+    QAction *            watchOutputAction;
 
     // @todo PATHLINES
     QAction *            pathlinesAction;
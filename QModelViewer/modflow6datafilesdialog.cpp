@@ -17,6 +17,7 @@ Modflow6DataFilesDialog::Modflow6DataFilesDialog(QWidget *parent)
     headOrConcFile          = "";
     gridFile                = "";
     budgetFile              = "";
+    comparisonHeadFile      = "";
 
     ui->radioButtonSpecifyModflow6NameFile->setChecked(true);
     onSpecifyModflow6NameFile();
@@ -28,6 +29,7 @@ Modflow6DataFilesDialog::Modflow6DataFilesDialog(QWidget *parent)
     connect(ui->pushButtonBrowseModelGridFile, &QAbstractButton::clicked, this, &Modflow6DataFilesDialog::onBrowseModelGridFile);
     connect(ui->pushButtonBrowseModelHeadFile, &QAbstractButton::clicked, this, &Modflow6DataFilesDialog::onBrowseModelHeadFile);
     connect(ui->pushButtonBrowseModelBudgetFile, &QAbstractButton::clicked, this, &Modflow6DataFilesDialog::onBrowseModelBudgetFile);
+    connect(ui->pushButtonBrowseComparisonHeadFile, &QAbstractButton::clicked, this, &Modflow6DataFilesDialog::onBrowseComparisonHeadFile);
 }
 
 Modflow6DataFilesDialog::~Modflow6DataFilesDialog()
@@ -168,6 +170,21 @@ bool Modflow6DataFilesDialog::validate()
         }
     }
 
+    // comparisonHeadFile
+    comparisonHeadFile = QDir::toNativeSeparators(ui->lineEditComparisonHeadFile->text().trimmed());
+    if (!comparisonHeadFile.isEmpty())
+    {
+        QFileInfo checkComparison(comparisonHeadFile);
+        if (!(checkComparison.exists() && checkComparison.isFile()))
+        {
+            QMessageBox::warning(this,
+                                 tr("Comparison Head File"),
+                                 QString(tr("%1\nFile not found.\nCheck the file name and try again.")).arg(checkComparison.fileName()));
+            ui->lineEditComparisonHeadFile->setFocus();
+            return false;
+        }
+    }
+
     return true;
 }
 
@@ -235,7 +252,7 @@ void Modflow6DataFilesDialog::onBrowseModelHeadFile()
     QString fileName = QFileDialog::getOpenFileName(this,
                                                     tr("GWF Model Head or GWT Model Concentration File"),
                                                     QString(),
-                                                    tr("Head & Concentration Files (*.hds; *.bhd; *.hdb; *.hed; *.conc; *.ucn);;Concentration Files (*.ucn; *.conc);;Head Files (*.hds; *.bhd; *.hdb; *.hed);;All files (*.*)"));
+                                                    tr("Head & Concentration Files (*.hds; *.bhd; *.hdb; *.hed; *.conc; *.ucn; *.gz);;Concentration Files (*.ucn; *.conc);;Head Files (*.hds; *.bhd; *.hdb; *.hed);;All files (*.*)"));
     if (fileName.isEmpty())
     {
         return;
@@ -248,10 +265,23 @@ void Modflow6DataFilesDialog::onBrowseModelBudgetFile()
     QString fileName = QFileDialog::getOpenFileName(this,
                                                     tr("GWF Model Budget File"),
                                                     QString(),
-                                                    tr("Budget Files (*.cbc; *.cbb; *.ccf; *.bud; *.bin);;All files (*.*)"));
+                                                    tr("Budget Files (*.cbc; *.cbb; *.ccf; *.bud; *.bin; *.gz);;All files (*.*)"));
     if (fileName.isEmpty())
     {
         return;
     }
     this->ui->lineEditModelBudgetFile->setText(QDir::toNativeSeparators(fileName));
 }
+
+void Modflow6DataFilesDialog::onBrowseComparisonHeadFile()
+{
+    QString fileName = QFileDialog::getOpenFileName(this,
+                                                    tr("Comparison Head File"),
+                                                    QString(),
+                                                    tr("Head Files (*.hds; *.bhd; *.hdb; *.hed; *.gz);;All files (*.*)"));
+    if (fileName.isEmpty())
+    {
+        return;
+    }
+    this->ui->lineEditComparisonHeadFile->setText(QDir::toNativeSeparators(fileName));
+}
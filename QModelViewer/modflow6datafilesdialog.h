@@ -27,6 +27,7 @@ public Q_SLOTS:
     void onBrowseModelGridFile();
     void onBrowseModelHeadFile();
     void onBrowseModelBudgetFile();
+    void onBrowseComparisonHeadFile();
 
 public:
 
@@ -35,6 +36,7 @@ public:
     QString headOrConcFile;
     QString gridFile;
     QString budgetFile;
+    QString comparisonHeadFile;
 
 protected:
     bool validate();
@@ -1,6 +1,9 @@
 #include "mvdoc.h"
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
 
 #if defined(Q_OS_WIN) && !defined(NDEBUG)
 #include <windows.h>        // for testing RGB macro
@@ -10,11 +13,14 @@
 #include <QApplication>
 #include <QDebug>
 #include <QDir>
+#include <QEventLoop>
 #include <QFileDialog>
 #include <QMainWindow>
 #include <QMessageBox>
+#include <QProgressDialog>
 #include <QSettings>
 #include <QThread>
+#include <QTimer>
 
 
 #include <vtkPropCollection.h>
@@ -32,6 +38,7 @@
 #include "colorbardialog.h"
 #include "datadialog.h"
 #include "dataselectiondialog.h"
+#include "hydrographdialog.h"
 #include "geometrydialog.h"
 #include "griddialog.h"
 #include "lightingdialog.h"
@@ -51,8 +58,10 @@ MvDoc::MvDoc(QMainWindow* parent)
     : QObject{parent}
     , _modified{false}
     , _interactorStyle{MouseMode::mmTrackball}
+    , _singlePrecision{false}
     , numberOfModels{1}
     , _isAnimating{false}
+    , _isLoading{false}
     , _gui{0}
 {
     // Initialize variables
@@ -68,6 +77,7 @@ MvDoc::MvDoc(QMainWindow* parent)
 
     QSettings settings;
     _interactorStyle = static_cast<enum MouseMode>(settings.value("interactorStyle", (int)MouseMode::mmTrackball).toInt());
+    _singlePrecision = settings.value("singlePrecision", false).toBool();
 
 #if TODO
     // Get the models supported by this application
@@ -85,20 +95,29 @@ MvDoc::MvDoc(QMainWindow* parent)
 
     // Create the visualization pipeline manager
     _manager = new mvManager;
+    _manager->SetSinglePrecision(_singlePrecision);
 
     dataDialog          = new DataDialog(parent, this);
-    colorBarDialog      = new ColorBarDialog(parent, this);
     lightingDialog      = new LightingDialog(parent, this);
-    gridDialog          = new GridDialog(parent, this);
-    geometryDialog      = new GeometryDialog(parent, this);
-    overlayDialog       = new OverlayDialog(parent, this);
-    solidDialog         = new SolidDialog(parent, this);
-    isosurfaceDialog    = new IsosurfaceDialog(parent, this);
-    vectorDialog        = new VectorDialog(parent, this);
-    modelFeaturesDialog = new ModelFeaturesDialog(parent, this);
     cropDialog          = new CropDialog(parent, this);
     animationDialog     = new AnimationDialog(parent, this);
 
+    // The other tool dialogs are created when first shown
+    hydrographDialog    = nullptr;
+    colorBarDialog      = nullptr;
+    gridDialog          = nullptr;
+    geometryDialog      = nullptr;
+    overlayDialog       = nullptr;
+    solidDialog         = nullptr;
+    isosurfaceDialog    = nullptr;
+    vectorDialog        = nullptr;
+    modelFeaturesDialog = nullptr;
+
+    // Toolbox->Watch Model Output
+    _watchTimer = new QTimer(this);
+    _watchTimer->setInterval(5000);
+    connect(_watchTimer, &QTimer::timeout, this, &MvDoc::checkForNewTimePoints);
+
     reinitializeToolDialogs();
 
     // Note: views have not been created yet they depend on MvDoc
@@ -193,6 +212,19 @@ bool MvDoc::isAnimating() const
     return _isAnimating;
 }
 
+bool MvDoc::isLoading() const
+{
+    return _isLoading;
+}
+
+void MvDoc::removeAllViewProps()
+{
+    for (auto view : _views)
+    {
+        view->removeAllViewProps();
+    }
+}
+
 QStringList MvDoc::timePointLabels()
 {
     QStringList          slist;
@@ -222,17 +254,19 @@ QStringList MvDoc::dataTypeLabels()
 
 void MvDoc::onFileClose()
 {
-    if (!maybeSave())
+    if (_isLoading || !maybeSave())
     {
         return;
     }
 
+    removeAllViewProps();
     delete _manager;
     delete _gui;
 
     QApplication::setOverrideCursor(Qt::WaitCursor);
 
     _manager = new mvManager();
+    _manager->SetSinglePrecision(_singlePrecision);
     _gui     = new mvGUISettings();
 
     for (auto view : _views)
@@ -255,33 +289,159 @@ void MvDoc::onFileClose()
     QApplication::restoreOverrideCursor();
 }
 
+namespace
+{
+// Passes progress from the worker thread that reads the data files
+// to the progress dialog in the GUI thread
+class LoadProgress : public mvLoadProgress
+{
+public:
+    LoadProgress()
+        : stage{""}
+        , done{0}
+        , total{0}
+        , cancel{false}
+    {
+    }
+
+    int Report(const char* s, long long d, long long t) override
+    {
+        stage = s;
+        done  = d;
+        total = t;
+        return cancel;
+    }
+
+    std::atomic<const char*> stage;
+    std::atomic<long long>   done;
+    std::atomic<long long>   total;
+    std::atomic<bool>        cancel;
+};
+}
+
+const char* MvDoc::readDataSource(char* modelName, char* dataFileList, mvDataSource*& dataSource, bool& cancelled)
+{
+    MainWindow* mainWindow = dynamic_cast<MainWindow*>(parent());
+    assert(mainWindow);
+
+    // The document must not be changed while the worker owns the data
+    // source. Callers remove the old props from the views before deleting
+    // the old manager, so nothing freed is drawn while events are processed.
+    _isLoading = true;
+
+    LoadProgress             progress;
+    std::future<const char*> result = std::async(std::launch::async, [&]() {
+        return mvManager::ReadDataSource(modelName, dataFileList, dataSource, &progress);
+    });
+
+    QProgressDialog dlg(tr("Loading data..."), tr("Cancel"), 0, 1000, mainWindow);
+    // The tool dialogs are separate windows, so the whole application is
+    // blocked rather than only the main window
+    dlg.setWindowModality(Qt::ApplicationModal);
+    dlg.setMinimumDuration(0);
+    dlg.setAutoReset(false);
+    dlg.setAutoClose(false);
+    connect(&dlg, &QProgressDialog::canceled, [&]() {
+        progress.cancel = true;
+        dlg.setLabelText(tr("Cancelling..."));
+    });
+
+    // Process events until the worker has finished
+    QEventLoop loop;
+    QTimer     timer;
+    connect(&timer, &QTimer::timeout, [&]() {
+        if (result.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+        {
+            loop.quit();
+        }
+        else if (!progress.cancel)
+        {
+            long long total = progress.total;
+            dlg.setLabelText(QString("%1...").arg(progress.stage.load()));
+            dlg.setValue(total > 0 ? (int)(1000.0 * progress.done / total) : 0);
+        }
+    });
+    timer.start(50);
+    loop.exec();
+
+    _isLoading = false;
+    cancelled  = progress.cancel;
+    return result.get();
+}
+
 void MvDoc::reinitializeToolDialogs()
 {
     dataDialog->reinitialize();
-    colorBarDialog->reinitialize();
+    if (hydrographDialog) hydrographDialog->reinitialize();
+    if (colorBarDialog) colorBarDialog->reinitialize();
     lightingDialog->reinitialize();
-    gridDialog->reinitialize();
-    geometryDialog->reinitialize();
-    solidDialog->reinitialize();
-    isosurfaceDialog->reinitialize();
-    vectorDialog->reinitialize();
-    vectorDialog->hide();
+    if (gridDialog) gridDialog->reinitialize();
+    if (geometryDialog) geometryDialog->reinitialize();
+    if (solidDialog) solidDialog->reinitialize();
+    if (isosurfaceDialog) isosurfaceDialog->reinitialize();
+    if (vectorDialog)
+    {
+        vectorDialog->reinitialize();
+        vectorDialog->hide();
+    }
     //m_PathlinesDlg->Reinitialize();
     //m_PathlinesDlg->ShowWindow(SW_HIDE);
-    modelFeaturesDialog->reinitialize();
-    modelFeaturesDialog->hide();
-    overlayDialog->reinitialize();
+    if (modelFeaturesDialog)
+    {
+        modelFeaturesDialog->reinitialize();
+        modelFeaturesDialog->hide();
+    }
+    if (overlayDialog) overlayDialog->reinitialize();
     cropDialog->reinitialize();
     animationDialog->reinitialize();
 }
 
+template <typename T>
+bool MvDoc::constructToolDialog(T*& dialog)
+{
+    if (dialog)
+    {
+        return false;
+    }
+    MainWindow* mainWindow = dynamic_cast<MainWindow*>(parent());
+    assert(mainWindow);
+
+    dialog = new T(mainWindow, this);
+    dialog->reinitialize();
+    return true;
+}
+
+template <typename T>
+void MvDoc::createToolDialog(T*& dialog, void (MvDoc::*update)())
+{
+    if (!constructToolDialog(dialog))
+    {
+        return;
+    }
+    if (_manager->GetDataFileList() != nullptr)
+    {
+        (this->*update)();
+    }
+    if (_isAnimating)
+    {
+        dialog->activate(false);
+    }
+}
+
 void MvDoc::onFileNew()
 {
     MainWindow* mainWindow = dynamic_cast<MainWindow*>(parent());
     assert(mainWindow);
 
+    if (_isLoading)
+    {
+        return;
+    }
+
+    removeAllViewProps();
     delete _manager;
     _manager = new mvManager;
+    _manager->SetSinglePrecision(_singlePrecision);
 
     reinitializeToolDialogs();
     setCurrentFile("");
@@ -301,20 +461,26 @@ void MvDoc::onFileNew()
         return; // User clicked the Cancel button
     }
 
-    QApplication::setOverrideCursor(Qt::WaitCursor);
-
     // Load data
-    const char* errorMsg = _manager->LoadData(selectedModel, dataFileList);
+    mvDataSource* dataSource = nullptr;
+    bool          cancelled  = false;
+    const char*   errorMsg   = readDataSource(selectedModel, dataFileList, dataSource, cancelled);
     delete[] dataFileList;
 
     // Check for error in reading data files
     if (errorMsg)
     {
-        QApplication::restoreOverrideCursor();
-        QMessageBox::critical(mainWindow, "", errorMsg);
+        if (!cancelled)
+        {
+            QMessageBox::critical(mainWindow, "", errorMsg);
+        }
         return;
     }
 
+    // Set up the visualization pipeline
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    _manager->SetDataSource(dataSource);
+
     // Display dialog box for user to select time and type of data to view
     QApplication::restoreOverrideCursor();
 
@@ -387,7 +553,7 @@ void MvDoc::onFileOpen()
     MainWindow* mainWindow = dynamic_cast<MainWindow*>(parent());
     assert(mainWindow);
 
-    if (!maybeSave()) return;
+    if (_isLoading || !maybeSave()) return;
 
     QString fileName = QFileDialog::getOpenFileName(mainWindow, tr("Open"), QString(), tr("MvMf6 Files (*.mvmf6)"));
 
@@ -401,6 +567,11 @@ void MvDoc::onFileOpen()
 
 void MvDoc::loadFile(const QString& fileName)
 {
+    if (_isLoading)
+    {
+        return;
+    }
+
     QApplication::setOverrideCursor(Qt::WaitCursor);
 
     QString native = QDir::toNativeSeparators(fileName);
@@ -413,19 +584,39 @@ void MvDoc::loadFile(const QString& fileName)
     MainWindow* mainWindow = dynamic_cast<MainWindow*>(parent());
     assert(mainWindow);
 
+    removeAllViewProps();
     delete _manager;
     delete _gui;
 
     std::string errorMsg;
     _gui     = new mvGUISettings();
     _manager = new mvManager();
-    _manager->Deserialize(QDir::toNativeSeparators(fileName).toLocal8Bit().data(), _gui, errorMsg);
-    if (errorMsg.size())
+    _manager->SetSinglePrecision(_singlePrecision);
+
+    QByteArray    path = QDir::toNativeSeparators(fileName).toLocal8Bit();
+    mvSessionFile session;
+    if (!_manager->BeginDeserialize(path.data(), session, errorMsg))
     {
         QApplication::restoreOverrideCursor();
         QMessageBox::information(mainWindow, tr("Error"), errorMsg.c_str());
         return;
     }
+    QApplication::restoreOverrideCursor();
+
+    mvDataSource* dataSource = nullptr;
+    bool          cancelled  = false;
+    const char*   err        = readDataSource(session.GetModelName(), session.GetDataFileList(), dataSource, cancelled);
+    if (err)
+    {
+        if (!cancelled)
+        {
+            QMessageBox::information(mainWindow, tr("Error"), err);
+        }
+        return;
+    }
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    _manager->EndDeserialize(path.data(), session, dataSource, _gui);
 
     for (auto view : _views)
     {
@@ -532,7 +723,7 @@ void MvDoc::onPreferences()
     MainWindow* mainWindow = dynamic_cast<MainWindow*>(parent());
     assert(mainWindow);
 
-    PreferencesDialog dlg(_interactorStyle, mainWindow);
+    PreferencesDialog dlg(_interactorStyle, _singlePrecision, mainWindow);
     if (dlg.exec() != QDialog::Accepted)
     {
         return;
@@ -544,8 +735,12 @@ void MvDoc::onPreferences()
         view->setInteractorStyle(_interactorStyle);
     }
 
+    // takes effect when data are next loaded
+    _singlePrecision = dlg.singlePrecision;
+
     QSettings settings;
     settings.setValue("interactorStyle", (int)_interactorStyle);
+    settings.setValue("singlePrecision", _singlePrecision);
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -795,8 +990,8 @@ void MvDoc::updateAllViews(QAbstractView* sender, QObject* hint)
 void MvDoc::onShowNone()
 {
     _manager->HideScalarData();
-    isosurfaceDialog->activate(false);
-    solidDialog->activate(false);
+    if (isosurfaceDialog) isosurfaceDialog->activate(false);
+    if (solidDialog) solidDialog->activate(false);
     cropDialog->activate(false);
     updateAllViews(nullptr);
     setModified(true);
@@ -805,8 +1000,8 @@ void MvDoc::onShowNone()
 void MvDoc::onShowSolid()
 {
     _manager->ShowScalarDataAsSolid();
-    isosurfaceDialog->activate(false);
-    solidDialog->activate(true);
+    if (isosurfaceDialog) isosurfaceDialog->activate(false);
+    if (solidDialog) solidDialog->activate(true);
     cropDialog->activate(true);
     updateAllViews(nullptr);
     setModified(true);
@@ -815,16 +1010,19 @@ void MvDoc::onShowSolid()
 void MvDoc::onShowIsosurfaces()
 {
     _manager->ShowScalarDataAsIsosurfaces();
-    isosurfaceDialog->activate(true);
-    if (_manager->UsingRegularIsosurfaces())
-    {
-        isosurfaceDialog->setCurrentTabIndex(0);
-    }
-    else
+    if (isosurfaceDialog)
     {
-        isosurfaceDialog->setCurrentTabIndex(1);
+        isosurfaceDialog->activate(true);
+        if (_manager->UsingRegularIsosurfaces())
+        {
+            isosurfaceDialog->setCurrentTabIndex(0);
+        }
+        else
+        {
+            isosurfaceDialog->setCurrentTabIndex(1);
+        }
     }
-    solidDialog->activate(false);
+    if (solidDialog) solidDialog->activate(false);
     cropDialog->activate(true);
     updateAllViews(nullptr);
     setModified(true);
@@ -835,7 +1033,7 @@ void MvDoc::onShowVectors(QWidget* parent)
     if (_manager->AreVectorsVisible())
     {
         _manager->HideVectors();
-        vectorDialog->activate(false);
+        if (vectorDialog) vectorDialog->activate(false);
     }
     else
     {
@@ -844,7 +1042,7 @@ void MvDoc::onShowVectors(QWidget* parent)
             QMessageBox::warning(parent, tr("Warning"), tr("Vector scale factor is currently set to zero!"));
         }
         _manager->ShowVectors();
-        vectorDialog->activate(true);
+        if (vectorDialog) vectorDialog->activate(true);
     }
     updateAllViews(nullptr);
     setModified(true);
@@ -871,11 +1069,13 @@ void MvDoc::onShowModelFeatures()
     if (_manager->AreModelFeaturesVisible())
     {
         _manager->HideModelFeatures();
-        modelFeaturesDialog->activate(false);
+        if (modelFeaturesDialog) modelFeaturesDialog->activate(false);
     }
     else
     {
         _manager->ShowModelFeatures();
+        // the dialog is shown if no features have been chosen
+        createToolDialog(modelFeaturesDialog, &MvDoc::updateModelFeaturesDialog);
         modelFeaturesDialog->activate(true);
         if ((!modelFeaturesDialog->isVisible()) &&
             (modelFeaturesDialog->showFeaturesCount() == 0))
@@ -943,12 +1143,12 @@ void MvDoc::onShowAxes()
     if (_manager->AreAxesVisible())
     {
         _manager->HideAxes();
-        geometryDialog->activateAxes(false);
+        if (geometryDialog) geometryDialog->activateAxes(false);
     }
     else
     {
         _manager->ShowAxes();
-        geometryDialog->activateAxes(true);
+        if (geometryDialog) geometryDialog->activateAxes(true);
     }
     updateAllViews(nullptr);
     setModified(true);
@@ -961,15 +1161,20 @@ void MvDoc::onShowGridLines()
         if (_manager->AreActivatedGridLinesVisible())
         {
             _manager->HideGridLines();
-            gridDialog->activateLines(false);
-            gridDialog->enableApplyButton(false);
+            if (gridDialog)
+            {
+                gridDialog->activateLines(false);
+                gridDialog->enableApplyButton(false);
+            }
         }
         else
         {
             _manager->ShowActivatedGridLines();
-            gridDialog->activateLines(true);
-            gridDialog->enableApplyButton(gridDialog->currentTabIndex() == 0);
-            
+            if (gridDialog)
+            {
+                gridDialog->activateLines(true);
+                gridDialog->enableApplyButton(gridDialog->currentTabIndex() == 0);
+            }
         }
     }
     else if (_manager->GetGridType() == GridType::MV_LAYERED_GRID)
@@ -977,14 +1182,20 @@ void MvDoc::onShowGridLines()
         if (_manager->IsGridLayerVisible())
         {
             _manager->HideGridLayer();
-            gridDialog->activateLines(false);
-            gridDialog->enableApplyButton(false);
+            if (gridDialog)
+            {
+                gridDialog->activateLines(false);
+                gridDialog->enableApplyButton(false);
+            }
         }
         else
         {
             _manager->ShowGridLayer();
-            gridDialog->activateLines(true);
-            gridDialog->enableApplyButton(true);
+            if (gridDialog)
+            {
+                gridDialog->activateLines(true);
+                gridDialog->enableApplyButton(true);
+            }
         }
     }
     updateAllViews(nullptr);
@@ -996,12 +1207,12 @@ void MvDoc::onShowGridShell()
     if (_manager->IsGridShellVisible())
     {
         _manager->HideGridShell();
-        gridDialog->activateShell(false);
+        if (gridDialog) gridDialog->activateShell(false);
     }
     else
     {
         _manager->ShowGridShell();
-        gridDialog->activateShell(true);
+        if (gridDialog) gridDialog->activateShell(true);
     }
     updateAllViews(nullptr);
     setModified(true);
@@ -1012,12 +1223,12 @@ void MvDoc::onShowBoundingBox()
     if (_manager->IsBoundingBoxVisible())
     {
         _manager->HideBoundingBox();
-        geometryDialog->activateBoundingBox(false);
+        if (geometryDialog) geometryDialog->activateBoundingBox(false);
     }
     else
     {
         _manager->ShowBoundingBox();
-        geometryDialog->activateBoundingBox(true);
+        if (geometryDialog) geometryDialog->activateBoundingBox(true);
     }
     updateAllViews(nullptr);
     setModified(true);
@@ -1032,7 +1243,14 @@ void MvDoc::onShowOverlay()
     }
     else
     {
+        // this reads the file of an overlay restored hidden from a session
         _manager->ShowOverlay();
+        if (overlayDialog && _manager->HasOverlay())
+        {
+            double xmin, xmax, ymin, ymax;
+            _manager->GetOverlayBounds(xmin, xmax, ymin, ymax);
+            overlayDialog->setBounds(xmin, xmax, ymin, ymax);
+        }
     }
     updateAllViews(nullptr);
     setModified(true);
@@ -1274,7 +1492,7 @@ void MvDoc::setBoundingBoxColor(vtkColor3d color3d)
 
 void MvDoc::onToolboxGeometry()
 {
-    assert(geometryDialog);
+    createToolDialog(geometryDialog, &MvDoc::updateGeometryDialog);
     if (geometryDialog->isVisible())
     {
         geometryDialog->hide();
@@ -1289,12 +1507,16 @@ void MvDoc::onToolboxGeometry()
 
 void MvDoc::onUpdateToolboxGeometry(QAction* action)
 {
-    assert(geometryDialog);
-    action->setChecked(geometryDialog->isVisible());
+    action->setChecked(geometryDialog != nullptr && geometryDialog->isVisible());
 }
 
 void MvDoc::updateGeometryDialog()
 {
+    if (geometryDialog == nullptr)
+    {
+        return;
+    }
+
     // scale
     const double* sc       = _manager->GetScale();
     geometryDialog->xScale = sc[0];
@@ -1347,6 +1569,60 @@ void MvDoc::onUpdateToolboxData(QAction* action)
     action->setChecked(dataDialog->isVisible());
 }
 
+/////////////////////////////////////////////////////////////////////////////
+// Toolbox->Hydrograph
+/////////////////////////////////////////////////////////////////////////////
+
+void MvDoc::onToolboxHydrograph()
+{
+    // the hydrograph dialog is filled in by probing, so there is nothing
+    // to update it from
+    constructToolDialog(hydrographDialog);
+    if (hydrographDialog->isVisible())
+    {
+        hydrographDialog->hide();
+    }
+    else
+    {
+        hydrographDialog->show();
+    }
+}
+
+void MvDoc::onUpdateToolboxHydrograph(QAction* action)
+{
+    action->setEnabled(_manager->GetNumberOfTimePoints() > 0);
+    action->setChecked(hydrographDialog != nullptr && hydrographDialog->isVisible());
+}
+
+bool MvDoc::isProbing() const
+{
+    return hydrographDialog && hydrographDialog->isVisible() && _manager->GetNumberOfTimePoints() > 0;
+}
+
+void MvDoc::probe(const double* point, const double* normal)
+{
+    int cell = _manager->FindScalarCell(point, normal);
+    if (cell < 0)
+    {
+        return;
+    }
+    int             n = _manager->GetNumberOfTimePoints();
+    QVector<double> values(n);
+    if (!_manager->GetTimeSeries(1, &cell, values.data()))
+    {
+        return;
+    }
+    const double* timePoints = _manager->GetTimePoints();
+    if (timePoints == nullptr)
+    {
+        return;
+    }
+    QVector<double> times(n);
+    std::copy(timePoints, timePoints + n, times.begin());
+    hydrographDialog->addHydrograph(QString::fromStdString(_manager->GetCellDescription(cell)),
+                                    times, values, _manager->GetInactiveCellValue());
+}
+
 void MvDoc::updateDataDialog()
 {
     double range[2];
@@ -1374,6 +1650,7 @@ void MvDoc::updateDataDialog()
     assert(_manager->GetNumberOfScalarDataTypes() > 0);
     assert(_manager->GetNumberOfScalarDataTypes() > _manager->GetActiveScalarDataType());
     dataDialog->setDataTypeLabels(dataTypeLabels(), _manager->GetActiveScalarDataType());
+    dataDialog->setReferenceTimeLabels(timePointLabels(), _manager->GetReferenceTimePoint());
     dataDialog->activate(true);
 }
 
@@ -1396,6 +1673,22 @@ void MvDoc::setScalarDataTypeTo(int index)
     setModified(true);
 }
 
+void MvDoc::setReferenceTimePoint(int index)
+{
+    if (index < 0)
+    {
+        return;
+    }
+    _manager->SetReferenceTimePoint(index);
+
+    double range[2];
+    _manager->GetScalarDataRange(range);
+    dataDialog->setScalarDataRange(range);
+
+    updateAllViews(nullptr);
+    setModified(true);
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // utilities
 bool MvDoc::hasPathlineData() const
@@ -1411,14 +1704,13 @@ bool MvDoc::hasPathlineData() const
 // afx_msg void OnUpdateColorBarTool(CCmdUI* pCmdUI);
 void MvDoc::onUpdateToolboxColorBar(QAction* action)
 {
-    assert(colorBarDialog);
-    action->setChecked(colorBarDialog->isVisible());
+    action->setChecked(colorBarDialog != nullptr && colorBarDialog->isVisible());
 }
 
 // afx_msg void OnColorBarTool();
 void MvDoc::onToolboxColorBar()
 {
-    assert(colorBarDialog);
+    createToolDialog(colorBarDialog, &MvDoc::updateColorBarDialog);
     if (colorBarDialog->isVisible())
     {
         colorBarDialog->hide();
@@ -1431,8 +1723,11 @@ void MvDoc::onToolboxColorBar()
 
 // void UpdateColorBarDlg()
 void MvDoc::updateColorBarDialog()
-{ 
-    assert(colorBarDialog);
+{
+    if (colorBarDialog == nullptr)
+    {
+        return;
+    }
 
     // Source
     colorBarDialog->dataSourceIndex = _manager->GetColorBarSource();
@@ -1625,13 +1920,12 @@ void MvDoc::setBackgroundColor(double red, double green, double blue)
 
 void MvDoc::onUpdateToolboxGrid(QAction* action)
 {
-    assert(gridDialog);
-    action->setChecked(gridDialog->isVisible());
+    action->setChecked(gridDialog != nullptr && gridDialog->isVisible());
 }
 
 void MvDoc::onToolboxGrid()
 {
-    assert(gridDialog);
+    createToolDialog(gridDialog, &MvDoc::updateGridDialog);
     if (gridDialog->isVisible())
     {
         gridDialog->hide();
@@ -1644,7 +1938,10 @@ void MvDoc::onToolboxGrid()
 
 void MvDoc::updateGridDialog()
 {
-    assert(gridDialog);
+    if (gridDialog == nullptr)
+    {
+        return;
+    }
 
     // Using row-col-lay convention of Modflow
     const int* sdim = _manager->GetScalarGridDimensions(); // recall these are dimensions of vtk points
@@ -1873,8 +2170,10 @@ void MvDoc::applySubgrid(int col_min, int col_max, int row_min, int row_max, int
         kmax = 0;
     }
 
+    _manager->BeginUpdate();
     _manager->SetScalarSubgridExtent(imin, imax, jmin, jmax, kmin, kmax);
     _manager->ScalarSubgridOn();
+    _manager->EndUpdate();
 
     //
     // Original MvMf6 had commented code here that's been removed
@@ -1893,15 +2192,18 @@ void MvDoc::subgridOff()
     const int* sdim  = _manager->GetScalarGridDimensions(); // keep in mind these are dimensions of points
     Q_ASSERT(sdim);
 
-    gridDialog->XMin = 0;
-    gridDialog->XMax = sdim[0] - 1;
-    gridDialog->YMin = 0;
-    gridDialog->YMax = sdim[1] - 1;
-    gridDialog->ZMin = 0;
-    gridDialog->ZMax = sdim[2] - 1;
+    if (gridDialog)
+    {
+        gridDialog->XMin = 0;
+        gridDialog->XMax = sdim[0] - 1;
+        gridDialog->YMin = 0;
+        gridDialog->YMax = sdim[1] - 1;
+        gridDialog->ZMin = 0;
+        gridDialog->ZMax = sdim[2] - 1;
+    }
 
     // Update the vector dlg box
-    if (_manager->HasVectorData())
+    if (vectorDialog && _manager->HasVectorData())
     {
         const int* vdim = _manager->GetVectorGridDimensions();
         vectorDialog->mColLowerLimit = 1;
@@ -1923,13 +2225,12 @@ void MvDoc::subgridOff()
 
 void MvDoc::onUpdateToolboxOverlay(QAction* action)
 {
-    assert(overlayDialog);
-    action->setChecked(overlayDialog->isVisible());
+    action->setChecked(overlayDialog != nullptr && overlayDialog->isVisible());
 }
 
 void MvDoc::onToolboxOverlay()
 {
-    assert(overlayDialog);
+    createToolDialog(overlayDialog, &MvDoc::updateOverlayDialog);
     if (overlayDialog->isVisible())
     {
         overlayDialog->hide();
@@ -1942,7 +2243,10 @@ void MvDoc::onToolboxOverlay()
 
 void MvDoc::updateOverlayDialog()
 {
-    assert(overlayDialog);
+    if (overlayDialog == nullptr)
+    {
+        return;
+    }
 
     // Controls
     double x, y;
@@ -1967,10 +2271,18 @@ void MvDoc::updateOverlayDialog()
         overlayDialog->overlayType = static_cast<OverlayType>(_manager->GetOverlayType() - 1);
         overlayDialog->updateDataFile(false);
 
-        // Bounds
-        double xmin, xmax, ymin, ymax;
-        _manager->GetOverlayBounds(xmin, xmax, ymin, ymax);
-        overlayDialog->setBounds(xmin, xmax, ymin, ymax);
+        // Bounds. The file of a hidden overlay in a session is not read
+        // until the overlay is shown.
+        if (_manager->IsOverlayPending())
+        {
+            overlayDialog->reinitializeBounds();
+        }
+        else
+        {
+            double xmin, xmax, ymin, ymax;
+            _manager->GetOverlayBounds(xmin, xmax, ymin, ymax);
+            overlayDialog->setBounds(xmin, xmax, ymin, ymax);
+        }
 
         overlayDialog->setCurrentIndex(0);
         overlayDialog->enableRemoveButton(true);
@@ -2008,6 +2320,16 @@ void MvDoc::removeOverlay()
     setModified(true);
 }
 
+void MvDoc::updateOverlayResolution(double worldUnitsPerPixel)
+{
+    // Called by the view before each render. This only changes how finely
+    // arcs are drawn, so the document is not marked as modified.
+    if (_manager)
+    {
+        _manager->UpdateOverlayResolution(worldUnitsPerPixel);
+    }
+}
+
 void MvDoc::applyOverlayControl(const char* filename, int overlayType, double xorig, double yorig,
                                 double scale, double angle, int drape, int trim, int crop, double elev, double drapeGap)
 {
@@ -2057,13 +2379,12 @@ void MvDoc::applyOverlayControl(const char* filename, int overlayType, double xo
 
 void MvDoc::onUpdateToolboxSolid(QAction* action)
 {
-    assert(solidDialog);
-    action->setChecked(solidDialog->isVisible());
+    action->setChecked(solidDialog != nullptr && solidDialog->isVisible());
 }
 
 void MvDoc::onToolboxSolid()
 {
-    assert(solidDialog);
+    createToolDialog(solidDialog, &MvDoc::updateSolidDialog);
     if (solidDialog->isVisible())
     {
         solidDialog->hide();
@@ -2076,6 +2397,11 @@ void MvDoc::onToolboxSolid()
 
 void MvDoc::updateSolidDialog()
 {
+    if (solidDialog == nullptr)
+    {
+        return;
+    }
+
     double limits[2];
     _manager->GetSolidThresholdLimits(limits);
     solidDialog->mSolidThresholdMin  = limits[0];
@@ -2119,6 +2445,7 @@ void MvDoc::setSolidDisplayToBanded()
 
 void MvDoc::applySolidControl(bool threshold, double minValue, double maxValue, int numberOfColorBands)
 {
+    _manager->BeginUpdate();
     _manager->SetSolidThresholdLimits(minValue, maxValue);
     _manager->SetNumberOfColorBands(numberOfColorBands);
     if (threshold)
@@ -2129,6 +2456,7 @@ void MvDoc::applySolidControl(bool threshold, double minValue, double maxValue,
     {
         _manager->SolidThresholdOff();
     }
+    _manager->EndUpdate();
     updateAllViews(nullptr);
     setModified(true);
 }
@@ -2139,13 +2467,12 @@ void MvDoc::applySolidControl(bool threshold, double minValue, double maxValue,
 
 void MvDoc::onUpdateToolboxIsosurface(QAction* action)
 {
-    assert(isosurfaceDialog);
-    action->setChecked(isosurfaceDialog->isVisible());
+    action->setChecked(isosurfaceDialog != nullptr && isosurfaceDialog->isVisible());
 }
 
 void MvDoc::onToolboxIsosurface()
 {
-    assert(isosurfaceDialog);
+    createToolDialog(isosurfaceDialog, &MvDoc::updateIsosurfaceDialog);
     if (isosurfaceDialog->isVisible())
     {
         isosurfaceDialog->hide();
@@ -2158,7 +2485,10 @@ void MvDoc::onToolboxIsosurface()
 
 void MvDoc::updateIsosurfaceDialog()
 {
-    assert(isosurfaceDialog);
+    if (isosurfaceDialog == nullptr)
+    {
+        return;
+    }
 
     // Regular
     double                  range[2];
@@ -2210,14 +2540,13 @@ void MvDoc::setCustomIsosurfaces(std::vector<double> values)
 
 void MvDoc::onUpdateToolboxVector(QAction* action)
 {
-    assert(vectorDialog);
-    action->setChecked(vectorDialog->isVisible());
+    action->setChecked(vectorDialog != nullptr && vectorDialog->isVisible());
     action->setEnabled(_manager->HasVectorData());
 }
 
 void MvDoc::onToolboxVector()
 {
-    assert(vectorDialog);
+    createToolDialog(vectorDialog, &MvDoc::updateVectorDialog);
     if (vectorDialog->isVisible())
     {
         vectorDialog->hide();
@@ -2230,7 +2559,10 @@ void MvDoc::onToolboxVector()
 
 void MvDoc::updateVectorDialog()
 {
-    assert(vectorDialog);
+    if (vectorDialog == nullptr)
+    {
+        return;
+    }
 
     if (_manager->HasVectorData())
     {
@@ -2266,6 +2598,8 @@ void MvDoc::updateVectorDialog()
         else
         {
             vectorDialog->mStructuredGrid = false;
+            vectorDialog->mScreenSpacing  = _manager->GetVectorScreenSpacing();
+            vectorDialog->updateDataSubsample(false);
         }
 
         // Appearance (CVectorOptionsPage)
@@ -2323,6 +2657,40 @@ void MvDoc::subsampleVectors(int col_min, int col_max, int col_rate, int row_min
     setModified(true);
 }
 
+void MvDoc::beginInteraction()
+{
+    if (_manager)
+    {
+        _manager->BeginInteraction();
+    }
+}
+
+void MvDoc::endInteraction()
+{
+    if (_manager)
+    {
+        _manager->EndInteraction();
+    }
+}
+
+void MvDoc::updateInteractionLOD()
+{
+    if (_manager)
+    {
+        _manager->UpdateInteractionLOD();
+    }
+}
+
+void MvDoc::updateVectorBinSize(double worldUnitsPerPixel)
+{
+    // Called by the view before each render. This only changes how densely
+    // vectors are drawn, so the document is not marked as modified.
+    if (_manager)
+    {
+        _manager->UpdateVectorBinSize(worldUnitsPerPixel);
+    }
+}
+
 void MvDoc::setVectorColor(vtkColor3d color3d)
 {
     _manager->SetVectorColor(color3d.GetRed(), color3d.GetGreen(), color3d.GetBlue());
@@ -2363,6 +2731,13 @@ void MvDoc::setVectorLineWidth(double width)
     setModified(true);
 }
 
+void MvDoc::setVectorScreenSpacing(int pixels)
+{
+    _manager->SetVectorScreenSpacing(pixels);
+    updateAllViews(nullptr);
+    setModified(true);
+}
+
 void MvDoc::enlargeVectorGlyph()
 {
     _manager->EnlargeVectorGlyph();
@@ -2435,14 +2810,13 @@ void MvDoc::onUpdateToolboxPathlines(QAction* action)
 
 void MvDoc::onUpdateToolboxModelFeatures(QAction* action)
 {
-    assert(modelFeaturesDialog);
-    action->setChecked(modelFeaturesDialog->isVisible());
+    action->setChecked(modelFeaturesDialog != nullptr && modelFeaturesDialog->isVisible());
     action->setEnabled(_manager->HasModelFeatures());
 }
 
 void MvDoc::onToolboxModelFeatures()
 {
-    assert(modelFeaturesDialog);
+    createToolDialog(modelFeaturesDialog, &MvDoc::updateModelFeaturesDialog);
     if (modelFeaturesDialog->isVisible())
     {
         modelFeaturesDialog->hide();
@@ -2482,8 +2856,11 @@ std::vector<std::string> MvDoc::modelFeatureLabels()
 
 void MvDoc::updateModelFeaturesDialog()
 {
+    if (modelFeaturesDialog == nullptr)
+    {
+        return;
+    }
     // @todo
-    assert(modelFeaturesDialog);
     //int i;
     //int numFeatureTypes = m_Manager->GetNumberOfModelFeatureTypes();
     //m_ModelFeaturesDlg->SetNumberOfModelFeatureTypes(numFeatureTypes);
@@ -2719,6 +3096,47 @@ void MvDoc::onUpdateToolboxAnimation(QAction* action)
     action->setChecked(animationDialog->isVisible());
 }
 
+void MvDoc::onToolboxWatchOutput()
+{
+    if (_watchTimer->isActive())
+    {
+        _watchTimer->stop();
+    }
+    else
+    {
+        _watchTimer->start();
+    }
+}
+
+void MvDoc::onUpdateToolboxWatchOutput(QAction* action)
+{
+    action->setEnabled(_manager->GetNumberOfTimePoints() > 0);
+    action->setChecked(_watchTimer->isActive());
+}
+
+// Adds time points that a running model has appended to the head and budget
+// files since they were last counted. Only the new records are scanned.
+void MvDoc::checkForNewTimePoints()
+{
+    if (_isAnimating || _isLoading)
+    {
+        // the new time points are picked up on a later poll
+        return;
+    }
+    if (_manager->UpdateTimePoints() == 0)
+    {
+        return;
+    }
+    animationDialog->appendTimePoints(timePointLabels());
+    dataDialog->setReferenceTimeLabels(timePointLabels(), _manager->GetReferenceTimePoint());
+    if (_animationType == AnimationType::atTime)
+    {
+        bool b = _manager->GetCurrentTimePointIndex() < _manager->GetNumberOfTimePoints() - 1;
+        animationDialog->enableRun(b);
+        animationDialog->enableAdvance(b);
+    }
+}
+
 void MvDoc::updateAnimationDialog(mvGUISettings* gui)
 {
     /*
@@ -2866,18 +3284,22 @@ void MvDoc::updateAnimationWithSameTime()
 
 void MvDoc::startAnimation()
 {
+    if (_isLoading)
+    {
+        return;
+    }
     dataDialog->activate(false);
-    colorBarDialog->activate(false);
+    if (colorBarDialog) colorBarDialog->activate(false);
     lightingDialog->activate(false);
-    gridDialog->activate(false);
-    geometryDialog->activate(false);
-    solidDialog->activate(false);
-    isosurfaceDialog->activate(false);
-    vectorDialog->activate(false);
+    if (gridDialog) gridDialog->activate(false);
+    if (geometryDialog) geometryDialog->activate(false);
+    if (solidDialog) solidDialog->activate(false);
+    if (isosurfaceDialog) isosurfaceDialog->activate(false);
+    if (vectorDialog) vectorDialog->activate(false);
     //m_PathlinesDlg->activate(false);      @todo PATHLINES
-    modelFeaturesDialog->activate(false);
+    if (modelFeaturesDialog) modelFeaturesDialog->activate(false);
     cropDialog->activate(false);
-    overlayDialog->activate(false);
+    if (overlayDialog) overlayDialog->activate(false);
 
     _isAnimating = true;
 
@@ -2971,22 +3393,31 @@ void MvDoc::animate()
     animationDialog->activateOptions(true);
 
     dataDialog->activate(true);
-    colorBarDialog->activate(true);
+    if (colorBarDialog) colorBarDialog->activate(true);
     lightingDialog->activate(true);
-    gridDialog->activateShell(_manager->IsGridShellVisible());
-    gridDialog->activateLines(_manager->AreActivatedGridLinesVisible());
-    gridDialog->activateSubgrid(true);
-    geometryDialog->activateScale(true);
-    geometryDialog->activateAxes(_manager->AreAxesVisible());
-    geometryDialog->activateBoundingBox(_manager->IsBoundingBoxVisible());
-    solidDialog->activate(_manager->IsSolidVisible());
-    isosurfaceDialog->activate(_manager->AreIsosurfacesVisible());
-    vectorDialog->activate(_manager->AreVectorsVisible());
+    if (gridDialog)
+    {
+        gridDialog->activateShell(_manager->IsGridShellVisible());
+        gridDialog->activateLines(_manager->AreActivatedGridLinesVisible());
+        gridDialog->activateSubgrid(true);
+    }
+    if (geometryDialog)
+    {
+        geometryDialog->activateScale(true);
+        geometryDialog->activateAxes(_manager->AreAxesVisible());
+        geometryDialog->activateBoundingBox(_manager->IsBoundingBoxVisible());
+    }
+    if (solidDialog) solidDialog->activate(_manager->IsSolidVisible());
+    if (isosurfaceDialog) isosurfaceDialog->activate(_manager->AreIsosurfacesVisible());
+    if (vectorDialog) vectorDialog->activate(_manager->AreVectorsVisible());
     //m_PathlinesDlg->Activate(_manager->ArePathlinesVisible());  @todo PATHLINES
-    modelFeaturesDialog->activate(_manager->AreModelFeaturesVisible());
+    if (modelFeaturesDialog) modelFeaturesDialog->activate(_manager->AreModelFeaturesVisible());
     cropDialog->activate(_manager->IsSolidVisible() || _manager->AreIsosurfacesVisible());
-    overlayDialog->activate(true);
-    overlayDialog->enableRemoveButton(_manager->HasOverlay());
+    if (overlayDialog)
+    {
+        overlayDialog->activate(true);
+        overlayDialog->enableRemoveButton(_manager->HasOverlay());
+    }
 }
 
 
@@ -19,11 +19,13 @@
 #include <vtkColor.h>
 #include <vtkSmartPointer.h>
 
+class mvDataSource;
 class mvGUISettings;
 class mvManager;
 //class mvView;
 class QAbstractView;
 class QAction;
+class QTimer;
 class QObject;
 class QWidget;
 class QMainWindow;
@@ -31,6 +33,7 @@ class QMainWindow;
 
 // modeless dialogs
 class DataDialog;
+class HydrographDialog;
 class ColorBarDialog;
 class LightingDialog;
 class GridDialog;
@@ -146,6 +149,8 @@ public:
     void                               setModified(bool modifed);
 
     bool                               isAnimating() const;
+    // True while data files are read in a worker thread
+    bool                               isLoading() const;
 
 	void                               addView(QAbstractView* pView);
     void                               removeView(QAbstractView* pView);
@@ -153,6 +158,11 @@ public:
 
     vtkSmartPointer<vtkPropCollection> propCollection();
 
+    // reduced detail while the view is rotated or zoomed
+    void                               beginInteraction();
+    void                               endInteraction();
+    void                               updateInteractionLOD();
+
     // 
     QString                            currentFile();
 
@@ -166,6 +176,17 @@ public:
     void                               onToolboxData();
     void                               onUpdateToolboxData(QAction* action);
     void                               setScalarDataTypeTo(int index);
+    void                               setReferenceTimePoint(int index);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Toolbox->Hydrograph
+    /////////////////////////////////////////////////////////////////////////////
+    void                               onToolboxHydrograph();
+    void                               onUpdateToolboxHydrograph(QAction* action);
+    // While the Hydrograph toolbox is visible, clicking a cell in a view
+    // plots its values at all time points
+    bool                               isProbing() const;
+    void                               probe(const double* point, const double* normal);
 
     /////////////////////////////////////////////////////////////////////////////
     // Toolbox->Color Bar
@@ -234,6 +255,7 @@ public:
     void                               applyOverlayControl(const char* filename, int overlayType, double xorig, double yorig,
                                                            double scale, double angle, int drape, int trim, int crop, double elev, double drapeGap);
     void                               removeOverlay();
+    void                               updateOverlayResolution(double worldUnitsPerPixel);
 
 
     /////////////////////////////////////////////////////////////////////////////
@@ -267,6 +289,7 @@ public:
     void                               activateVectorGlyph(bool b);
     void                               setVectorScaleFactor(double scaleFactor);
     void                               setVectorLineWidth(double width);
+    void                               setVectorScreenSpacing(int pixels);
     void                               enlargeVectorGlyph();
     void                               shrinkVectorGlyph();
 
@@ -274,6 +297,7 @@ public:
     void                               vectorThresholdOff();
     void                               cropVectors(double xmin, double xmax, double ymin, double ymax, double zmin, double zmax, int cropangle);
     void                               setLogTransformVector(bool b);
+    void                               updateVectorBinSize(double worldUnitsPerPixel);
     double                             vectorScaleFactor();
     void                               vectorMagnitudeRange(double* range);
 
@@ -316,6 +340,9 @@ public:
     /////////////////////////////////////////////////////////////////////////////
     void                               onToolboxAnimation();
     void                               onUpdateToolboxAnimation(QAction* action);
+    void                               onToolboxWatchOutput();
+    void                               onUpdateToolboxWatchOutput(QAction* action);
+    void                               checkForNewTimePoints();
     void                               startAnimation();
     void                               stopAnimation();
 #if !defined(USE_THREAD_FOR_ANIMATION)
@@ -390,6 +417,7 @@ private:
     AnimationType            _animationType;        // m_AnimationType
     size_t                   _animationSteps;        // m_AnimationSteps
     MouseMode                _interactorStyle;      // m_InteractorStyle
+    bool                     _singlePrecision;      // single precision grid coordinates
     ProjectionType           projectionMode;        // m_ProjectionMode
     size_t                   numberOfModels;        // m_NumberOfModels
     bool                     readyToClose;          // m_ReadyToClose
@@ -397,6 +425,8 @@ private:
     std::string              defaultModel;          // m_DefaultModel
     bool                     startup;               // m_Startup
     bool                     _isAnimating;          // m_IsAnimating
+    bool                     _isLoading;            // data files are being read
+    QTimer*                  _watchTimer;           // polls for output of a running model
 
     mvGUISettings*           _gui;
 
@@ -409,8 +439,12 @@ private:
 
     std::list<QAbstractView*> _views;
 
-    // Modeless dialog boxes (menu order)
+    // Modeless dialog boxes (menu order). The data, lighting, crop and
+    // animation dialogs hold settings that are saved with the document and
+    // are created with it. The others are created when first shown, and are
+    // null until then.
     DataDialog*               dataDialog;           // ID_DATA_TOOL
+    HydrographDialog*         hydrographDialog;
     // SEPARATOR
     ColorBarDialog*           colorBarDialog;       // ID_COLOR_BAR_TOOL
     LightingDialog*           lightingDialog;       // ID_LIGHTING_TOOL
@@ -434,6 +468,21 @@ private:
     void                      saveCurrentAppSettings();
     
     void                      reinitializeToolDialogs();
+    void                      removeAllViewProps();
+
+    // Constructs a tool dialog if it does not exist yet. Returns true if
+    // it was constructed.
+    template <typename T>
+    bool                      constructToolDialog(T*& dialog);
+
+    // Creates a tool dialog the first time it is shown, and fills it in
+    // from the manager with its update method if data has been loaded
+    template <typename T>
+    void                      createToolDialog(T*& dialog, void (MvDoc::*update)());
+
+    // Reads the data files in a worker thread while showing a progress dialog
+    // that lets the user cancel loading
+    const char*               readDataSource(char* modelName, char* dataFileList, mvDataSource*& dataSource, bool& cancelled);
 
     ///////////////////////////////////////////////////////////////////////////
     // updateToolDialogs
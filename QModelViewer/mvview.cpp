@@ -9,15 +9,19 @@
 #include <vtkGenericOpenGLRenderWindow.h>
 
 #include <vtkBMPWriter.h>
+#include <vtkCallbackCommand.h>
 #include <vtkCamera.h>
+#include <vtkCellPicker.h>
 #include <vtkInteractorStyleSwitch.h>
 #include <vtkLight.h>
 #include <vtkLightCollection.h>
+#include <vtkMath.h>
 
 #include <vtkPNGWriter.h>
 #include <vtkProp.h>
 #include <vtkRenderer.h>
 #include <vtkRenderLargeImage.h>
+#include <vtkRenderWindowInteractor.h>
 
 
 //#include <vtkViewport.h> // testing
@@ -59,6 +63,14 @@ MvView::MvView(QObject *parent)
     // camera position
     viewFromDirection    = MV_VIEW_FROM_POSITIVE_Z;
     doResetViewpoint     = false;
+    interacting          = false;
+    pressPosition[0]     = -1;
+    pressPosition[1]     = -1;
+
+    wheelTimer           = new QTimer(this);
+    wheelTimer->setSingleShot(true);
+    wheelTimer->setInterval(300);
+    connect(wheelTimer, &QTimer::timeout, this, &MvView::onWheelIdle);
 
     // bitmap exporting
     bitmapResolutionOption = ResolutionType::rtScreen;
@@ -69,12 +81,52 @@ MvView::MvView(QObject *parent)
     // mouseMode
     setInteractorStyle(GetDocument()->interactorStyle());
 
+    // keep the on-screen density of vectors on layered and unstructured
+    // grids constant as the view is zoomed
+    vtkNew<vtkCallbackCommand> startRender;
+    startRender->SetCallback(MvView::onStartRender);
+    startRender->SetClientData(this);
+    renderer->AddObserver(vtkCommand::StartEvent, startRender);
+
+    // draw coarse versions of large objects while a mouse button is down.
+    // The coarse versions are brought up to date after each full render.
+    vtkNew<vtkCallbackCommand> endRender;
+    endRender->SetCallback(MvView::onEndRender);
+    endRender->SetClientData(this);
+    renderer->AddObserver(vtkCommand::EndEvent, endRender);
+
+    // The priority makes the button callbacks run before the interactor
+    // style, so full detail is back in place for the render on release.
+    vtkNew<vtkCallbackCommand> buttonPress;
+    buttonPress->SetCallback(MvView::onButtonPress);
+    buttonPress->SetClientData(this);
+    vtkNew<vtkCallbackCommand> buttonRelease;
+    buttonRelease->SetCallback(MvView::onButtonRelease);
+    buttonRelease->SetClientData(this);
+    vtkRenderWindowInteractor* interactor = widget->interactor();
+    interactor->AddObserver(vtkCommand::LeftButtonPressEvent, buttonPress, 1.0);
+    interactor->AddObserver(vtkCommand::MiddleButtonPressEvent, buttonPress, 1.0);
+    interactor->AddObserver(vtkCommand::RightButtonPressEvent, buttonPress, 1.0);
+    interactor->AddObserver(vtkCommand::LeftButtonReleaseEvent, buttonRelease, 1.0);
+    interactor->AddObserver(vtkCommand::MiddleButtonReleaseEvent, buttonRelease, 1.0);
+    interactor->AddObserver(vtkCommand::RightButtonReleaseEvent, buttonRelease, 1.0);
+
+    // Zooming with the mouse wheel has no release event, so the coarse
+    // versions stay in place until the wheel has been idle for a moment.
+    vtkNew<vtkCallbackCommand> mouseWheel;
+    mouseWheel->SetCallback(MvView::onMouseWheel);
+    mouseWheel->SetClientData(this);
+    interactor->AddObserver(vtkCommand::MouseWheelForwardEvent, mouseWheel, 1.0);
+    interactor->AddObserver(vtkCommand::MouseWheelBackwardEvent, mouseWheel, 1.0);
+
     // export image sequance
     resetExportImageParameters();
 }
 
 MvView::~MvView()
 {
+    renderer->RemoveObservers(vtkCommand::StartEvent);
+    renderer->RemoveObservers(vtkCommand::EndEvent);
     //renderer->SetRenderWindow(nullptr);
     //renderer->RemoveLight(headlight);
     //renderer->RemoveLight(auxiliaryLight);
@@ -279,6 +331,101 @@ void MvView::resetExportImageParameters()
 /////////////////////////////////////////////////////////////////////////////
 // Protected methods
 
+void MvView::onStartRender(vtkObject* caller, unsigned long eventId, void* clientData, void* callData)
+{
+    MvView*    view   = static_cast<MvView*>(clientData);
+    vtkCamera* camera = view->renderer->GetActiveCamera();
+    int*       size   = view->renderer->GetSize();
+    if (size[1] <= 0)
+    {
+        return;
+    }
+
+    // height of the view in world coordinates at the focal point
+    double height;
+    if (camera->GetParallelProjection())
+    {
+        height = 2 * camera->GetParallelScale();
+    }
+    else
+    {
+        height = 2 * camera->GetDistance() * tan(vtkMath::RadiansFromDegrees(camera->GetViewAngle()) / 2);
+    }
+    view->GetDocument()->updateVectorBinSize(height / size[1]);
+    view->GetDocument()->updateOverlayResolution(height / size[1]);
+}
+
+void MvView::onEndRender(vtkObject* caller, unsigned long eventId, void* clientData, void* callData)
+{
+    MvView* view = static_cast<MvView*>(clientData);
+    if (!view->interacting && !view->GetDocument()->isAnimating())
+    {
+        view->GetDocument()->updateInteractionLOD();
+    }
+}
+
+void MvView::onButtonPress(vtkObject* caller, unsigned long eventId, void* clientData, void* callData)
+{
+    MvView* view = static_cast<MvView*>(clientData);
+    if (eventId == vtkCommand::LeftButtonPressEvent)
+    {
+        vtkRenderWindowInteractor* interactor = static_cast<vtkRenderWindowInteractor*>(caller);
+        interactor->GetEventPosition(view->pressPosition);
+    }
+    if (!view->interacting)
+    {
+        // a wheel zoom in progress becomes part of this interaction
+        view->wheelTimer->stop();
+        view->interacting = true;
+        view->GetDocument()->beginInteraction();
+    }
+}
+
+void MvView::onButtonRelease(vtkObject* caller, unsigned long eventId, void* clientData, void* callData)
+{
+    MvView* view = static_cast<MvView*>(clientData);
+    if (view->interacting)
+    {
+        view->interacting = false;
+        view->GetDocument()->endInteraction();
+    }
+    if (eventId == vtkCommand::LeftButtonReleaseEvent && view->GetDocument()->isProbing())
+    {
+        vtkRenderWindowInteractor* interactor = static_cast<vtkRenderWindowInteractor*>(caller);
+        int*                       position   = interactor->GetEventPosition();
+        if (position[0] == view->pressPosition[0] && position[1] == view->pressPosition[1])
+        {
+            vtkNew<vtkCellPicker> picker;
+            picker->SetTolerance(0.0005);
+            if (picker->Pick(position[0], position[1], 0, view->renderer))
+            {
+                view->GetDocument()->probe(picker->GetPickPosition(), picker->GetPickNormal());
+            }
+        }
+    }
+}
+
+void MvView::onMouseWheel(vtkObject* caller, unsigned long eventId, void* clientData, void* callData)
+{
+    MvView* view = static_cast<MvView*>(clientData);
+    if (view->interacting)
+    {
+        // a button is down; the release ends the interaction
+        return;
+    }
+    if (!view->wheelTimer->isActive())
+    {
+        view->GetDocument()->beginInteraction();
+    }
+    view->wheelTimer->start();
+}
+
+void MvView::onWheelIdle()
+{
+    GetDocument()->endInteraction();
+    widget->renderWindow()->Render();
+}
+
 void MvView::WriteBmp(const char* filename, bool useScreenResolution)
 {
     this->widget->renderWindow()->SetUseOffScreenBuffers(true);
@@ -8,12 +8,14 @@
 #include <vtkNew.h>
 
 class vtkLight;
+class vtkObject;
 class vtkRenderer;
 ///class QVTKOpenGLNativeWidget; //    vtkMFCWindow;
 class vtkGenericOpenGLRenderWindow;
 class vtkProp;
 
 class mvGUISettings;
+class QTimer;
 //class MvDoc;
 
 // enum forward declarations
@@ -106,8 +108,24 @@ protected:
     int            viewFromDirection;
     bool           doResetViewpoint;
 
+    // true while a mouse button is down in the view
+    bool           interacting;
+
+    // ends a mouse wheel zoom once the wheel has been idle for a moment
+    QTimer*        wheelTimer;
+
+    // where the left button was pressed. A release at the same place is a
+    // click, which picks a cell for the Hydrograph toolbox.
+    int            pressPosition[2];
+
 
     //void           PlaceHeadlightWithCamera();
+    static void    onStartRender(vtkObject* caller, unsigned long eventId, void* clientData, void* callData);
+    static void    onEndRender(vtkObject* caller, unsigned long eventId, void* clientData, void* callData);
+    static void    onButtonPress(vtkObject* caller, unsigned long eventId, void* clientData, void* callData);
+    static void    onButtonRelease(vtkObject* caller, unsigned long eventId, void* clientData, void* callData);
+    static void    onMouseWheel(vtkObject* caller, unsigned long eventId, void* clientData, void* callData);
+    void           onWheelIdle();
     void           WriteBmp(const char* filename, bool useScreenResolution);
     void           WritePng(const char* filename, bool useScreenResolution);
 
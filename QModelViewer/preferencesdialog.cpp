@@ -4,7 +4,7 @@
 #include <qabstractview.h>
 #include <QSettings>
 
-PreferencesDialog::PreferencesDialog(MouseMode mouseMode, QWidget *parent)
+PreferencesDialog::PreferencesDialog(MouseMode mouseMode, bool singlePrecision, QWidget *parent)
     : QDialog(parent, Qt::WindowCloseButtonHint),
     ui(new Ui::PreferencesDialog)
 {
@@ -20,6 +20,9 @@ PreferencesDialog::PreferencesDialog(MouseMode mouseMode, QWidget *parent)
         ui->radioButtonJoystick->setChecked(true);
     }
 
+    this->singlePrecision = singlePrecision;
+    ui->checkBoxSinglePrecision->setChecked(singlePrecision);
+
     // lamda lamda lamda
 
     connect(ui->radioButtonTrackball, &QAbstractButton::clicked,
@@ -33,6 +36,12 @@ PreferencesDialog::PreferencesDialog(MouseMode mouseMode, QWidget *parent)
             interactorStyle = MouseMode::mmJoystick;
             }
     );
+
+    connect(ui->checkBoxSinglePrecision, &QAbstractButton::clicked,
+            [=](bool checked) {
+            this->singlePrecision = checked;
+            }
+    );
 }
 
 PreferencesDialog::~PreferencesDialog()
@@ -14,10 +14,11 @@ class PreferencesDialog : public QDialog
     Q_OBJECT
 
 public:
-    explicit PreferencesDialog(MouseMode mouseMode, QWidget *parent = nullptr);
+    explicit PreferencesDialog(MouseMode mouseMode, bool singlePrecision, QWidget *parent = nullptr);
     ~PreferencesDialog();
 
     MouseMode interactorStyle;
+    bool      singlePrecision;
 
 private:
     Ui::PreferencesDialog *ui;
@@ -68,9 +68,9 @@ void SolidDialog::reinitialize()
 
 void SolidDialog::activate(bool b)
 {
-    ui->radioButtonSmooth->setEnabled(b && doc->gridType() != GridType::MV_UNSTRUCTURED_GRID);
-    ui->radioButtonBlocky->setEnabled(b && doc->gridType() != GridType::MV_UNSTRUCTURED_GRID && mPrimaryScalarMode == ScalarMode::MV_CELL_SCALARS);
-    ui->radioButtonBanded->setEnabled(b && doc->gridType() != GridType::MV_UNSTRUCTURED_GRID);
+    ui->radioButtonSmooth->setEnabled(b);
+    ui->radioButtonBlocky->setEnabled(b && mPrimaryScalarMode == ScalarMode::MV_CELL_SCALARS);
+    ui->radioButtonBanded->setEnabled(b);
     ui->checkBoxApplyThreshold->setEnabled(b);
     ui->spinBoxColorBands->setEnabled(b && ui->radioButtonBanded->isChecked());
     ui->pushButtonApply->setEnabled(b);
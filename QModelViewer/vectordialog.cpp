@@ -25,6 +25,18 @@ VectorDialog::VectorDialog(QWidget* parent, MvDoc* doc)
     QDoubleValidator* doubleValidator = new QDoubleValidator(this);
 
     // Subsample (CVectorControlsPage)
+    mStructuredGrid = true;
+    mColMin         = 0;
+    mColMax         = 0;
+    mColRate        = 1;
+    mRowMin         = 0;
+    mRowMax         = 0;
+    mRowRate        = 1;
+    mLayMin         = 0;
+    mLayMax         = 0;
+    mLayRate        = 1;
+    mScreenSpacing  = 10;
+
     mColLowerLimit = 0;
     mColUpperLimit = 0;
     mRowLowerLimit = 0;
@@ -35,6 +47,7 @@ VectorDialog::VectorDialog(QWidget* parent, MvDoc* doc)
     ui->spinBoxIRate->setRange(1, VTK_INT_MAX);
     ui->spinBoxJRate->setRange(1, VTK_INT_MAX);
     ui->spinBoxKRate->setRange(1, VTK_INT_MAX);
+    ui->spinBoxScreenSpacing->setRange(0, 100);
 
     //connect(ui->spinBoxIMin, QOverload<int>::of(&QSpinBox::valueChanged), this, &VectorDialog::apply);
     connect(ui->spinBoxIMin, QOverload<int>::of(&QSpinBox::valueChanged),
@@ -77,6 +90,11 @@ VectorDialog::VectorDialog(QWidget* parent, MvDoc* doc)
     connect(ui->spinBoxIRate, QOverload<int>::of(&QSpinBox::valueChanged), this, &VectorDialog::applySubsample);
     connect(ui->spinBoxJRate, QOverload<int>::of(&QSpinBox::valueChanged), this, &VectorDialog::applySubsample);
     connect(ui->spinBoxKRate, QOverload<int>::of(&QSpinBox::valueChanged), this, &VectorDialog::applySubsample);
+    connect(ui->spinBoxScreenSpacing, QOverload<int>::of(&QSpinBox::valueChanged),
+            [=](int val) {
+                mScreenSpacing = val;
+                doc->setVectorScreenSpacing(mScreenSpacing);
+            });
 
     // Appearance (CVectorOptionsPage)
     mScaleFactor  = 0.0;
@@ -242,6 +260,7 @@ void VectorDialog::activateSubsample(bool b)
     ui->spinBoxJMax->setEnabled(b && mStructuredGrid);
     ui->spinBoxKMin->setEnabled(b && mStructuredGrid);
     ui->spinBoxKMax->setEnabled(b && mStructuredGrid);
+    ui->spinBoxScreenSpacing->setEnabled(b && !mStructuredGrid);
 }
 
 void VectorDialog::activateAppearance(bool b)
@@ -381,6 +400,8 @@ bool VectorDialog::updateDataSubsample(bool saveAndValidate)
         mLayMin  = ui->spinBoxKMin->value();
         mLayMax  = ui->spinBoxKMax->value();
         mLayRate = ui->spinBoxKRate->value();
+
+        mScreenSpacing = ui->spinBoxScreenSpacing->value();
     }
     else
     {
@@ -404,6 +425,9 @@ bool VectorDialog::updateDataSubsample(bool saveAndValidate)
         ui->spinBoxKMin->setValue(mLayLowerLimit);
         ui->spinBoxKMax->setValue(mLayUpperLimit);
         ui->spinBoxKRate->setValue(mLayRate);
+
+        QSignalBlocker spacingBlock(ui->spinBoxScreenSpacing);
+        ui->spinBoxScreenSpacing->setValue(mScreenSpacing);
     }
     return true;
 }
@@ -746,8 +770,13 @@ void VectorDialog::defaultSubsample()
     mColRate = 1;
     mRowRate = 1;
     mLayRate = 1;
+    mScreenSpacing = 10;
     updateDataSubsample(false);
     applySubsample();
+    if (!mStructuredGrid)
+    {
+        doc->setVectorScreenSpacing(mScreenSpacing);
+    }
 }
 
 void VectorDialog::defaultAppearance()
@@ -46,6 +46,7 @@ public:
     int    mLayMin;
     int    mLayMax;
     int    mLayRate;
+    int    mScreenSpacing;
 
     int    mColLowerLimit;
     int    mColUpperLimit;
@@ -6,6 +6,10 @@
 #include <fstream>
 #include <stdlib.h>
 #include <string.h>
+#include <algorithm>
+#include <future>
+#include <thread>
+#include <vector>
 
 #if defined(QT_GUI_LIB)
 #include <QDebug>
@@ -21,6 +25,12 @@
 static char THIS_FILE[] = __FILE__;
 #endif
 
+static const char *LoadCancelledMessage = "Loading was cancelled.";
+
+// Each layer record of the head file starts with kstp, kper, pertim, totim,
+// text and three ints
+static const std::streamoff HeadHeaderSize = 5 * sizeof(int) + 2 * sizeof(double) + 16 * sizeof(char);
+
 /*
 Terminology:
 
@@ -50,11 +60,60 @@ m_NumberOfVTKCells = number of vtkcells. For DIS and DISV grids, includes inacti
 
 */
 
+// Assigns indices to the vtkpoints on a sheet of the stairstepped grid, so that
+// a vertex shared by cell2d's at the same elevation is stored only once. The
+// coordinates of new vtkpoints are appended to a coordinate array shared by all
+// sheets. For each vertex, the vtkpoints already on the sheet are kept in a
+// linked list through the "next" array, which is also shared by all sheets.
+class StairsteppedSheet
+{
+public:
+    StairsteppedSheet(int numVertices, std::vector<double> &coordinates, std::vector<int> &next)
+        : m_Head(numVertices, -1), m_Coordinates(coordinates), m_Next(next)
+    {
+    }
+
+    void Clear() { std::fill(m_Head.begin(), m_Head.end(), -1); }
+    void Swap(StairsteppedSheet &other) { m_Head.swap(other.m_Head); }
+
+    int  GetPoint(int vertex, double x, double y, double z)
+    {
+        for (int p = m_Head[vertex]; p >= 0; p = m_Next[p])
+        {
+            if (m_Coordinates[3 * p + 2] == z)
+            {
+                return p;
+            }
+        }
+        int p = static_cast<int>(m_Next.size());
+        m_Coordinates.push_back(x);
+        m_Coordinates.push_back(y);
+        m_Coordinates.push_back(z);
+        m_Next.push_back(m_Head[vertex]);
+        m_Head[vertex] = p;
+        return p;
+    }
+
+private:
+    std::vector<int>     m_Head;
+    std::vector<double> &m_Coordinates;
+    std::vector<int>    &m_Next;
+};
+
+// Copies the welded coordinates to a new array
+static double *CopyCoordinates(const std::vector<double> &coordinates)
+{
+    double *array = new double[coordinates.size()];
+    std::copy(coordinates.begin(), coordinates.end(), array);
+    return array;
+}
+
 Modflow6DataSource::Modflow6DataSource()
     : mvDataSource()
 {
     m_NumberOfVTKPoints            = 0;
     m_NumberOfVTKCells             = 0;
+    m_NumberOfVTKPointsForStairsteppedGrid = 0;
     m_GridType                     = GridType::MV_GRID_NOT_DEFINED;
     m_NumberOfScalarDataTypes      = 0;
     m_NumberOfCellColumns          = 0;
@@ -81,17 +140,33 @@ Modflow6DataSource::Modflow6DataSource()
     m_Delr                         = 0;
     m_Delc_revdir                  = 0;
     m_Elev                         = 0;
+    m_Vertices                     = 0;
+    m_Top                          = 0;
+    m_PointCellOffset              = 0;
+    m_PointCell                    = 0;
+    m_PointCellWeight              = 0;
     m_xorigin                      = 0.0;
     m_yorigin                      = 0.0;
     m_angrot                       = 0.0;
     m_BudgetText                   = 0;
     m_PeriodStep                   = 0;
     m_Rgba                         = 0;
-    m_MfCell2VtkCells              = 0;
+    m_MfCell2VtkCellOffset         = 0;
     m_ConnectivityArray            = 0;
     m_LayerConnectivity            = 0;
     m_StairsteppedGridConnectivity = 0;
     m_NumberOfVTKCellsInLayer      = 0;
+    m_HeadScanEnd                  = 0;
+    m_BudgetScanEnd                = -1;
+    m_SubgridActive                = 0;
+    for (int i = 0; i < 6; i++)
+    {
+        m_SubgridExtent[i] = 0;
+    }
+    m_ScalarDataType               = ScalarDataType::Head;
+    m_ReferenceTimePoint           = 0;
+    m_NumberOfComparisonTimePoints = 0;
+    m_CurrentHeadStart             = -1;
 }
 
 Modflow6DataSource::~Modflow6DataSource()
@@ -108,6 +183,11 @@ Modflow6DataSource::~Modflow6DataSource()
     if (m_Delr) delete[] m_Delr;
     if (m_Delc_revdir) delete[] m_Delc_revdir;
     if (m_Elev) delete[] m_Elev;
+    if (m_Vertices) delete[] m_Vertices;
+    if (m_Top) delete[] m_Top;
+    if (m_PointCellOffset) delete[] m_PointCellOffset;
+    if (m_PointCell) delete[] m_PointCell;
+    if (m_PointCellWeight) delete[] m_PointCellWeight;
     if (m_BudgetText) delete m_BudgetText;
     if (m_PeriodStep) delete m_PeriodStep;
     if (m_ConnectivityArray) delete[] m_ConnectivityArray;
@@ -122,14 +202,7 @@ Modflow6DataSource::~Modflow6DataSource()
         }
         delete[] m_Rgba;
     }
-    if (m_MfCell2VtkCells)
-    {
-        for (int i = 0; i < m_NumberOfModflowCells; i++)
-        {
-            delete[] m_MfCell2VtkCells[i];
-        }
-        delete[] m_MfCell2VtkCells;
-    }
+    if (m_MfCell2VtkCellOffset) delete[] m_MfCell2VtkCellOffset;
 }
 
 void Modflow6DataSource::GetDefaultModelFeatureColor(int i, double *rgba)
@@ -156,9 +229,11 @@ const char *Modflow6DataSource::LoadData(char *dataFileList)
     char gridFile[256];
     char headFile[256];
     char budgetFile[256];
+    char comparisonFile[256];
     gridFile[0]        = '\0';
     headFile[0]        = '\0';
     budgetFile[0]      = '\0';
+    comparisonFile[0]  = '\0';
     const char *errMsg = nullptr;
     int         i;
 
@@ -220,6 +295,8 @@ const char *Modflow6DataSource::LoadData(char *dataFileList)
             return "Error encountered while reading the binary grid file to determine the grid type.";
         }
     }
+    // The head file of a second run to compare with may follow
+    ParseDataFileList(pList, comparisonFile);
 
     // open head file
     m_IfHead.open(headFile, ios::in | ios::binary);
@@ -227,6 +304,22 @@ const char *Modflow6DataSource::LoadData(char *dataFileList)
     {
         return "Error: Unable to open the head file.";
     }
+#if defined(QT_GUI_LIB)
+    m_HeadFileName = QDir::current().absoluteFilePath(QString::fromLocal8Bit(headFile)).toLocal8Bit().constData();
+#else
+    m_HeadFileName = headFile;
+#endif
+
+    // open the comparison head file, if it is specified
+    if (strlen(comparisonFile))
+    {
+        mvInputFileStream::ResolveCompressedFileName(comparisonFile, 256);
+        m_IfComparisonHead.open(comparisonFile, ios::in | ios::binary);
+        if (!m_IfComparisonHead.is_open())
+        {
+            return "Error: Unable to open the comparison head file.";
+        }
+    }
 
     // open budget file, if it is specified.
     // if budget file is not specified, or error is encountered when opening
@@ -237,6 +330,10 @@ const char *Modflow6DataSource::LoadData(char *dataFileList)
     }
 
     // construct the grid
+    if (ReportLoadProgress("Reading grid file", 0, 1))
+    {
+        return LoadCancelledMessage;
+    }
     errMsg = nullptr;
     switch (m_GridType)
     {
@@ -254,6 +351,10 @@ const char *Modflow6DataSource::LoadData(char *dataFileList)
         break;
     }
     if (errMsg) return errMsg;
+    if (ReportLoadProgress("Reading grid file", 1, 1))
+    {
+        return LoadCancelledMessage;
+    }
 
     const int dataTypeLabelLength  = 17;
     const int maxNumberOfDataTypes = 4; // temporary
@@ -266,18 +367,44 @@ const char *Modflow6DataSource::LoadData(char *dataFileList)
 
     // Count the head file
     errMsg = CountHead(dataTypeLabel[0]);
-    if (m_NumberOfTimePoints == 0)
+    if (errMsg || m_NumberOfTimePoints == 0)
     {
         for (i = 0; i < maxNumberOfDataTypes; i++)
         {
             delete[] dataTypeLabel[i];
         }
         delete[] dataTypeLabel;
-        return "Error: No head data.";
+        return errMsg ? errMsg : "Error: No head data.";
     }
     mvUtil::ToLowerCase(dataTypeLabel[0]);
     m_NumberOfScalarDataTypes = 1;
 
+    // Drawdowns are computed from the heads as they are read
+    if (strstr(dataTypeLabel[0], "head"))
+    {
+        strcpy(dataTypeLabel[1], "drawdown");
+        m_NumberOfScalarDataTypes = 2;
+        if (m_IfComparisonHead.is_open())
+        {
+            errMsg = CountComparisonHead();
+            strcpy(dataTypeLabel[2], "drawdown (runs)");
+            m_NumberOfScalarDataTypes = 3;
+        }
+    }
+    else if (m_IfComparisonHead.is_open())
+    {
+        errMsg = "Error: A comparison file can only be used with a head file.";
+    }
+    if (errMsg)
+    {
+        for (i = 0; i < maxNumberOfDataTypes; i++)
+        {
+            delete[] dataTypeLabel[i];
+        }
+        delete[] dataTypeLabel;
+        return errMsg;
+    }
+
     // TO DO: count the remaining scalar files, if used
 
     // Store the data type labels
@@ -298,39 +425,20 @@ const char *Modflow6DataSource::LoadData(char *dataFileList)
     int    *periods    = new int[m_NumberOfTimePoints];
     int    *steps      = new int[m_NumberOfTimePoints];
     GetTimePoints(timePoints, periods, steps);
+    m_TimePoints.assign(timePoints, timePoints + m_NumberOfTimePoints);
     m_TimePointLabels = new char *[m_NumberOfTimePoints];
-    char p[10];
     for (i = 0; i < m_NumberOfTimePoints; i++)
     {
         m_TimePointLabels[i] = new char[35];
-        sprintf(m_TimePointLabels[i], "%.4g", timePoints[i]);
-        mvUtil::TrimRight(m_TimePointLabels[i]);
-        /*
-          if (GetTimeUnit() != "")
-          {
-              strcat(m_TimePointLabels[i], " ");
-              strcat(m_TimePointLabels[i], GetTimeUnit());
-              strcat(m_TimePointLabels[i], " ");
-          }
-        */
-        if (periods[i] > 0 || steps[i] > 0)
-        {
-            strcat(m_TimePointLabels[i], " (");
-            sprintf(p, "%-4u", periods[i]);
-            mvUtil::TrimRight(p);
-            strcat(m_TimePointLabels[i], p);
-            sprintf(p, "-%-4u", steps[i]);
-            mvUtil::TrimRight(p);
-            strcat(m_TimePointLabels[i], p);
-            strcat(m_TimePointLabels[i], ")");
-        }
+        MakeTimePointLabel(m_TimePointLabels[i], timePoints[i], periods[i], steps[i]);
     }
 
     delete[] timePoints;
     delete[] periods;
     delete[] steps;
 
-    int scalarArraySize        = m_NumberOfScalarDataTypes * (m_NumberOfVTKPoints + m_NumberOfVTKCells);
+    // Only the active scalar data type is held
+    int scalarArraySize        = m_NumberOfVTKPoints + m_NumberOfVTKCells;
     m_ScalarArray              = new double[scalarArraySize];
 
     // Count budget file and model features
@@ -340,6 +448,10 @@ const char *Modflow6DataSource::LoadData(char *dataFileList)
     if (m_IfBudget.is_open())
     {
         errMsg = CountBudgetAndFeatures();
+        if (m_LoadCancelled)
+        {
+            return errMsg;
+        }
         if (m_ModelFeatureArraySize)
         {
             m_ModelFeatureArray = new int[m_ModelFeatureArraySize];
@@ -356,6 +468,32 @@ const char *Modflow6DataSource::LoadData(char *dataFileList)
     return nullptr;
 }
 
+void Modflow6DataSource::MakeTimePointLabel(char *label, double time, int period, int step)
+{
+    char p[10];
+    sprintf(label, "%.4g", time);
+    mvUtil::TrimRight(label);
+    /*
+      if (GetTimeUnit() != "")
+      {
+          strcat(label, " ");
+          strcat(label, GetTimeUnit());
+          strcat(label, " ");
+      }
+    */
+    if (period > 0 || step > 0)
+    {
+        strcat(label, " (");
+        sprintf(p, "%-4u", period);
+        mvUtil::TrimRight(p);
+        strcat(label, p);
+        sprintf(p, "-%-4u", step);
+        mvUtil::TrimRight(p);
+        strcat(label, p);
+        strcat(label, ")");
+    }
+}
+
 int Modflow6DataSource::GetNumVTKPoints()
 {
     return m_NumberOfVTKPoints;
@@ -533,6 +671,13 @@ const char *Modflow6DataSource::ExtractModflowOutputFileNames(char *nameFile,
         }
     }
     in.close();
+
+    // archived output may have been compressed in place, e.g. model.hds.gz
+    mvInputFileStream::ResolveCompressedFileName(headFile, 256);
+    if (strlen(budgetFile))
+    {
+        mvInputFileStream::ResolveCompressedFileName(budgetFile, 256);
+    }
     return nullptr;
 }
 
@@ -735,53 +880,45 @@ const char *Modflow6DataSource::CreateDisGrid(char *gridFile)
         y[i + 1] = yy;
     }
 
-    // coordinates for stairstep grid
-    // These have to correspond to the orientation of structured grid--layers counted from bottom upward
-    m_StairsteppedGridCoordinates = new double[24 * m_NumberOfModflowCells];
-    int m                         = 0;
-    for (k = 0; k < m_NumberOfCellLayers; k++)
+    // coordinates and connectivity for stairstep grid
+    // These have to correspond to the orientation of structured grid--layers counted from bottom upward.
+    // Corners shared by adjacent cells at the same elevation are stored once. Each sheet is
+    // welded separately, so corners on different sheets are never merged.
+    int m = 0;
     {
-        for (j = 0; j < m_NumberOfCellRows; j++)
+        std::vector<double> coordinates;
+        std::vector<int>    next;
+        StairsteppedSheet   lower(nxy, coordinates, next);
+        StairsteppedSheet   upper(nxy, coordinates, next);
+        m_StairsteppedGridConnectivity = new int[9 * m_NumberOfModflowCells];
+        for (k = 0; k < m_NumberOfCellLayers; k++)
         {
-            for (i = 0; i < m_NumberOfCellColumns; i++)
+            for (j = 0; j < m_NumberOfCellRows; j++)
             {
-                int ijk                            = k * m_Ncpl + j * m_NumberOfCellColumns + i;
-
-                m_StairsteppedGridCoordinates[m++] = x[i];
-                m_StairsteppedGridCoordinates[m++] = y[j];
-                m_StairsteppedGridCoordinates[m++] = m_Elev[ijk];
-
-                m_StairsteppedGridCoordinates[m++] = x[i + 1];
-                m_StairsteppedGridCoordinates[m++] = y[j];
-                m_StairsteppedGridCoordinates[m++] = m_Elev[ijk];
-
-                m_StairsteppedGridCoordinates[m++] = x[i + 1];
-                m_StairsteppedGridCoordinates[m++] = y[j + 1];
-                m_StairsteppedGridCoordinates[m++] = m_Elev[ijk];
-
-                m_StairsteppedGridCoordinates[m++] = x[i];
-                m_StairsteppedGridCoordinates[m++] = y[j + 1];
-                m_StairsteppedGridCoordinates[m++] = m_Elev[ijk];
-
-                ijk += m_Ncpl;
-
-                m_StairsteppedGridCoordinates[m++] = x[i];
-                m_StairsteppedGridCoordinates[m++] = y[j];
-                m_StairsteppedGridCoordinates[m++] = m_Elev[ijk];
-
-                m_StairsteppedGridCoordinates[m++] = x[i + 1];
-                m_StairsteppedGridCoordinates[m++] = y[j];
-                m_StairsteppedGridCoordinates[m++] = m_Elev[ijk];
-
-                m_StairsteppedGridCoordinates[m++] = x[i + 1];
-                m_StairsteppedGridCoordinates[m++] = y[j + 1];
-                m_StairsteppedGridCoordinates[m++] = m_Elev[ijk];
-
-                m_StairsteppedGridCoordinates[m++] = x[i];
-                m_StairsteppedGridCoordinates[m++] = y[j + 1];
-                m_StairsteppedGridCoordinates[m++] = m_Elev[ijk];
+                for (i = 0; i < m_NumberOfCellColumns; i++)
+                {
+                    int    ijk                          = k * m_Ncpl + j * m_NumberOfCellColumns + i;
+                    int    v                            = j * nx + i;
+                    double zb                           = m_Elev[ijk];
+                    double zt                           = m_Elev[ijk + m_Ncpl];
+                    // vtk hexahedron ordering, bottom face then top face
+                    m_StairsteppedGridConnectivity[m++] = 8;
+                    m_StairsteppedGridConnectivity[m++] = lower.GetPoint(v + nx, x[i], y[j + 1], zb);
+                    m_StairsteppedGridConnectivity[m++] = lower.GetPoint(v + nx + 1, x[i + 1], y[j + 1], zb);
+                    m_StairsteppedGridConnectivity[m++] = lower.GetPoint(v + 1, x[i + 1], y[j], zb);
+                    m_StairsteppedGridConnectivity[m++] = lower.GetPoint(v, x[i], y[j], zb);
+                    m_StairsteppedGridConnectivity[m++] = upper.GetPoint(v + nx, x[i], y[j + 1], zt);
+                    m_StairsteppedGridConnectivity[m++] = upper.GetPoint(v + nx + 1, x[i + 1], y[j + 1], zt);
+                    m_StairsteppedGridConnectivity[m++] = upper.GetPoint(v + 1, x[i + 1], y[j], zt);
+                    m_StairsteppedGridConnectivity[m++] = upper.GetPoint(v, x[i], y[j], zt);
+                }
             }
+            // the top sheet of this layer is the bottom sheet of the next layer
+            lower.Swap(upper);
+            upper.Clear();
         }
+        m_NumberOfVTKPointsForStairsteppedGrid = static_cast<int>(next.size());
+        m_StairsteppedGridCoordinates          = CopyCoordinates(coordinates);
     }
 
     // Compute coordinates at cell center for drawing vectors.
@@ -1102,53 +1239,6 @@ const char *Modflow6DataSource::CreateDisvGrid(char *gridFile)
         }
     }
 
-    // compute weight vectors (used to compute specific discharge at cell center)
-    // coordinates for blocky grid
-    m_NumberOfVTKPointsForStairsteppedGrid = 0;
-    for (i = 0; i < m_Ncpl; i++)
-    {
-        m_NumberOfVTKPointsForStairsteppedGrid += (2 * m_NumCell2dVert[i]);
-    }
-    m_NumberOfVTKPointsForStairsteppedGrid *= m_NumberOfCellLayers;
-    int cellCenterNodeBegin = m_NumberOfVTKPointsForStairsteppedGrid;
-    m_NumberOfVTKPointsForStairsteppedGrid += 2 * m_NumberOfModflowCells;
-
-    m_StairsteppedGridCoordinates = new double[3 * m_NumberOfVTKPointsForStairsteppedGrid];
-    m                             = 0;
-    // coordinates of vertices (store for each cell in counter clockwise orientation per VTK)
-    for (k = 0; k < m_NumberOfCellLayers; k++)
-    {
-        for (i = 0; i < m_Ncpl; i++)
-        {
-            for (j = m_NumCell2dVert[i] - 1; j >= 0; j--)
-            {
-                int p                              = 2 * (m_Javert[m_Iavert[i] + j]);
-                m_StairsteppedGridCoordinates[m++] = vert[p];
-                m_StairsteppedGridCoordinates[m++] = vert[p + 1];
-                m_StairsteppedGridCoordinates[m++] = m_Elev[(k + 1) * m_Ncpl + i]; // bottom face
-            }
-            for (j = m_NumCell2dVert[i] - 1; j >= 0; j--)
-            {
-                int p                              = 2 * (m_Javert[m_Iavert[i] + j]);
-                m_StairsteppedGridCoordinates[m++] = vert[p];
-                m_StairsteppedGridCoordinates[m++] = vert[p + 1];
-                m_StairsteppedGridCoordinates[m++] = m_Elev[k * m_Ncpl + i]; // top face
-            }
-        }
-    }
-    for (k = 0; k < m_NumberOfCellLayers; k++)
-    {
-        for (i = 0; i < m_Ncpl; i++)
-        {
-            m_StairsteppedGridCoordinates[m++] = cellx[i];
-            m_StairsteppedGridCoordinates[m++] = celly[i];
-            m_StairsteppedGridCoordinates[m++] = m_Elev[(k + 1) * m_Ncpl + i]; // bottom face
-            m_StairsteppedGridCoordinates[m++] = cellx[i];
-            m_StairsteppedGridCoordinates[m++] = celly[i];
-            m_StairsteppedGridCoordinates[m++] = m_Elev[k * m_Ncpl + i]; // top face
-        }
-    }
-
     // m_InterpolatedGridCoordinates contains x-y-z coordinates of points that define the grid
     // in VTK. These points are organized in "sheets"; the first sheet is the top of
     // MF layer 1, the second sheet is the bottom of MF layer 1, the third sheet is the bottom
@@ -1263,7 +1353,7 @@ const char *Modflow6DataSource::CreateDisvGrid(char *gridFile)
 
     // Map Modflow cells to VTK cells
     // Also calculate the size of m_ConductivityArray
-    m_MfCell2VtkCells         = new int *[m_NumberOfModflowCells];
+    m_MfCell2VtkCellOffset    = new int[m_NumberOfModflowCells + 1];
     m                         = 0;
     int n                     = 0;
     int connectivityArraySize = 0;
@@ -1271,38 +1361,29 @@ const char *Modflow6DataSource::CreateDisvGrid(char *gridFile)
     {
         for (i = 0; i < m_Ncpl; i++)
         {
+            m_MfCell2VtkCellOffset[m] = n;
             if (m_Idomain[m] > 0)
             {
                 if (m_NumCell2dVert[i] <= 6)
                 {
-                    m_MfCell2VtkCells[m]    = new int[2];
-                    m_MfCell2VtkCells[m][0] = 1;
-                    m_MfCell2VtkCells[m][1] = n;
                     n++;
                     connectivityArraySize += (1 + 2 * m_NumCell2dVert[i]);
                 }
                 else
                 {
-                    m_MfCell2VtkCells[m]    = new int[m_NumCell2dVert[i] + 1];
-                    m_MfCell2VtkCells[m][0] = m_NumCell2dVert[i];
-                    for (j = 1; j <= m_NumCell2dVert[i]; j++)
-                    {
-                        m_MfCell2VtkCells[m][j] = n;
-                        n++;
-                    }
+                    n += m_NumCell2dVert[i];
                     connectivityArraySize += (7 * m_NumCell2dVert[i]);
                 }
             }
             else
             {
                 // Inactive or pass-through cells don't get mapped
-                m_MfCell2VtkCells[m]    = new int[1];
-                m_MfCell2VtkCells[m][0] = 0;
                 connectivityArraySize++;
             }
             m++;
         }
     }
+    m_MfCell2VtkCellOffset[m] = n;
 
     // create the coordinates of the cell3d centers. These are used to draw vectors
     m_VectorGridCoordinates = new double[3 * m_NumberOfModflowCells];
@@ -1319,6 +1400,81 @@ const char *Modflow6DataSource::CreateDisvGrid(char *gridFile)
 
     //   m_VectorArray = new double[3*m_NumberOfModflowCells];
 
+    // coordinates and connectivity for stairstepped grid
+    // Vertices (and nodes of split cells) shared by cell2d's at the same elevation
+    // are stored once. Inactive cells have no vtkpoints.
+    {
+        std::vector<double> coordinates;
+        std::vector<int>    next;
+        StairsteppedSheet   upper(m_Nvert + m_Ncpl, coordinates, next);
+        StairsteppedSheet   lower(m_Nvert + m_Ncpl, coordinates, next);
+        int                *bottomFace = new int[maxVertPerCell2d];
+        int                *topFace    = new int[maxVertPerCell2d];
+        m_StairsteppedGridConnectivity = new int[connectivityArraySize];
+        m                              = 0;
+        int mf_cell_index              = 0;
+        for (k = 0; k < m_NumberOfCellLayers; k++)
+        {
+            for (i = 0; i < m_Ncpl; i++)
+            {
+                if (m_Idomain[mf_cell_index] <= 0)
+                {
+                    m_StairsteppedGridConnectivity[m++] = 0;
+                    mf_cell_index++;
+                    continue;
+                }
+                double zb = m_Elev[(k + 1) * m_Ncpl + i];
+                double zt = m_Elev[k * m_Ncpl + i];
+                int    nv = m_NumCell2dVert[i];
+                // vertices in counter clockwise orientation per VTK
+                for (j = 0; j < nv; j++)
+                {
+                    int v         = m_Javert[m_Iavert[i] + nv - 1 - j];
+                    bottomFace[j] = lower.GetPoint(v, vert[2 * v], vert[2 * v + 1], zb);
+                    topFace[j]    = upper.GetPoint(v, vert[2 * v], vert[2 * v + 1], zt);
+                }
+                if (nv <= 6)
+                {
+                    // do not split cell
+                    m_StairsteppedGridConnectivity[m++] = 2 * nv;
+                    for (j = 0; j < nv; j++)
+                    {
+                        m_StairsteppedGridConnectivity[m++] = bottomFace[j];
+                    }
+                    for (j = 0; j < nv; j++)
+                    {
+                        m_StairsteppedGridConnectivity[m++] = topFace[j];
+                    }
+                }
+                else
+                {
+                    // split cell into triangular prisms
+                    int nodeBottom = lower.GetPoint(m_Nvert + i, cellx[i], celly[i], zb);
+                    int nodeTop    = upper.GetPoint(m_Nvert + i, cellx[i], celly[i], zt);
+                    for (int pp = 0; pp < nv; pp++)
+                    {
+                        int pp1                             = (pp + 1) % nv; // wrap around for the last vertex
+                        m_StairsteppedGridConnectivity[m++] = 6;
+                        m_StairsteppedGridConnectivity[m++] = nodeBottom;
+                        m_StairsteppedGridConnectivity[m++] = bottomFace[pp];
+                        m_StairsteppedGridConnectivity[m++] = bottomFace[pp1];
+                        m_StairsteppedGridConnectivity[m++] = nodeTop;
+                        m_StairsteppedGridConnectivity[m++] = topFace[pp];
+                        m_StairsteppedGridConnectivity[m++] = topFace[pp1];
+                    }
+                }
+                mf_cell_index++;
+            }
+            // the bottom sheet of this layer is the top sheet of the next layer
+            upper.Swap(lower);
+            lower.Clear();
+        }
+        delete[] bottomFace;
+        delete[] topFace;
+        m_NumberOfVTKPointsForStairsteppedGrid = static_cast<int>(next.size());
+        m_StairsteppedGridCoordinates          = CopyCoordinates(coordinates);
+    }
+
     delete[] vert;
     delete[] cellx;
     delete[] celly;
@@ -1414,53 +1570,6 @@ const char *Modflow6DataSource::CreateDisvGrid(char *gridFile)
         }
     }
 
-    // build connectivity for stairstepped grid
-    m_StairsteppedGridConnectivity = new int[connectivityArraySize];
-    m                              = 0;
-    p                              = 0;
-    mf_cell_index                  = 0;
-    for (k = 0; k < m_NumberOfCellLayers; k++)
-    {
-        int mf_vertex_offset = k * m_Nvert;
-        for (i = 0; i < m_Ncpl; i++)
-        {
-            if (m_Idomain[mf_cell_index] > 0)
-            {
-                if (m_NumCell2dVert[i] <= 6)
-                {
-                    // do not split cell
-                    m_StairsteppedGridConnectivity[m++] = 2 * m_NumCell2dVert[i];
-                    for (j = 0; j < 2 * m_NumCell2dVert[i]; j++)
-                    {
-                        m_StairsteppedGridConnectivity[m++] = p++;
-                    }
-                }
-                else
-                {
-                    // split cell into triangular prisms
-                    for (int pp = 0; pp < m_NumCell2dVert[i]; pp++)
-                    {
-                        m_StairsteppedGridConnectivity[m++] = 6;
-                        m_StairsteppedGridConnectivity[m++] = cellCenterNodeBegin + 2 * (k * m_Nvert + i);
-                        m_StairsteppedGridConnectivity[m++] = p + pp;
-                        int pp1                             = (pp + 1) % m_NumCell2dVert[i]; // wrap around for the last vertex
-                        m_StairsteppedGridConnectivity[m++] = p + pp1;
-                        m_StairsteppedGridConnectivity[m++] = cellCenterNodeBegin + 2 * (k * m_Nvert + i) + 1;
-                        m_StairsteppedGridConnectivity[m++] = p + m_NumCell2dVert[i] + pp;
-                        m_StairsteppedGridConnectivity[m++] = p + m_NumCell2dVert[i] + pp1;
-                    }
-                    p += 2 * m_NumCell2dVert[i];
-                }
-            }
-            else
-            {
-                m_StairsteppedGridConnectivity[m++] = 0;
-                p += 2 * m_NumCell2dVert[i];
-            }
-            mf_cell_index++;
-        }
-    }
-
     return nullptr;
 }
 
@@ -1604,10 +1713,10 @@ const char *Modflow6DataSource::CreateDisuGrid(char *gridFile)
     }
 
     // compute the number of vertices for each cell2d, and the maximum number
-    // also compute m_NumberOfVTKPoints and m_NumberOfVTKCells
-    int maxVertPerCell2d = 0;
-    m_NumberOfVTKPoints  = 0;
-    m_NumberOfVTKCells   = 0;
+    // also compute m_NumberOfVTKCells and the size of the connectivity array
+    int maxVertPerCell2d      = 0;
+    int connectivityArraySize = 0;
+    m_NumberOfVTKCells        = 0;
     for (i = 0; i < m_NumberOfModflowCells; i++)
     {
         m_NumCell2dVert[i] = m_Iavert[i + 1] - m_Iavert[i] - 1; // does not count the cell's last vertex of, which is the same as the first vertes
@@ -1615,21 +1724,19 @@ const char *Modflow6DataSource::CreateDisuGrid(char *gridFile)
         {
             maxVertPerCell2d = m_NumCell2dVert[i];
         }
-        m_NumberOfVTKPoints += (2 * m_NumCell2dVert[i]);
         if (m_NumCell2dVert[i] <= 6)
         {
             // don't need to split cells
             m_NumberOfVTKCells++;
+            connectivityArraySize += (1 + 2 * m_NumCell2dVert[i]);
         }
         else
         {
             // split cells into wedges
             m_NumberOfVTKCells += m_NumCell2dVert[i];
+            connectivityArraySize += (7 * m_NumCell2dVert[i]);
         }
     }
-    // include the cell centers at top and bottom cell faces. These nodes might be needed to spilt cells
-    int cellCenterNodeBegin = m_NumberOfVTKPoints;
-    m_NumberOfVTKPoints += (2 * m_NumberOfModflowCells);
 
     // compute the number of flow connections for each cell
     for (i = 0; i < m_NumberOfModflowCells; i++)
@@ -1641,107 +1748,150 @@ const char *Modflow6DataSource::CreateDisuGrid(char *gridFile)
         }
     }
 
-    // TO DO: compute weight vectors to compute specific discharge
+    // Compute coordinates and connectivity (stairstepped grid only)
+    // A vertex shared by cells at the same elevation is stored once. The cell centers
+    // at top and bottom cell faces are needed to split cells with more than 6 vertices.
+    // Cells are not arranged in sheets, so all vtkpoints are welded together.
+    // Each point of a cell is also recorded with its inverse distance to the
+    // cell center, for interpolating cell values to the points.
+    int m = 0;
+    {
+        std::vector<double> coordinates;
+        std::vector<int>    next;
+        std::vector<int>    pairPoint;
+        std::vector<int>    pairCell;
+        std::vector<double> pairWeight;
+        StairsteppedSheet   sheet(m_Nvert + m_NumberOfModflowCells, coordinates, next);
+        int                *bottomFace = new int[maxVertPerCell2d];
+        int                *topFace    = new int[maxVertPerCell2d];
+        m_StairsteppedGridConnectivity = new int[connectivityArraySize];
+        pairPoint.reserve(2 * (size_t)njavert);
+        pairCell.reserve(2 * (size_t)njavert);
+        pairWeight.reserve(2 * (size_t)njavert);
+        for (i = 0; i < m_NumberOfModflowCells; i++)
+        {
+            int nv = m_NumCell2dVert[i];
+            // vertices in counter clockwise orientation per VTK
+            for (j = 0; j < nv; j++)
+            {
+                int v         = m_Javert[m_Iavert[i] + nv - 1 - j];
+                bottomFace[j] = sheet.GetPoint(v, vertices[2 * v], vertices[2 * v + 1], bot[i]);
+                topFace[j]    = sheet.GetPoint(v, vertices[2 * v], vertices[2 * v + 1], top[i]);
+            }
+            double zc = (top[i] + bot[i]) / 2;
+            for (j = 0; j < 2 * nv; j++)
+            {
+                int     p   = (j < nv) ? bottomFace[j] : topFace[j - nv];
+                double *xyz = &coordinates[3 * (size_t)p];
+                double  dx  = xyz[0] - cellx[i];
+                double  dy  = xyz[1] - celly[i];
+                double  dz  = xyz[2] - zc;
+                pairPoint.push_back(p);
+                pairCell.push_back(i);
+                pairWeight.push_back(1 / std::max(sqrt(dx * dx + dy * dy + dz * dz), 1.0e-30));
+            }
+            if (nv <= 6)
+            {
+                // do not split cell
+                m_StairsteppedGridConnectivity[m++] = 2 * nv;
+                for (j = 0; j < nv; j++)
+                {
+                    m_StairsteppedGridConnectivity[m++] = bottomFace[j];
+                }
+                for (j = 0; j < nv; j++)
+                {
+                    m_StairsteppedGridConnectivity[m++] = topFace[j];
+                }
+            }
+            else
+            {
+                // split cell into triangular prisms
+                int    nodeBottom = sheet.GetPoint(m_Nvert + i, cellx[i], celly[i], bot[i]);
+                int    nodeTop    = sheet.GetPoint(m_Nvert + i, cellx[i], celly[i], top[i]);
+                // the center nodes are half the cell thickness from the cell center
+                double weight     = 1 / std::max((top[i] - bot[i]) / 2, 1.0e-30);
+                pairPoint.push_back(nodeBottom);
+                pairPoint.push_back(nodeTop);
+                pairCell.push_back(i);
+                pairCell.push_back(i);
+                pairWeight.push_back(weight);
+                pairWeight.push_back(weight);
+                for (int pp = 0; pp < nv; pp++)
+                {
+                    int pp1                             = (pp + 1) % nv; // wrap around for the last prism
+                    m_StairsteppedGridConnectivity[m++] = 6;
+                    m_StairsteppedGridConnectivity[m++] = nodeBottom;
+                    m_StairsteppedGridConnectivity[m++] = bottomFace[pp];
+                    m_StairsteppedGridConnectivity[m++] = bottomFace[pp1];
+                    m_StairsteppedGridConnectivity[m++] = nodeTop;
+                    m_StairsteppedGridConnectivity[m++] = topFace[pp];
+                    m_StairsteppedGridConnectivity[m++] = topFace[pp1];
+                }
+            }
+        }
+        delete[] bottomFace;
+        delete[] topFace;
+        m_NumberOfVTKPoints           = static_cast<int>(next.size());
+        m_StairsteppedGridCoordinates = CopyCoordinates(coordinates);
 
-    // Compute coordinates (stairstepped grid only)
-    m_StairsteppedGridCoordinates = new double[3 * m_NumberOfVTKPoints];
-    int m                         = 0;
-    // coordinates of vertices (store for each cell in counter clockwise orientation per VTK,
-    // bottom face first, then top face)
-    for (i = 0; i < m_NumberOfModflowCells; i++)
-    {
-        for (j = m_NumCell2dVert[i] - 1; j >= 0; j--)
+        // sort the (point, cell) pairs by point
+        size_t numPairs   = pairPoint.size();
+        m_PointCellOffset = new int[m_NumberOfVTKPoints + 1];
+        m_PointCell       = new int[numPairs];
+        m_PointCellWeight = new double[numPairs];
+        memset(m_PointCellOffset, 0, (m_NumberOfVTKPoints + 1) * sizeof(int));
+        for (size_t k = 0; k < numPairs; k++)
+        {
+            m_PointCellOffset[pairPoint[k] + 1]++;
+        }
+        for (i = 0; i < m_NumberOfVTKPoints; i++)
         {
-            int k                              = 2 * (m_Javert[m_Iavert[i] + j]);
-            m_StairsteppedGridCoordinates[m++] = vertices[k];     // x coordinate
-            m_StairsteppedGridCoordinates[m++] = vertices[k + 1]; // y coordinate
-            m_StairsteppedGridCoordinates[m++] = bot[i];
+            m_PointCellOffset[i + 1] += m_PointCellOffset[i];
         }
-        for (j = m_NumCell2dVert[i] - 1; j >= 0; j--)
+        std::vector<int> fill(m_PointCellOffset, m_PointCellOffset + m_NumberOfVTKPoints);
+        for (size_t k = 0; k < numPairs; k++)
         {
-            int k                              = 2 * (m_Javert[m_Iavert[i] + j]);
-            m_StairsteppedGridCoordinates[m++] = vertices[k];
-            m_StairsteppedGridCoordinates[m++] = vertices[k + 1];
-            m_StairsteppedGridCoordinates[m++] = top[i];
+            int n                = fill[pairPoint[k]]++;
+            m_PointCell[n]       = pairCell[k];
+            m_PointCellWeight[n] = pairWeight[k];
         }
     }
-    // coordinates of cell centers at bottom and top faces of cells
+
+    // create the coordinates of the cell centers. These are used to draw vectors.
+    // DISU nodes are numbered as the cells, so node n is at center n - 1.
+    m_VectorGridCoordinates = new double[3 * m_NumberOfModflowCells];
     for (i = 0; i < m_NumberOfModflowCells; i++)
     {
-        m_StairsteppedGridCoordinates[m++] = cellx[i];
-        m_StairsteppedGridCoordinates[m++] = celly[i];
-        m_StairsteppedGridCoordinates[m++] = bot[i];
-        m_StairsteppedGridCoordinates[m++] = cellx[i];
-        m_StairsteppedGridCoordinates[m++] = celly[i];
-        m_StairsteppedGridCoordinates[m++] = top[i];
+        m_VectorGridCoordinates[3 * i]     = cellx[i];
+        m_VectorGridCoordinates[3 * i + 1] = celly[i];
+        m_VectorGridCoordinates[3 * i + 2] = (top[i] + bot[i]) / 2;
     }
 
-    delete[] top;
+    // the top and vertices are kept for GetTopSurface
+    m_Top      = top;
+    m_Vertices = vertices;
     delete[] bot;
-    delete[] vertices;
     delete[] cellx;
     delete[] celly;
 
-    // build connectivity (stairstepped grid only)
-    m_StairsteppedGridConnectivity = new int[m_NumberOfVTKPoints + m_NumberOfVTKCells];
-    m                              = 0;
-    int p                          = 0;
-    for (i = 0; i < m_NumberOfModflowCells; i++)
-    {
-        if (m_NumCell2dVert[i] <= 6)
-        {
-            // do not split cell
-            m_StairsteppedGridConnectivity[m++] = 2 * m_NumCell2dVert[i];
-            for (j = 0; j < 2 * m_NumCell2dVert[i]; j++)
-            {
-                m_StairsteppedGridConnectivity[m++] = p++;
-            }
-        }
-        else
-        {
-            // split cell into triangular prisms
-            for (int pp = 0; pp < m_NumCell2dVert[i]; pp++)
-            {
-                m_StairsteppedGridConnectivity[m++] = 6;
-                m_StairsteppedGridConnectivity[m++] = cellCenterNodeBegin + 2 * i;
-                m_StairsteppedGridConnectivity[m++] = p + pp;
-                int pp1                             = (pp + 1) % m_NumCell2dVert[i]; // wrap around for the last prism
-                m_StairsteppedGridConnectivity[m++] = p + pp1;
-                m_StairsteppedGridConnectivity[m++] = cellCenterNodeBegin + 2 * i + 1;
-                m_StairsteppedGridConnectivity[m++] = p + m_NumCell2dVert[i] + pp;
-                m_StairsteppedGridConnectivity[m++] = p + m_NumCell2dVert[i] + pp1;
-            }
-            p += 2 * m_NumCell2dVert[i];
-        }
-    }
-
     // Map Modflow cells to VTK cells
-    m_MfCell2VtkCells = new int *[m_NumberOfModflowCells];
-    m                 = 0;
-    int n             = 0;
+    m_MfCell2VtkCellOffset = new int[m_NumberOfModflowCells + 1];
+    int n                  = 0;
     for (i = 0; i < m_NumberOfModflowCells; i++)
     {
+        m_MfCell2VtkCellOffset[i] = n;
         if (m_NumCell2dVert[i] <= 6)
         {
             // one-to-one mapping between Mf cell and Vtk cell
-            m_MfCell2VtkCells[m]    = new int[2];
-            m_MfCell2VtkCells[m][0] = 1;
-            m_MfCell2VtkCells[m][1] = n;
             n++;
         }
         else
         {
             // Mf cell split into multiple Vtk cells
-            m_MfCell2VtkCells[m]    = new int[m_NumCell2dVert[i] + 1];
-            m_MfCell2VtkCells[m][0] = m_NumCell2dVert[i];
-            for (j = 1; j <= m_NumCell2dVert[i]; j++)
-            {
-                m_MfCell2VtkCells[m][j] = n;
-                n++;
-            }
+            n += m_NumCell2dVert[i];
         }
-        m++;
     }
+    m_MfCell2VtkCellOffset[m_NumberOfModflowCells] = n;
 
     return nullptr;
 }
@@ -1766,8 +1916,16 @@ const char *Modflow6DataSource::CountHead(char *dataTypeLabel)
     m_IfHead.seekg(0, m_IfHead.end);
     size_t length = m_IfHead.tellg();
     m_IfHead.seekg(0, m_IfHead.beg);
-    while (length > 0)
+    // A model that is still running may have written part of a time point
+    size_t timePointSize = HeadTimePointSize();
+    long long total      = length;
+    while (length >= timePointSize)
     {
+        if (ReportLoadProgress("Scanning head file", total - length, total))
+        {
+            m_NumberOfTimePoints = 0;
+            return LoadCancelledMessage;
+        }
         for (k = 0; k < kmax; k++)
         {
             m_IfHead.read((char *)(&kstp), sizeof(int));
@@ -1793,37 +1951,504 @@ const char *Modflow6DataSource::CountHead(char *dataTypeLabel)
             }
         }
     }
+    m_HeadScanEnd = (std::streamoff)m_NumberOfTimePoints * timePointSize;
+    m_BudgetScanEnd = -1;
     strncpy(dataTypeLabel, text, 16);
     dataTypeLabel[16] = '\0';
     mvUtil::TrimRight(dataTypeLabel);
     return nullptr;
 }
 
-const char *Modflow6DataSource::CountBudgetAndFeatures()
+// Returns the number of bytes the head file uses for one time point
+size_t Modflow6DataSource::HeadTimePointSize()
 {
-    int    kstp, kper, ndim1, ndim2, ndim3, imeth, i, j, nlist, nval, match;
-    double delt, pertim, totim, value, t1;
-    char   flowType[17], text[16], auxtxt[16];
-    flowType[16] = '\0';
-    char *pname;
-    int  *pm;
-    m_BudgetText               = new mvLinkList;
-    mvLinkList *vtk_cell_count = new mvLinkList;
-    m_PeriodStep->InitTraversal();
-    int *perstp = (int *)m_PeriodStep->GetNextItem();
-    m_IfBudget.seekg(0, m_IfBudget.end);
-    size_t length = m_IfBudget.tellg();
-    m_IfBudget.seekg(0, m_IfBudget.beg);
-    m_NumberOfBudgetItems = 0;
-    int numTimePoints     = 0;
-    t1                    = 0;
-    while (length > 0 && numTimePoints < m_NumberOfTimePoints)
+    int jmax, kmax;
+    if (m_GridType == GridType::MV_UNSTRUCTURED_GRID)
     {
-        m_IfBudget.read((char *)(&kstp), sizeof(int));
-        m_IfBudget.read((char *)(&kper), sizeof(int));
-        if (kper != perstp[0] || kstp != perstp[1])
+        jmax = m_NumberOfModflowCells;
+        kmax = 1;
+    }
+    else
+    {
+        jmax = m_Ncpl;
+        kmax = m_NumberOfCellLayers;
+    }
+    return (size_t)kmax * (5 * sizeof(int) + (jmax + 2) * sizeof(double) + 16 * sizeof(char));
+}
+
+// Returns the number of bytes the head file uses for one layer of a time point.
+// DISU grids have a single record per time point.
+size_t Modflow6DataSource::HeadRecordSize()
+{
+    if (m_GridType == GridType::MV_UNSTRUCTURED_GRID)
+    {
+        return HeadTimePointSize();
+    }
+    return HeadTimePointSize() / m_NumberOfCellLayers;
+}
+
+// Returns the time point record in the head file that holds the heads of
+// a time point. Time point i is the i-th record, as counted by CountHead and
+// labeled by GetTimePoints. SetTimePointTo and the drawdown reference both
+// use this, so that a reference equal to the displayed time point gives no
+// drawdown.
+int Modflow6DataSource::HeadRecordOfTimePoint(int timePointIndex)
+{
+    return std::max(timePointIndex, 0);
+}
+
+int Modflow6DataSource::SetScalarSubgrid(int active, const int *extent)
+{
+    if (m_GridType == GridType::MV_UNSTRUCTURED_GRID)
+    {
+        return 0;
+    }
+    int before[6], after[6];
+    GetSubgridCellRange(before);
+    m_SubgridActive = active;
+    for (int i = 0; i < 6; i++)
+    {
+        m_SubgridExtent[i] = extent[i];
+    }
+    GetSubgridCellRange(after);
+    return memcmp(before, after, sizeof(before)) != 0;
+}
+
+// Gets the cells for which heads are read, as the ranges [range[0], range[1]),
+// [range[2], range[3]) and [range[4], range[5]). For a DIS grid these are vtk
+// column, row and layer indices, with layers counted from the bottom. For a
+// DISV grid only the layer range is used, with layers counted from the top.
+// The ranges include one cell around the subgrid, so that point values inside
+// the subgrid are interpolated as they are for the full grid.
+void Modflow6DataSource::GetSubgridCellRange(int *range)
+{
+    range[0] = 0;
+    range[1] = m_NumberOfCellColumns;
+    range[2] = 0;
+    range[3] = m_NumberOfCellRows;
+    range[4] = 0;
+    range[5] = m_NumberOfCellLayers;
+    if (!m_SubgridActive)
+    {
+        return;
+    }
+    if (m_GridType == GridType::MV_STRUCTURED_GRID)
+    {
+        // the extent is in point indices, so the subgrid cells are
+        // extent[0] through extent[1] - 1, and so on
+        for (int i = 0; i < 3; i++)
         {
-            perstp = (int *)m_PeriodStep->GetNextItem();
+            range[2 * i]     = std::max(range[2 * i], m_SubgridExtent[2 * i] - 1);
+            range[2 * i + 1] = std::min(range[2 * i + 1], m_SubgridExtent[2 * i + 1] + 1);
+            range[2 * i + 1] = std::max(range[2 * i + 1], range[2 * i]);
+        }
+    }
+    else if (m_GridType == GridType::MV_LAYERED_GRID)
+    {
+        // the extent gives the top and bottom layers of the subgrid
+        range[4] = std::max(0, m_SubgridExtent[4] - 1);
+        range[5] = std::min(m_NumberOfCellLayers, m_SubgridExtent[5] + 2);
+        range[5] = std::max(range[5], range[4]);
+    }
+}
+
+// Finds the head value of a cell, given as for GetTimeSeries. Gets the record of
+// a time point that holds it (the layer, counted from the top), its index in the
+// record and the index of the Modflow cell. Returns 0 if there is no such cell.
+int Modflow6DataSource::GetHeadLocation(int cell, int &layer, int &index, int &q)
+{
+    if (cell < 0 || cell >= m_NumberOfVTKCells)
+    {
+        return 0;
+    }
+    if (m_GridType == GridType::MV_STRUCTURED_GRID)
+    {
+        int ncol = m_NumberOfCellColumns;
+        int nrow = m_NumberOfCellRows;
+        int ncpl = ncol * nrow;
+        int kc   = cell / ncpl;
+        int jc   = (cell % ncpl) / ncol;
+        int ic   = cell % ncol;
+        layer    = m_NumberOfCellLayers - kc - 1;
+        index    = (nrow - jc - 1) * ncol + ic;
+        q        = layer * ncpl + index;
+        return 1;
+    }
+    // the vtkcells of a Modflow cell are numbered consecutively
+    int *offset = std::upper_bound(m_MfCell2VtkCellOffset, m_MfCell2VtkCellOffset + m_NumberOfModflowCells + 1, cell);
+    q           = (int)(offset - m_MfCell2VtkCellOffset) - 1;
+    if (q < 0 || q >= m_NumberOfModflowCells)
+    {
+        return 0;
+    }
+    if (m_GridType == GridType::MV_LAYERED_GRID)
+    {
+        layer = q / m_Ncpl;
+        index = q % m_Ncpl;
+    }
+    else
+    {
+        layer = 0;
+        index = q;
+    }
+    return 1;
+}
+
+// Returns the inactive cell value if a head value read for a cell indicates that
+// the cell is dry, or if the head is below the bottom of the cell. Otherwise
+// returns the value. This follows SetTimePointTo.
+double Modflow6DataSource::CheckHeadValue(int cell, int q, double value)
+{
+    if (PracticallyEqual(value, m_DryCellValue))
+    {
+        return m_InactiveCellValue;
+    }
+    if (m_GridType == GridType::MV_STRUCTURED_GRID)
+    {
+        if (m_Icelltype[q] != 0 && value < m_Elev[cell])
+        {
+            return m_InactiveCellValue;
+        }
+    }
+    else if (m_GridType == GridType::MV_LAYERED_GRID)
+    {
+        if (m_Icelltype[q] != 0 && value < m_Elev[q + m_Ncpl])
+        {
+            return m_InactiveCellValue;
+        }
+    }
+    return value;
+}
+
+// Reads the head values at the given offsets within each time point, from time
+// point t0 through t1 - 1, in the order of the offsets. Values are stored in
+// values as for GetTimeSeries. Returns 0 if the file could not be read.
+static int ReadHeadValues(std::istream &in, std::streamoff timePointSize, const std::vector<std::streamoff> &offsets,
+                          const std::vector<int> &order, int numTimePoints, int t0, int t1, double *values)
+{
+    for (int t = t0; t < t1; t++)
+    {
+        for (int c : order)
+        {
+            in.seekg((std::streamoff)t * timePointSize + offsets[c], ios::beg);
+            in.read((char *)(values + (size_t)c * numTimePoints + t), sizeof(double));
+        }
+    }
+    return !in.fail();
+}
+
+int Modflow6DataSource::GetTimeSeries(int numCells, const int *cells, double *values)
+{
+    int numTimePoints = m_NumberOfTimePoints;
+    if (!m_IfHead.is_open() || numTimePoints == 0 || numCells <= 0)
+    {
+        return 0;
+    }
+
+    // Each time point has the same layout, so the offset of a cell's value in a
+    // time point is the same for all time points.
+    std::streamoff              recordSize = HeadRecordSize();
+    std::vector<std::streamoff> offsets(numCells);
+    std::vector<int>            q(numCells);
+    std::vector<int>            order(numCells);
+    for (int c = 0; c < numCells; c++)
+    {
+        int layer, index;
+        if (!GetHeadLocation(cells[c], layer, index, q[c]))
+        {
+            return 0;
+        }
+        offsets[c] = layer * recordSize + HeadHeaderSize + (std::streamoff)index * sizeof(double);
+        order[c]   = c;
+    }
+    std::sort(order.begin(), order.end(), [&offsets](int a, int b) { return offsets[a] < offsets[b]; });
+
+    std::streamoff timePointSize = HeadTimePointSize();
+    int            ok            = 1;
+    if (m_IfHead.IsCompressed())
+    {
+        // A compressed file is only read efficiently from front to back, so the
+        // open stream is used and then returned to where it was.
+        m_IfHead.clear();
+        std::streamoff pos = m_IfHead.tellg();
+        ok                 = ReadHeadValues(m_IfHead, timePointSize, offsets, order, numTimePoints, 0, numTimePoints, values);
+        m_IfHead.clear();
+        m_IfHead.seekg(pos, ios::beg);
+    }
+    else
+    {
+        // The time points are divided among several threads, each reading from its
+        // own unbuffered stream, so that only the values of the cells are read.
+        const int minTimePointsPerThread = 16;
+        int       numThreads             = std::max(1, (int)std::thread::hardware_concurrency());
+        numThreads                       = std::min(numThreads, (numTimePoints + minTimePointsPerThread - 1) / minTimePointsPerThread);
+        std::vector<std::future<int>> parts;
+        for (int i = 0; i < numThreads; i++)
+        {
+            int t0 = (int)((long long)numTimePoints * i / numThreads);
+            int t1 = (int)((long long)numTimePoints * (i + 1) / numThreads);
+            parts.push_back(std::async(std::launch::async, [&, t0, t1]() {
+                std::ifstream in;
+                in.rdbuf()->pubsetbuf(nullptr, 0);
+                in.open(m_HeadFileName.c_str(), ios::in | ios::binary);
+                if (!in.is_open())
+                {
+                    return 0;
+                }
+                return ReadHeadValues(in, timePointSize, offsets, order, numTimePoints, t0, t1, values);
+            }));
+        }
+        for (auto &part : parts)
+        {
+            if (!part.get())
+            {
+                ok = 0;
+            }
+        }
+    }
+    if (!ok)
+    {
+        return 0;
+    }
+
+    for (int c = 0; c < numCells; c++)
+    {
+        double *cellValues = values + (size_t)c * numTimePoints;
+        for (int t = 0; t < numTimePoints; t++)
+        {
+            cellValues[t] = CheckHeadValue(cells[c], q[c], cellValues[t]);
+        }
+    }
+    return 1;
+}
+
+std::string Modflow6DataSource::GetCellDescription(int cell)
+{
+    int  layer, index, q;
+    char description[64];
+    if (!GetHeadLocation(cell, layer, index, q))
+    {
+        return std::string();
+    }
+    if (m_GridType == GridType::MV_STRUCTURED_GRID)
+    {
+        sprintf(description, "Layer %d, Row %d, Column %d", layer + 1,
+                index / m_NumberOfCellColumns + 1, index % m_NumberOfCellColumns + 1);
+    }
+    else if (m_GridType == GridType::MV_LAYERED_GRID)
+    {
+        sprintf(description, "Layer %d, Cell %d", layer + 1, index + 1);
+    }
+    else
+    {
+        sprintf(description, "Node %d", q + 1);
+    }
+    return std::string(description);
+}
+
+// Reads the header of the budget record at the current position and moves past
+// the record. Returns 0, leaving the position undefined, if the record does not
+// end before the given offset.
+int Modflow6DataSource::SkipBudgetRecord(std::streamoff end, int &kper, int &kstp)
+{
+    int    n1, n2, n3, imeth, nval, nlist;
+    double delt, pertim, totim;
+    char   text[16];
+    const std::streamoff headerSize = 6 * sizeof(int) + 3 * sizeof(double) + 16 * sizeof(char);
+    std::streamoff       pos        = m_IfBudget.tellg();
+    if (pos < 0 || pos + headerSize > end)
+    {
+        return 0;
+    }
+    m_IfBudget.read((char *)(&kstp), sizeof(int));
+    m_IfBudget.read((char *)(&kper), sizeof(int));
+    m_IfBudget.read(text, 16 * sizeof(char));
+    m_IfBudget.read((char *)(&n1), sizeof(int));
+    m_IfBudget.read((char *)(&n2), sizeof(int));
+    m_IfBudget.read((char *)(&n3), sizeof(int));
+    n3 = -n3;
+    m_IfBudget.read((char *)(&imeth), sizeof(int));
+    m_IfBudget.read((char *)(&delt), sizeof(double));
+    m_IfBudget.read((char *)(&pertim), sizeof(double));
+    m_IfBudget.read((char *)(&totim), sizeof(double));
+    pos += headerSize;
+    if (imeth == 1)
+    {
+        pos += (std::streamoff)n1 * n2 * n3 * sizeof(double);
+    }
+    else if (imeth == 6)
+    {
+        if (pos + 64 * sizeof(char) + sizeof(int) > end)
+        {
+            return 0;
+        }
+        m_IfBudget.seekg(64 * sizeof(char), ios::cur);
+        m_IfBudget.read((char *)(&nval), sizeof(int));
+        pos += 64 * sizeof(char) + sizeof(int) + (nval - 1) * 16 * sizeof(char) + sizeof(int);
+        if (pos > end)
+        {
+            return 0;
+        }
+        m_IfBudget.seekg((nval - 1) * 16 * sizeof(char), ios::cur);
+        m_IfBudget.read((char *)(&nlist), sizeof(int));
+        pos += (std::streamoff)nlist * (2 * sizeof(int) + nval * sizeof(double));
+    }
+    if (!m_IfBudget || pos > end)
+    {
+        return 0;
+    }
+    m_IfBudget.seekg(pos, ios::beg);
+    return 1;
+}
+
+int Modflow6DataSource::UpdateTimePoints()
+{
+    int    kstp, kper, i, k;
+    double pertim, totim;
+    if (!m_IfHead.is_open() || m_NumberOfTimePoints == 0 || m_IfHead.IsCompressed())
+    {
+        return 0;
+    }
+
+    // SetTimePointTo continues reading from the current positions, so these
+    // are restored after the new records have been scanned.
+    m_IfHead.clear();
+    std::streamoff headPos = m_IfHead.tellg();
+    m_IfHead.seekg(0, m_IfHead.end);
+    std::streamoff headEnd       = m_IfHead.tellg();
+    std::streamoff timePointSize = (std::streamoff)HeadTimePointSize();
+
+    // find the time points that have been completely written to the head file
+    std::vector<double> times;
+    std::vector<int>    periods, steps;
+    for (std::streamoff pos = m_HeadScanEnd; pos + timePointSize <= headEnd; pos += timePointSize)
+    {
+        m_IfHead.seekg(pos, m_IfHead.beg);
+        m_IfHead.read((char *)(&kstp), sizeof(int));
+        m_IfHead.read((char *)(&kper), sizeof(int));
+        m_IfHead.read((char *)(&pertim), sizeof(double));
+        m_IfHead.read((char *)(&totim), sizeof(double));
+        times.push_back(totim);
+        periods.push_back(kper);
+        steps.push_back(kstp);
+    }
+    m_IfHead.clear();
+    m_IfHead.seekg(headPos, m_IfHead.beg);
+    int numNew = (int)times.size();
+    if (numNew == 0)
+    {
+        return 0;
+    }
+
+    // A time point is only added once its budget records are complete too
+    if (m_IfBudget.is_open() && m_NumberOfBudgetItems > 0)
+    {
+        m_IfBudget.clear();
+        std::streamoff budgetPos = m_IfBudget.tellg();
+        m_IfBudget.seekg(0, m_IfBudget.end);
+        std::streamoff budgetEnd = m_IfBudget.tellg();
+        int            ok        = 1;
+        if (m_BudgetScanEnd < 0)
+        {
+            // find the end of the time points counted when the data were loaded
+            m_IfBudget.seekg(0, m_IfBudget.beg);
+            for (i = 0; i < m_NumberOfTimePoints * m_NumberOfBudgetItems && ok; i++)
+            {
+                ok = SkipBudgetRecord(budgetEnd, kper, kstp);
+            }
+            if (ok)
+            {
+                m_BudgetScanEnd = m_IfBudget.tellg();
+            }
+        }
+        int numComplete = 0;
+        if (ok)
+        {
+            std::streamoff scanEnd = m_BudgetScanEnd;
+            m_IfBudget.seekg(scanEnd, m_IfBudget.beg);
+            for (i = 0; i < numNew; i++)
+            {
+                for (k = 0; k < m_NumberOfBudgetItems && ok; k++)
+                {
+                    ok = SkipBudgetRecord(budgetEnd, kper, kstp) && kper == periods[i] && kstp == steps[i];
+                }
+                if (!ok)
+                {
+                    break;
+                }
+                scanEnd = m_IfBudget.tellg();
+                numComplete++;
+            }
+            m_BudgetScanEnd = scanEnd;
+        }
+        m_IfBudget.clear();
+        m_IfBudget.seekg(budgetPos, m_IfBudget.beg);
+        numNew = numComplete;
+        if (numNew == 0)
+        {
+            return 0;
+        }
+    }
+
+    // extend the time points and their labels
+    char **labels = new char *[m_NumberOfTimePoints + numNew];
+    for (i = 0; i < m_NumberOfTimePoints; i++)
+    {
+        labels[i] = m_TimePointLabels[i];
+    }
+    for (i = 0; i < numNew; i++)
+    {
+        labels[m_NumberOfTimePoints + i] = new char[35];
+        MakeTimePointLabel(labels[m_NumberOfTimePoints + i], times[i], periods[i], steps[i]);
+        int *perstp = new int[2];
+        perstp[0]   = periods[i];
+        perstp[1]   = steps[i];
+        m_PeriodStep->AddItem(perstp);
+    }
+    delete[] m_TimePointLabels;
+    m_TimePointLabels = labels;
+    m_TimePoints.insert(m_TimePoints.end(), times.begin(), times.begin() + numNew);
+    m_NumberOfTimePoints += numNew;
+    m_HeadScanEnd += numNew * timePointSize;
+    return numNew;
+}
+
+const char *Modflow6DataSource::CountBudgetAndFeatures()
+{
+    int    kstp, kper, ndim1, ndim2, ndim3, imeth, i, j, nlist, nval, match;
+    double delt, pertim, totim, value, t1;
+    char   flowType[17], text[16], auxtxt[16];
+    flowType[16] = '\0';
+    char *pname;
+    int  *pm;
+    m_BudgetText               = new mvLinkList;
+    mvLinkList *vtk_cell_count = new mvLinkList;
+    m_PeriodStep->InitTraversal();
+    int *perstp = (int *)m_PeriodStep->GetNextItem();
+    m_IfBudget.seekg(0, m_IfBudget.end);
+    size_t length = m_IfBudget.tellg();
+    m_IfBudget.seekg(0, m_IfBudget.beg);
+    m_NumberOfBudgetItems = 0;
+    int numTimePoints     = 0;
+    t1                    = 0;
+    long long total       = length;
+    m_BudgetSchema.clear();
+    while (length > 0 && numTimePoints < m_NumberOfTimePoints)
+    {
+        if (ReportLoadProgress("Scanning budget file", total - length, total))
+        {
+            m_IfBudget.close();
+            delete vtk_cell_count;
+            m_HasSpecificDischargeData = 0;
+            m_ModelFeatureArraySize    = 0;
+            m_BudgetSchema.clear();
+            return LoadCancelledMessage;
+        }
+        m_IfBudget.read((char *)(&kstp), sizeof(int));
+        m_IfBudget.read((char *)(&kper), sizeof(int));
+        if (kper != perstp[0] || kstp != perstp[1])
+        {
+            perstp = (int *)m_PeriodStep->GetNextItem();
             if (perstp == 0)
             {
                 // error -- execution should not get here
@@ -1831,6 +2456,7 @@ const char *Modflow6DataSource::CountBudgetAndFeatures()
                 delete vtk_cell_count;
                 m_HasSpecificDischargeData = 0;
                 m_ModelFeatureArraySize    = 0;
+                m_BudgetSchema.clear();
                 return nullptr;
             }
             if (kper != perstp[0] || kstp != perstp[1])
@@ -1840,6 +2466,7 @@ const char *Modflow6DataSource::CountBudgetAndFeatures()
                 delete vtk_cell_count;
                 m_HasSpecificDischargeData = 0;
                 m_ModelFeatureArraySize    = 0;
+                m_BudgetSchema.clear();
                 return nullptr;
             }
             else
@@ -1856,6 +2483,8 @@ const char *Modflow6DataSource::CountBudgetAndFeatures()
         m_IfBudget.read((char *)(&delt), sizeof(double));
         m_IfBudget.read((char *)(&pertim), sizeof(double));
         m_IfBudget.read((char *)(&totim), sizeof(double));
+        // the budget items of the first time step make up the schema
+        int inFirstStep = (t1 == 0 || t1 == totim);
         if (t1 == 0)
         {
             t1                    = totim;
@@ -1866,12 +2495,11 @@ const char *Modflow6DataSource::CountBudgetAndFeatures()
             m_NumberOfBudgetItems++;
         }
         length -= (6 * sizeof(int) + 3 * sizeof(double) + 16 * sizeof(char));
+        BudgetItemKind kind = BudgetItemKind::Ignored;
         if (imeth == 1)
         {
-            for (i = 0; i < ndim1 * ndim2 * ndim3; i++) // used only for intercell flow or storage, which are not displayed by Model Viewer
-            {
-                m_IfBudget.read((char *)(&value), sizeof(double));
-            }
+            // used only for intercell flow or storage, which are not displayed by Model Viewer
+            m_IfBudget.seekg((std::streamoff)ndim1 * ndim2 * ndim3 * sizeof(double), ios::cur);
             length -= ndim1 * ndim2 * ndim3 * sizeof(double);
         }
         else if (imeth == 6)
@@ -1879,7 +2507,7 @@ const char *Modflow6DataSource::CountBudgetAndFeatures()
             // read the data
             int num_vtk_cells_for_this_flowType = 0;
             int mf_cell_index;
-            int node, id2;
+            int node;
             m_IfBudget.read(text, 16 * sizeof(char));
             m_IfBudget.read(text, 16 * sizeof(char));
             m_IfBudget.read(text, 16 * sizeof(char));
@@ -1890,10 +2518,14 @@ const char *Modflow6DataSource::CountBudgetAndFeatures()
                 m_IfBudget.read(auxtxt, 16 * sizeof(char));
             }
             m_IfBudget.read((char *)(&nlist), sizeof(int));
-            for (i = 0; i < nlist; i++)
+            // each list entry is node, id2 and nval values
+            size_t entrySize = 2 * sizeof(int) + nval * sizeof(double);
+            m_BudgetListBuffer.resize(nlist * entrySize);
+            m_IfBudget.read(m_BudgetListBuffer.data(), nlist * entrySize);
+            const char *entry = m_BudgetListBuffer.data();
+            for (i = 0; i < nlist; i++, entry += entrySize)
             {
-                m_IfBudget.read((char *)(&node), sizeof(int));
-                m_IfBudget.read((char *)(&id2), sizeof(int));
+                memcpy(&node, entry, sizeof(int));
                 mf_cell_index = node - 1;
                 if (m_GridType == GridType::MV_STRUCTURED_GRID)
                 {
@@ -1901,11 +2533,7 @@ const char *Modflow6DataSource::CountBudgetAndFeatures()
                 }
                 else
                 {
-                    num_vtk_cells_for_this_flowType += m_MfCell2VtkCells[mf_cell_index][0];
-                }
-                for (j = 0; j < nval; j++)
-                {
-                    m_IfBudget.read((char *)(&value), sizeof(double));
+                    num_vtk_cells_for_this_flowType += m_MfCell2VtkCellOffset[mf_cell_index + 1] - m_MfCell2VtkCellOffset[mf_cell_index];
                 }
             }
             length -= (2 * nlist + 2) * sizeof(int) + 16 * (nval + 3) * sizeof(char) + (nval * nlist) * sizeof(double);
@@ -1913,12 +2541,14 @@ const char *Modflow6DataSource::CountBudgetAndFeatures()
             if (strstr(flowType, "DATA-SPDIS"))
             {
                 m_HasSpecificDischargeData = 1;
+                kind                       = BudgetItemKind::SpecificDischarge;
             }
             //         else if (!strstr(flowType, "MVR") && !strstr(flowType, "UZF-GWD")
             //             &&  !strstr(flowType, "UZF-GWET") &&  !strstr(flowType, "LAK")
             //             &&  !strstr(flowType, "FLOW-JA-FACE"))
             else if (IsModelFeature(flowType))
             {
+                kind = BudgetItemKind::ModelFeature;
                 m_BudgetText->InitTraversal();
                 vtk_cell_count->InitTraversal();
                 match = 0;
@@ -1951,6 +2581,10 @@ const char *Modflow6DataSource::CountBudgetAndFeatures()
                 }
             }
         }
+        if (inFirstStep)
+        {
+            m_BudgetSchema.push_back(kind);
+        }
     }
     m_NumberOfModelFeatureTypes = m_BudgetText->GetNumberOfItems();
     m_ModelFeatureArraySize     = 0;
@@ -1981,12 +2615,6 @@ const char *Modflow6DataSource::CountBudgetAndFeatures()
     //   }
     delete vtk_cell_count;
 
-    // ********* temporary -- no vectors for DISU GRID **********
-    if (m_GridType == GridType::MV_UNSTRUCTURED_GRID)
-    {
-        m_HasSpecificDischargeData = 0;
-    }
-
     return nullptr;
 }
 
@@ -2034,48 +2662,24 @@ void Modflow6DataSource::GetTimePoints(double *timePoints, int *periods, int *st
 
 void Modflow6DataSource::SetTimePointTo(int timePointIndex)
 {
-    int    kstp, kper, n1, n2, n3, ilay, i, j, k, imeth, ivalue, nlist, nval;
-    double pertim, totim, value, delt, value1, value2, value3;
+    int    kstp, kper, n1, n2, n3, i, k, imeth, nlist, nval;
+    double pertim, totim, delt;
     char   text[16], flowType[17];
     flowType[16] = '\0';
     // if not showing the next time point, then backup to the beginning of the file and
     // move to the timePointIndex.
+    std::streamoff headStart = m_IfHead.tellg();
     if (timePointIndex != -1)
     {
-        // get to the beginning of the desired time point in the head file
-        m_IfHead.seekg(0, m_IfHead.beg);
-        for (int itp = 0; itp < timePointIndex - 1; itp++)
-        {
-            for (k = 0; k < m_NumberOfCellLayers; k++)
-            {
-                m_IfHead.read((char *)(&kstp), sizeof(int));
-                m_IfHead.read((char *)(&kper), sizeof(int));
-                m_IfHead.read((char *)(&pertim), sizeof(double));
-                m_IfHead.read((char *)(&totim), sizeof(double));
-                m_IfHead.read(text, 16 * sizeof(char));
-                m_IfHead.read((char *)(&n1), sizeof(int));
-                m_IfHead.read((char *)(&n2), sizeof(int));
-                int ncpl;
-                if (m_GridType == GridType::MV_STRUCTURED_GRID)
-                {
-                    ncpl = n1 * n2;
-                }
-                else
-                {
-                    ncpl = n1;
-                }
-                m_IfHead.read((char *)(&ilay), sizeof(int));
-                for (i = 0; i < ncpl; i++)
-                {
-                    m_IfHead.read((char *)(&value), sizeof(double));
-                }
-            }
-        }
+        m_IfHead.clear();
+        // get to the beginning of the desired time point in the head file. All time
+        // points take the same number of bytes, so its offset is computed.
+        headStart = (std::streamoff)HeadRecordOfTimePoint(timePointIndex) * HeadTimePointSize();
         // get to the beginning of the desired time point in the budget file
         if (m_IfBudget.is_open())
         {
             m_IfBudget.seekg(0, m_IfBudget.beg);
-            for (int itp = 0; itp < (timePointIndex - 1) * (m_NumberOfBudgetItems); itp++)
+            for (int itp = 0; itp < HeadRecordOfTimePoint(timePointIndex) * m_NumberOfBudgetItems; itp++)
             {
                 m_IfBudget.read((char *)(&kstp), sizeof(int));
                 m_IfBudget.read((char *)(&kper), sizeof(int));
@@ -2090,10 +2694,7 @@ void Modflow6DataSource::SetTimePointTo(int timePointIndex)
                 m_IfBudget.read((char *)(&totim), sizeof(double));
                 if (imeth == 1)
                 {
-                    for (i = 0; i < n1 * n2 * n3; i++)
-                    {
-                        m_IfBudget.read((char *)(&value), sizeof(double));
-                    }
+                    m_IfBudget.seekg((std::streamoff)n1 * n2 * n3 * sizeof(double), ios::cur);
                 }
                 else if (imeth == 6)
                 {
@@ -2107,68 +2708,234 @@ void Modflow6DataSource::SetTimePointTo(int timePointIndex)
                         m_IfBudget.read(text, 16 * sizeof(char));
                     }
                     m_IfBudget.read((char *)(&nlist), sizeof(int));
-                    for (i = 0; i < nlist; i++)
-                    {
-                        m_IfBudget.read((char *)(&ivalue), sizeof(int));
-                        m_IfBudget.read((char *)(&ivalue), sizeof(int));
-                        for (k = 0; k < nval; k++)
-                        {
-                            m_IfBudget.read((char *)(&value), sizeof(double));
-                        }
-                    }
+                    m_IfBudget.seekg((std::streamoff)nlist * (2 * sizeof(int) + nval * sizeof(double)), ios::cur);
                 }
             }
         }
     }
-    // initialize points
-    memset(m_ScalarArray, 0, m_NumberOfVTKPoints * sizeof(double));
-
     int *modflow_active_cell = new int[m_NumberOfModflowCells];
-    memset(modflow_active_cell, 0, m_NumberOfModflowCells * sizeof(int));
+    ReadHeads(headStart, modflow_active_cell);
+    m_CurrentHeadStart = headStart;
 
-    // read head
-    if (m_GridType == GridType::MV_STRUCTURED_GRID)
+    // leave the head file at the next time point, for AdvanceOneTimePoint
+    m_IfHead.seekg(headStart + (std::streamoff)HeadTimePointSize(), ios::beg);
+
+    // read budget
+    if (m_IfBudget.is_open())
     {
-        int     ncol, nrow, ncpl;
-        double *pointValues = m_ScalarArray;
-        double *cellValues  = pointValues + m_NumberOfVTKPoints;
-        for (k = 0; k < m_NumberOfCellLayers; k++)
+        int ip = 0;
+        for (int ibud = 0; ibud < m_NumberOfBudgetItems; ibud++)
         {
-            m_IfHead.read((char *)(&kstp), sizeof(int));
-            m_IfHead.read((char *)(&kper), sizeof(int));
-            m_IfHead.read((char *)(&pertim), sizeof(double));
-            m_IfHead.read((char *)(&totim), sizeof(double));
-            m_IfHead.read(text, 16 * sizeof(char));
-            m_IfHead.read((char *)(&ncol), sizeof(int));
-            m_IfHead.read((char *)(&nrow), sizeof(int));
-            ncpl = ncol * nrow;
-            m_IfHead.read((char *)(&ilay), sizeof(int));
-            for (j = 0; j < nrow; j++)
+            m_IfBudget.read((char *)(&kstp), sizeof(int));
+            m_IfBudget.read((char *)(&kper), sizeof(int));
+            m_IfBudget.read(flowType, 16 * sizeof(char));
+            m_IfBudget.read((char *)(&n1), sizeof(int));
+            m_IfBudget.read((char *)(&n2), sizeof(int));
+            m_IfBudget.read((char *)(&n3), sizeof(int));
+            n3 = -n3;
+            m_IfBudget.read((char *)(&imeth), sizeof(int));
+            m_IfBudget.read((char *)(&delt), sizeof(double));
+            m_IfBudget.read((char *)(&pertim), sizeof(double));
+            m_IfBudget.read((char *)(&totim), sizeof(double));
+            if (imeth == 1) // only used for cell-by-cell flow terms, which are not used in Model Viewer
             {
-                for (i = 0; i < ncol; i++)
-                {
-                    m_IfHead.read((char *)(&value), sizeof(double));
-                    // if the head value indicates it as a dry cell, or if the head is below
-                    // the bottom of the cell, set the value to indicate an inactive cell
-                    int ijk = k * ncpl + j * ncol + i;
-                    int jj  = (m_NumberOfCellLayers - k - 1) * ncpl + (nrow - j - 1) * ncol + i;
-                    if (PracticallyEqual(value, m_DryCellValue) || (m_Icelltype[ijk] != 0 && value < m_Elev[jj]))
-                    {
-                        value = m_InactiveCellValue;
-                    }
-                    if (!PracticallyEqual(value, m_InactiveCellValue)) modflow_active_cell[jj] = 1;
+                m_IfBudget.seekg((std::streamoff)n1 * n2 * n3 * sizeof(double), ios::cur);
+            }
+            else if (imeth == 6)
+            {
+                int node, np;
+                m_IfBudget.read(text, 16 * sizeof(char));
+                m_IfBudget.read(text, 16 * sizeof(char));
+                m_IfBudget.read(text, 16 * sizeof(char));
+                m_IfBudget.read(text, 16 * sizeof(char));
+                m_IfBudget.read((char *)(&nval), sizeof(int));
+                for (i = 0; i < nval - 1; i++)
+                {
+                    m_IfBudget.read(text, 16 * sizeof(char));
+                }
+                m_IfBudget.read((char *)(&nlist), sizeof(int));
+
+                // each list entry is node, id2 and nval values
+                size_t         entrySize = 2 * sizeof(int) + nval * sizeof(double);
+                BudgetItemKind kind      = BudgetItemKind::Ignored;
+                if (ibud < (int)m_BudgetSchema.size())
+                {
+                    kind = m_BudgetSchema[ibud];
+                }
+                if (kind == BudgetItemKind::SpecificDischarge && nval < 4)
+                {
+                    kind = BudgetItemKind::Ignored;
+                }
+                if (kind == BudgetItemKind::Ignored)
+                {
+                    m_IfBudget.seekg((std::streamoff)nlist * entrySize, ios::cur);
+                    continue;
+                }
+                m_BudgetListBuffer.resize(nlist * entrySize);
+                m_IfBudget.read(m_BudgetListBuffer.data(), nlist * entrySize);
+                const char *entry = m_BudgetListBuffer.data();
+
+                if (kind == BudgetItemKind::ModelFeature)
+                {
+                    np                      = ip;
+                    assert(0 <= np && np < m_ModelFeatureArraySize);
+                    m_ModelFeatureArray[np] = 0; // this element holds the number of vtkcells associated with the feature
+                    ip++;
+                    for (i = 0; i < nlist; i++, entry += entrySize)
+                    {
+                        memcpy(&node, entry, sizeof(int));
+                        if (m_GridType == GridType::MV_STRUCTURED_GRID)
+                        {
+                            assert(0 <= ip && ip < m_ModelFeatureArraySize);
+                            m_ModelFeatureArray[ip] = StructuredNodeToVtkCell(node);
+                            ip++;
+                            m_ModelFeatureArray[np]++;
+                        }
+                        else
+                        {
+                            int mf_cell_index = node - 1;
+                            for (k = m_MfCell2VtkCellOffset[mf_cell_index]; k < m_MfCell2VtkCellOffset[mf_cell_index + 1]; k++)
+                            {
+                                assert(0 <= ip && ip < m_ModelFeatureArraySize);
+                                m_ModelFeatureArray[ip] = k;
+                                ip++;
+                                m_ModelFeatureArray[np]++;
+                            }
+                        }
+                    }
+                }
+                else if (kind == BudgetItemKind::SpecificDischarge)
+                {
+                    DecodeSpecificDischarge(entry, nlist, entrySize, modflow_active_cell);
+                }
+            }
+        } // end block to read each budget item
+    }     // end block to read from m_IfBudget
+    delete[] modflow_active_cell;
+}
+
+// Sets m_VectorArray from the nlist entries of a DATA-SPDIS budget item, each
+// entrySize bytes long. Cells that are not listed or not active are set to the
+// inactive value.
+void Modflow6DataSource::DecodeSpecificDischarge(const char *entry, int nlist, size_t entrySize, const int *modflow_active_cell)
+{
+    std::fill(m_VectorArray, m_VectorArray + 3 * (size_t)m_NumberOfModflowCells, m_InactiveCellValue);
+    // Each entry is node, id2, q, qx, qy and qz. In DISV and DISU grids the
+    // vector of node n is at n - 1, so only DIS nodes need to be converted.
+    const size_t valueOffset = 2 * sizeof(int) + sizeof(double);
+    int          node;
+    if (m_GridType == GridType::MV_STRUCTURED_GRID)
+    {
+        for (int i = 0; i < nlist; i++, entry += entrySize)
+        {
+            memcpy(&node, entry, sizeof(int));
+            int ivtk = StructuredNodeToVtkCell(node);
+            if (modflow_active_cell[ivtk])
+            {
+                memcpy(m_VectorArray + 3 * (size_t)ivtk, entry + valueOffset, 3 * sizeof(double));
+            }
+        }
+    }
+    else
+    {
+        for (int i = 0; i < nlist; i++, entry += entrySize)
+        {
+            memcpy(&node, entry, sizeof(int));
+            int ivtk = node - 1;
+            if (0 <= ivtk && ivtk < m_NumberOfModflowCells && modflow_active_cell[ivtk])
+            {
+                memcpy(m_VectorArray + 3 * (size_t)ivtk, entry + valueOffset, 3 * sizeof(double));
+            }
+        }
+    }
+}
+
+// Reads the heads of the time point at headStart in the head file, computes the
+// active scalar data type from them and interpolates it to the points. Sets
+// modflow_active_cell to 1 for the cells with a value.
+void Modflow6DataSource::ReadHeads(std::streamoff headStart, int *modflow_active_cell)
+{
+    int    kstp, kper, n1, n2, ilay, i, j, k;
+    double pertim, totim, value;
+    char   text[16];
+
+    // initialize points
+    memset(m_ScalarArray, 0, m_NumberOfVTKPoints * sizeof(double));
+
+    memset(modflow_active_cell, 0, m_NumberOfModflowCells * sizeof(int));
+
+    // read head. Only the layer records, and in DIS grids the rows, that hold
+    // the cells around the subgrid are read.
+    int            range[6];
+    size_t         recordSize = HeadRecordSize();
+    GetSubgridCellRange(range);
+    if (m_GridType == GridType::MV_STRUCTURED_GRID)
+    {
+        int     ncol        = m_NumberOfCellColumns;
+        int     nrow        = m_NumberOfCellRows;
+        int     ncpl        = ncol * nrow;
+        // rows are numbered from the north in the head file
+        int     j0          = nrow - range[3];
+        int     j1          = nrow - range[2];
+        double *pointValues = m_ScalarArray;
+        double *cellValues  = pointValues + m_NumberOfVTKPoints;
+        int    *useLayer    = 0;
+        if (m_SubgridActive)
+        {
+            useLayer = new int[m_NumberOfCellLayers];
+        }
+        for (k = 0; k < m_NumberOfCellLayers; k++)
+        {
+            int kc        = m_NumberOfCellLayers - k - 1;
+            int readLayer = (range[4] <= kc && kc < range[5]);
+            if (useLayer)
+            {
+                useLayer[kc] = readLayer;
+            }
+            if (readLayer)
+            {
+                m_IfHead.seekg(headStart + (std::streamoff)k * recordSize, ios::beg);
+                m_IfHead.read((char *)(&kstp), sizeof(int));
+                m_IfHead.read((char *)(&kper), sizeof(int));
+                m_IfHead.read((char *)(&pertim), sizeof(double));
+                m_IfHead.read((char *)(&totim), sizeof(double));
+                m_IfHead.read(text, 16 * sizeof(char));
+                m_IfHead.read((char *)(&n1), sizeof(int));
+                m_IfHead.read((char *)(&n2), sizeof(int));
+                m_IfHead.read((char *)(&ilay), sizeof(int));
+                m_HeadBuffer.resize((size_t)(j1 - j0) * ncol);
+                m_IfHead.seekg((std::streamoff)j0 * ncol * sizeof(double), ios::cur);
+                m_IfHead.read((char *)m_HeadBuffer.data(), m_HeadBuffer.size() * sizeof(double));
+                ComputeScalarValues(headStart, k, j0 * ncol, (int)m_HeadBuffer.size());
+            }
+            for (j = 0; j < nrow; j++)
+            {
+                for (i = 0; i < ncol; i++)
+                {
+                    int jj  = kc * ncpl + (nrow - j - 1) * ncol + i;
+                    if (!readLayer || j < j0 || j >= j1 || i < range[0] || i >= range[1])
+                    {
+                        cellValues[jj] = m_InactiveCellValue;
+                        continue;
+                    }
+                    value = m_HeadBuffer[(size_t)(j - j0) * ncol + i];
+                    if (!PracticallyEqual(value, m_InactiveCellValue)) modflow_active_cell[jj] = 1;
                     cellValues[jj] = value;
                 }
             }
         }
-        double znull    = -1.0e20;
-        int   *useLayer = 0;
+        double znull = -1.0e20;
         mvUtil::interp3d(cellValues, pointValues, m_Delr, m_Delc_revdir, m_Elev,
                          ncol, nrow, m_NumberOfCellLayers, m_InactiveCellValue, znull, useLayer);
+        if (useLayer)
+        {
+            delete[] useLayer;
+        }
     }
     else if (m_GridType == GridType::MV_LAYERED_GRID)
     {
-        int     p, q, ncpl;
+        int     p, q;
+        int     ncpl         = m_Ncpl;
         double  dx, dy, dz;
         double  weight;
         int     m            = 0;
@@ -2178,23 +2945,33 @@ void Modflow6DataSource::SetTimePointTo(int timePointIndex)
         memset(sumOfWeights, 0, m_NumberOfVTKPoints * sizeof(double));
         for (k = 0; k < m_NumberOfCellLayers; k++)
         {
+            if (k < range[4] || k >= range[5])
+            {
+                for (q = k * ncpl; q < (k + 1) * ncpl; q++)
+                {
+                    for (m = m_MfCell2VtkCellOffset[q]; m < m_MfCell2VtkCellOffset[q + 1]; m++)
+                    {
+                        m_ScalarArray[m_NumberOfVTKPoints + m] = m_InactiveCellValue;
+                    }
+                }
+                continue;
+            }
+            m_IfHead.seekg(headStart + (std::streamoff)k * recordSize, ios::beg);
             m_IfHead.read((char *)(&kstp), sizeof(int));
             m_IfHead.read((char *)(&kper), sizeof(int));
             m_IfHead.read((char *)(&pertim), sizeof(double));
             m_IfHead.read((char *)(&totim), sizeof(double));
             m_IfHead.read(text, 16 * sizeof(char));
-            m_IfHead.read((char *)(&ncpl), sizeof(int));
+            m_IfHead.read((char *)(&n1), sizeof(int));
             m_IfHead.read((char *)(&n2), sizeof(int));
             m_IfHead.read((char *)(&ilay), sizeof(int));
+            m_HeadBuffer.resize(ncpl);
+            m_IfHead.read((char *)m_HeadBuffer.data(), ncpl * sizeof(double));
+            ComputeScalarValues(headStart, k, 0, ncpl);
             for (i = 0; i < ncpl; i++)
             {
-                m_IfHead.read((char *)(&value), sizeof(double));
-                // if the head value indicates it as a dry cell, set the value to indicate an inactive cell
-                q = (k * ncpl + i); // q is the index of the cell3d
-                if (PracticallyEqual(value, m_DryCellValue) || (m_Icelltype[q] != 0 && value < m_Elev[q + ncpl]))
-                {
-                    value = m_InactiveCellValue;
-                }
+                value = m_HeadBuffer[i];
+                q     = (k * ncpl + i); // q is the index of the cell3d
 
                 if (!PracticallyEqual(value, m_InactiveCellValue))
                 {
@@ -2230,35 +3007,9 @@ void Modflow6DataSource::SetTimePointTo(int timePointIndex)
                     sumOfWeights[p] += weight;
                 }
                 // vtkcell value
-                if (m_Idomain[k * ncpl + i] > 0)
+                for (m = m_MfCell2VtkCellOffset[q]; m < m_MfCell2VtkCellOffset[q + 1]; m++)
                 {
-                    if (m_NumCell2dVert[i] >= 3 && m_NumCell2dVert[i] <= 6)
-                    {
-                        if (!PracticallyEqual(value, m_DryCellValue))
-                        {
-                            m_ScalarArray[m_NumberOfVTKPoints + m] = value;
-                        }
-                        else
-                        {
-                            m_ScalarArray[m_NumberOfVTKPoints + m] = m_InactiveCellValue;
-                        }
-                        m++;
-                    }
-                    else if (m_NumCell2dVert[i] > 6)
-                    {
-                        for (j = 0; j < m_NumCell2dVert[i]; j++)
-                        {
-                            if (!PracticallyEqual(value, m_DryCellValue))
-                            {
-                                m_ScalarArray[m_NumberOfVTKPoints + m] = value;
-                            }
-                            else
-                            {
-                                m_ScalarArray[m_NumberOfVTKPoints + m] = m_InactiveCellValue;
-                            }
-                            m++;
-                        }
-                    }
+                    m_ScalarArray[m_NumberOfVTKPoints + m] = value;
                 }
             }
         }
@@ -2273,8 +3024,8 @@ void Modflow6DataSource::SetTimePointTo(int timePointIndex)
     }
     else if (m_GridType == GridType::MV_UNSTRUCTURED_GRID)
     {
-        int nodes, n1, n2;
-        memset(m_ScalarArray, 0, m_NumberOfVTKPoints * sizeof(double));
+        int nodes;
+        m_IfHead.seekg(headStart, ios::beg);
         m_IfHead.read((char *)(&kstp), sizeof(int));
         m_IfHead.read((char *)(&kper), sizeof(int));
         m_IfHead.read((char *)(&pertim), sizeof(double));
@@ -2283,188 +3034,214 @@ void Modflow6DataSource::SetTimePointTo(int timePointIndex)
         m_IfHead.read((char *)(&nodes), sizeof(int));
         m_IfHead.read((char *)(&n1), sizeof(int));
         m_IfHead.read((char *)(&n2), sizeof(int));
-        int m = 0;
+        m_HeadBuffer.resize(nodes);
+        m_IfHead.read((char *)m_HeadBuffer.data(), nodes * sizeof(double));
+        ComputeScalarValues(headStart, 0, 0, nodes);
         for (i = 0; i < nodes; i++)
         {
-            m_IfHead.read((char *)(&value), sizeof(double));
-            if (m_NumCell2dVert[i] >= 3 && m_NumCell2dVert[i] <= 6)
+            value = m_HeadBuffer[i];
+            if (!PracticallyEqual(value, m_InactiveCellValue)) modflow_active_cell[i] = 1;
+            for (int m = m_MfCell2VtkCellOffset[i]; m < m_MfCell2VtkCellOffset[i + 1]; m++)
             {
-                if (!PracticallyEqual(value, m_DryCellValue))
-                {
-                    m_ScalarArray[m_NumberOfVTKPoints + m] = value;
-                }
-                else
-                {
-                    m_ScalarArray[m_NumberOfVTKPoints + m] = m_InactiveCellValue;
-                }
-                m++;
+                m_ScalarArray[m_NumberOfVTKPoints + m] = value;
             }
-            else if (m_NumCell2dVert[i] > 6)
+        }
+
+        // Each point value depends only on the cell values, so the points
+        // are divided among several threads
+        const int minPointsPerThread = 65536;
+        int       numThreads         = std::max(1, (int)std::thread::hardware_concurrency());
+        numThreads                   = std::max(1, std::min(numThreads, m_NumberOfVTKPoints / minPointsPerThread));
+        if (numThreads == 1)
+        {
+            InterpolateDisuPoints(modflow_active_cell, 0, m_NumberOfVTKPoints);
+        }
+        else
+        {
+            std::vector<std::future<void>> parts;
+            for (i = 0; i < numThreads; i++)
             {
-                for (j = 0; j < m_NumCell2dVert[i]; j++)
-                {
-                    if (!PracticallyEqual(value, m_DryCellValue))
-                    {
-                        m_ScalarArray[m_NumberOfVTKPoints + m] = value;
-                    }
-                    else
-                    {
-                        m_ScalarArray[m_NumberOfVTKPoints + m] = m_InactiveCellValue;
-                    }
-                    m++;
-                }
+                int p0 = (int)((long long)m_NumberOfVTKPoints * i / numThreads);
+                int p1 = (int)((long long)m_NumberOfVTKPoints * (i + 1) / numThreads);
+                parts.push_back(std::async(std::launch::async, &Modflow6DataSource::InterpolateDisuPoints, this,
+                                           (const int *)modflow_active_cell, p0, p1));
+            }
+            for (auto &part : parts)
+            {
+                part.get();
             }
         }
     }
-    // read budget
-    if (m_IfBudget.is_open())
+}
+
+// Sets the values of vtkpoints first through last - 1 of a DISU grid to the
+// inverse distance weighted average of the values of the active cells around
+// them. Points with no active cell are set to zero.
+void Modflow6DataSource::InterpolateDisuPoints(const int *modflow_active_cell, int first, int last)
+{
+    const double *values = m_HeadBuffer.data();
+    for (int p = first; p < last; p++)
     {
-        int ip = 0;
-        for (int ibud = 0; ibud < m_NumberOfBudgetItems; ibud++)
+        double sum          = 0;
+        double sumOfWeights = 0;
+        for (int k = m_PointCellOffset[p]; k < m_PointCellOffset[p + 1]; k++)
         {
-            m_IfBudget.read((char *)(&kstp), sizeof(int));
-            m_IfBudget.read((char *)(&kper), sizeof(int));
-            m_IfBudget.read(flowType, 16 * sizeof(char));
-            m_IfBudget.read((char *)(&n1), sizeof(int));
-            m_IfBudget.read((char *)(&n2), sizeof(int));
-            m_IfBudget.read((char *)(&n3), sizeof(int));
-            n3 = -n3;
-            m_IfBudget.read((char *)(&imeth), sizeof(int));
-            m_IfBudget.read((char *)(&delt), sizeof(double));
-            m_IfBudget.read((char *)(&pertim), sizeof(double));
-            m_IfBudget.read((char *)(&totim), sizeof(double));
-            if (imeth == 1) // only used for cell-by-cell flow terms, which are not used in Model Viewer
+            int cell = m_PointCell[k];
+            if (modflow_active_cell[cell])
             {
-                for (i = 0; i < n1 * n2 * n3; i++)
-                {
-                    m_IfBudget.read((char *)(&value), sizeof(double));
-                }
+                sum += m_PointCellWeight[k] * values[cell];
+                sumOfWeights += m_PointCellWeight[k];
             }
-            else if (imeth == 6)
-            {
-                int mf_cell_index;
-                int node, id2, np;
-                //            int modelFeature = (!strstr(flowType, "MVR") && !strstr(flowType, "UZF-GWD")
-                //                   &&  !strstr(flowType, "UZF-GWET") &&  !strstr(flowType, "LAK")
-                //                   &&  !strstr(flowType, "FLOW-JA-FACE") && !strstr(flowType, "DATA-SPDIS"));
+        }
+        m_ScalarArray[p] = (sumOfWeights > 0) ? sum / sumOfWeights : 0;
+    }
+}
 
-                m_IfBudget.read(text, 16 * sizeof(char));
-                m_IfBudget.read(text, 16 * sizeof(char));
-                m_IfBudget.read(text, 16 * sizeof(char));
-                m_IfBudget.read(text, 16 * sizeof(char));
-                m_IfBudget.read((char *)(&nval), sizeof(int));
-                for (i = 0; i < nval - 1; i++)
-                {
-                    m_IfBudget.read(text, 16 * sizeof(char));
-                }
-                m_IfBudget.read((char *)(&nlist), sizeof(int));
-                if (IsModelFeature(flowType))
-                {
-                    np                      = ip;
-                    assert(0 <= np && np < m_ModelFeatureArraySize);
-                    m_ModelFeatureArray[np] = 0; // this element holds the number of vtkcells associated with the feature
-                    ip++;
-                }
-                if (strstr(flowType, "DATA-SPDIS") && m_HasSpecificDischargeData /* need to temporarily eliminate DISU grid */)
-                {
-                    for (i = 0; i < 3 * m_NumberOfModflowCells; i++)
-                    {
-                        m_VectorArray[i] = m_InactiveCellValue;
-                    }
-                }
-                for (i = 0; i < nlist; i++)
-                {
-                    m_IfBudget.read((char *)(&node), sizeof(int));
-                    m_IfBudget.read((char *)(&id2), sizeof(int));
+// Sets each value to other - value, the drawdown, or to the inactive value
+// where either is inactive. There are no branches, so the loop vectorizes.
+static void ComputeDrawdown(double *values, const double *other, int count, double inactive)
+{
+    for (int n = 0; n < count; n++)
+    {
+        double drawdown = other[n] - values[n];
+        bool   skip     = (values[n] == inactive) | (other[n] == inactive);
+        values[n]       = skip ? inactive : drawdown;
+    }
+}
 
-                    if (IsModelFeature(flowType))
-                    {
-                        if (m_GridType == GridType::MV_STRUCTURED_GRID)
-                        {
-                            // find the Modflow col, row, and layer for this node
-                            int nm1                 = node - 1;
-                            int ncpl                = m_NumberOfCellColumns * m_NumberOfCellRows;
-                            int layer               = (nm1) / ncpl + 1;
-                            int row                 = (nm1 % ncpl) / m_NumberOfCellColumns + 1;
-                            int col                 = ((nm1 % ncpl) % m_NumberOfCellColumns) + 1;
-                            // find the VTK index for this node
-                            assert(0 <= ip && ip < m_ModelFeatureArraySize);
-                            m_ModelFeatureArray[ip] = (m_NumberOfCellLayers - layer) * ncpl + (m_NumberOfCellRows - row) * m_NumberOfCellColumns + col - 1;
-                            assert(0 <= np && np < m_ModelFeatureArraySize);
-                            m_ModelFeatureArray[np]++;
-                            ip++;
-                        }
-                        else
-                        {
-                            mf_cell_index = node - 1;
-                            for (k = 1; k <= m_MfCell2VtkCells[mf_cell_index][0]; k++)
-                            {
-                                assert(0 <= ip && ip < m_ModelFeatureArraySize);
-                                m_ModelFeatureArray[ip] = m_MfCell2VtkCells[mf_cell_index][k];
-                                assert(0 <= np && np < m_ModelFeatureArraySize);
-                                m_ModelFeatureArray[np]++;
-                                ip++;
-                            }
-                        }
-                    }
-                    if (strstr(flowType, "DATA-SPDIS"))
-                    {
-                        m_IfBudget.read((char *)(&value), sizeof(double));
-                        m_IfBudget.read((char *)(&value1), sizeof(double));
-                        m_IfBudget.read((char *)(&value2), sizeof(double));
-                        m_IfBudget.read((char *)(&value3), sizeof(double));
-                        if (m_GridType == GridType::MV_STRUCTURED_GRID)
-                        {
-                            // find the Modflow col, row, and layer for this node
-                            int nm1   = node - 1;
-                            int ncpl  = m_NumberOfCellColumns * m_NumberOfCellRows;
-                            int layer = (nm1) / ncpl + 1;
-                            int row   = (nm1 % ncpl) / m_NumberOfCellColumns + 1;
-                            int col   = ((nm1 % ncpl) % m_NumberOfCellColumns) + 1;
-                            // find the vtk index for this node
-                            int ivtk  = (m_NumberOfCellLayers - layer) * ncpl + (m_NumberOfCellRows - row) * m_NumberOfCellColumns + col - 1;
-                            if (modflow_active_cell[ivtk])
-                            {
-                                m_VectorArray[3 * ivtk]     = value1;
-                                m_VectorArray[3 * ivtk + 1] = value2;
-                                m_VectorArray[3 * ivtk + 2] = value3;
-                            }
-                            else
-                            {
-                                m_VectorArray[3 * ivtk]     = m_InactiveCellValue;
-                                m_VectorArray[3 * ivtk + 1] = m_InactiveCellValue;
-                                m_VectorArray[3 * ivtk + 2] = m_InactiveCellValue;
-                            }
-                        }
-                        else if (m_GridType == GridType::MV_LAYERED_GRID /* || m_GridType == GridType::MV_UNSTRUCTURED_GRID */)
-                        {
-                            int nm1 = node - 1;
-                            if (modflow_active_cell[nm1])
-                            {
-                                m_VectorArray[3 * nm1]     = value1;
-                                m_VectorArray[3 * nm1 + 1] = value2;
-                                m_VectorArray[3 * nm1 + 2] = value3;
-                            }
-                            else
-                            {
-                                m_VectorArray[3 * nm1]     = m_InactiveCellValue;
-                                m_VectorArray[3 * nm1 + 1] = m_InactiveCellValue;
-                                m_VectorArray[3 * nm1 + 2] = m_InactiveCellValue;
-                            }
-                        }
-                    }
-                    else // if not specific discharge, just read DATA2D and ignore.
-                    {
-                        for (k = 0; k < nval; k++)
-                        {
-                            m_IfBudget.read((char *)(&value), sizeof(double));
-                        }
-                    }
-                }
+// Turns count head values in m_HeadBuffer, read from layer record k (counted
+// from the top) of the time point at headStart from index first on, into
+// values of the active scalar data type
+void Modflow6DataSource::ComputeScalarValues(std::streamoff headStart, int k, int first, int count)
+{
+    double *values = m_HeadBuffer.data();
+    CheckHeadValues(k, first, values, count);
+    if (m_ScalarDataType == ScalarDataType::Head)
+    {
+        return;
+    }
+
+    int            recordLength  = (m_GridType == GridType::MV_UNSTRUCTURED_GRID) ? m_NumberOfModflowCells : m_Ncpl;
+    std::streamoff timePointSize = HeadTimePointSize();
+    std::streamoff recordSize    = HeadRecordSize();
+    const double  *other;
+    if (m_ScalarDataType == ScalarDataType::Drawdown)
+    {
+        if (m_ReferenceHead.empty())
+        {
+            int numRecords = (m_GridType == GridType::MV_UNSTRUCTURED_GRID) ? 1 : m_NumberOfCellLayers;
+            m_ReferenceHead.resize((size_t)numRecords * recordLength);
+            for (int kr = 0; kr < numRecords; kr++)
+            {
+                double *reference = &m_ReferenceHead[(size_t)kr * recordLength];
+                m_IfHead.seekg(HeadRecordOfTimePoint(m_ReferenceTimePoint) * timePointSize + kr * recordSize + HeadHeaderSize, ios::beg);
+                m_IfHead.read((char *)reference, recordLength * sizeof(double));
+                CheckHeadValues(kr, 0, reference, recordLength);
             }
-        } // end block to read each budget item
-    }     // end block to read from m_IfBudget
-    delete[] modflow_active_cell;
+        }
+        other = &m_ReferenceHead[(size_t)k * recordLength + first];
+    }
+    else
+    {
+        // the same time point of the comparison run. Time points the
+        // comparison run does not have are left inactive.
+        m_OtherHeadBuffer.resize(count);
+        if (headStart / timePointSize < m_NumberOfComparisonTimePoints)
+        {
+            m_IfComparisonHead.clear();
+            m_IfComparisonHead.seekg(headStart + k * recordSize + HeadHeaderSize + (std::streamoff)first * sizeof(double), ios::beg);
+            m_IfComparisonHead.read((char *)m_OtherHeadBuffer.data(), count * sizeof(double));
+            CheckHeadValues(k, first, m_OtherHeadBuffer.data(), count);
+        }
+        else
+        {
+            std::fill(m_OtherHeadBuffer.begin(), m_OtherHeadBuffer.end(), m_InactiveCellValue);
+        }
+        other = m_OtherHeadBuffer.data();
+    }
+    ComputeDrawdown(values, other, count, m_InactiveCellValue);
+}
+
+// Applies CheckHeadValue to count values of layer record k (counted from the
+// top), from index first in the record on
+void Modflow6DataSource::CheckHeadValues(int k, int first, double *values, int count)
+{
+    if (m_GridType == GridType::MV_STRUCTURED_GRID)
+    {
+        int ncol = m_NumberOfCellColumns;
+        int nrow = m_NumberOfCellRows;
+        int ncpl = ncol * nrow;
+        int kc   = m_NumberOfCellLayers - k - 1;
+        for (int n = 0; n < count; n++)
+        {
+            int r     = first + n;
+            int j     = r / ncol;
+            int i     = r % ncol;
+            values[n] = CheckHeadValue(kc * ncpl + (nrow - j - 1) * ncol + i, k * ncpl + r, values[n]);
+        }
+    }
+    else
+    {
+        int offset = (m_GridType == GridType::MV_LAYERED_GRID) ? k * m_Ncpl : 0;
+        for (int n = 0; n < count; n++)
+        {
+            values[n] = CheckHeadValue(-1, offset + first + n, values[n]);
+        }
+    }
+}
+
+// Counts the time points in the comparison head file, and checks that its
+// records have the dimensions of those in the head file
+const char *Modflow6DataSource::CountComparisonHead()
+{
+    int            dim[2], comparisonDim[2];
+    std::streamoff dimOffset = 2 * sizeof(int) + 2 * sizeof(double) + 16 * sizeof(char);
+    m_IfHead.clear();
+    m_IfHead.seekg(dimOffset, ios::beg);
+    m_IfHead.read((char *)dim, 2 * sizeof(int));
+    m_IfComparisonHead.seekg(dimOffset, ios::beg);
+    m_IfComparisonHead.read((char *)comparisonDim, 2 * sizeof(int));
+    m_IfComparisonHead.seekg(0, ios::end);
+    std::streamoff length = m_IfComparisonHead.tellg();
+    if (m_IfHead.fail() || m_IfComparisonHead.fail() || dim[0] != comparisonDim[0] || dim[1] != comparisonDim[1])
+    {
+        return "Error: The comparison head file does not match the grid of the model.";
+    }
+    m_NumberOfComparisonTimePoints = (int)(length / (std::streamoff)HeadTimePointSize());
+    return nullptr;
+}
+
+void Modflow6DataSource::SetScalarDataTypeTo(int dataTypeIndex)
+{
+    if (dataTypeIndex < 0 || dataTypeIndex >= m_NumberOfScalarDataTypes ||
+        (ScalarDataType)dataTypeIndex == m_ScalarDataType)
+    {
+        return;
+    }
+    m_ScalarDataType = (ScalarDataType)dataTypeIndex;
+
+    // Recompute the scalars of the current time point. The vectors and
+    // model features do not depend on the data type.
+    if (m_CurrentHeadStart >= 0)
+    {
+        int *modflow_active_cell = new int[m_NumberOfModflowCells];
+        m_IfHead.clear();
+        ReadHeads(m_CurrentHeadStart, modflow_active_cell);
+        m_IfHead.seekg(m_CurrentHeadStart + (std::streamoff)HeadTimePointSize(), ios::beg);
+        delete[] modflow_active_cell;
+    }
+}
+
+int Modflow6DataSource::SetReferenceTimePoint(int timePointIndex)
+{
+    timePointIndex = std::max(0, std::min(timePointIndex, m_NumberOfTimePoints - 1));
+    if (timePointIndex == m_ReferenceTimePoint)
+    {
+        return 0;
+    }
+    m_ReferenceTimePoint = timePointIndex;
+    m_ReferenceHead.clear();
+    return m_ScalarDataType == ScalarDataType::Drawdown;
 }
 
 int Modflow6DataSource::PracticallyEqual(double value1, double value2)
@@ -2492,6 +3269,80 @@ int Modflow6DataSource::GetNumberOfVTKCellsInLayer(int k)
     return 0;
 }
 
+// The top of a DISV grid is the top of the highest active cell in each
+// column, on the interpolated grid, so each cell2d is a fan of triangles
+// around its center. The top of a DISU grid is the flat top of every cell.
+int Modflow6DataSource::GetTopSurface(std::vector<double> &points, std::vector<int> &polygons)
+{
+    points.clear();
+    polygons.clear();
+    if (m_GridType == GridType::MV_LAYERED_GRID && m_InterpolatedGridCoordinates)
+    {
+        // index in points of each interpolated grid point used, or -1
+        std::vector<int> used(m_NumberOfVTKPoints, -1);
+        auto             addPoint = [&](int p) {
+            if (used[p] < 0)
+            {
+                used[p] = (int)(points.size() / 3);
+                points.insert(points.end(), m_InterpolatedGridCoordinates + 3 * (size_t)p,
+                              m_InterpolatedGridCoordinates + 3 * (size_t)p + 3);
+            }
+            return used[p];
+        };
+        int nodeStart = (m_NumberOfCellLayers + 1) * m_Nvert;
+        for (int i = 0; i < m_Ncpl; i++)
+        {
+            int k = 0;
+            while (k < m_NumberOfCellLayers && m_Idomain[k * m_Ncpl + i] <= 0)
+            {
+                k++;
+            }
+            if (k == m_NumberOfCellLayers)
+            {
+                continue;
+            }
+            int center = addPoint(nodeStart + k * m_Ncpl + i);
+            int nv     = m_NumCell2dVert[i];
+            for (int j = 0; j < nv; j++)
+            {
+                polygons.push_back(3);
+                polygons.push_back(center);
+                polygons.push_back(addPoint(k * m_Nvert + m_Javert[m_Iavert[i] + j]));
+                polygons.push_back(addPoint(k * m_Nvert + m_Javert[m_Iavert[i] + (j + 1) % nv]));
+            }
+        }
+    }
+    else if (m_GridType == GridType::MV_UNSTRUCTURED_GRID && m_Vertices && m_Top)
+    {
+        for (int i = 0; i < m_NumberOfModflowCells; i++)
+        {
+            int nv = m_NumCell2dVert[i];
+            polygons.push_back(nv);
+            for (int j = 0; j < nv; j++)
+            {
+                int v = m_Javert[m_Iavert[i] + j];
+                polygons.push_back((int)(points.size() / 3));
+                points.push_back(m_Vertices[2 * v]);
+                points.push_back(m_Vertices[2 * v + 1]);
+                points.push_back(m_Top[i]);
+            }
+        }
+    }
+    return polygons.size() > 0;
+}
+
+// Returns the index of the vtkcell for a (one-based) node of a DIS grid. VTK layers
+// are counted from the bottom upward, and rows from south to north.
+int Modflow6DataSource::StructuredNodeToVtkCell(int node)
+{
+    int nm1   = node - 1;
+    int ncpl  = m_NumberOfCellColumns * m_NumberOfCellRows;
+    int layer = nm1 / ncpl;
+    int row   = (nm1 % ncpl) / m_NumberOfCellColumns;
+    int col   = (nm1 % ncpl) % m_NumberOfCellColumns;
+    return (m_NumberOfCellLayers - layer - 1) * ncpl + (m_NumberOfCellRows - row - 1) * m_NumberOfCellColumns + col;
+}
+
 int Modflow6DataSource::IsModelFeature(char *flowType)
 {
     return (!strstr(flowType, "MVR") &&
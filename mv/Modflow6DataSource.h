@@ -5,6 +5,9 @@
 #include "mvModelFeatures.h"
 #include "mvLinkList.h"
 #include "mvDefine.h"
+#include "mvInputFileStream.h"
+
+#include <vector>
 
 class MV_EXPORT Modflow6DataSource : public mvDataSource
 {
@@ -20,9 +23,16 @@ public:
     const char *LoadData(char *dataFileList) override;
     void        AdvanceOneTimePoint() override { SetTimePointTo(-1); }
     void        SetTimePointTo(int timePointIndex) override;
-    void        SetScalarDataTypeTo(int dataTypeIndex) override { /* Not used */ }
+    void        SetScalarDataTypeTo(int dataTypeIndex) override;
+    int         SetReferenceTimePoint(int timePointIndex) override;
+    int         GetReferenceTimePoint() override { return m_ReferenceTimePoint; }
+    int         SetScalarSubgrid(int active, const int *extent) override;
+    int         GetTimeSeries(int numCells, const int *cells, double *values) override;
+    std::string GetCellDescription(int cell) override;
     int  GetModelFeatureDisplayMode() override { return MV_DISPLAY_MODEL_FEATURES_AS_CELLS; }
     void GetDefaultModelFeatureColor(int i, double *rgba) override;
+    int  UpdateTimePoints() override;
+    const double *GetTimePoints() override { return m_TimePoints.data(); }
 
     int  GetNumVTKPoints() override;
     int  GetNumVTKCells() override;
@@ -39,6 +49,10 @@ public:
     int *GetStairsteppedGridConnectivity() override { return m_StairsteppedGridConnectivity; }
     int *GetLayerConnectivity() override { return m_LayerConnectivity; }
     int  GetStairsteppedGridCoordinatesSize() override { return 3 * m_NumberOfVTKPointsForStairsteppedGrid; }
+    int  GetTopSurface(std::vector<double> &points, std::vector<int> &polygons) override;
+    // The interpolated coordinates of DISV grids are used to interpolate heads
+    int  CanReleaseInterpolatedGridCoordinates() override { return m_GridType == GridType::MV_STRUCTURED_GRID; }
+    int  CanReleaseStairsteppedGridCoordinates() override { return 1; }
 
 protected:
     int           m_NumberOfVTKPoints;
@@ -50,8 +64,11 @@ protected:
     int           m_ModelFeatureArraySize;
     GridType      m_GridType;
     int           m_HasSpecificDischargeData;
-    std::ifstream m_IfHead;
-    std::ifstream m_IfBudget;
+    // The head and budget files may be gzip-compressed
+    mvInputFileStream m_IfHead;
+    // The absolute path of the head file, which GetTimeSeries reopens
+    std::string   m_HeadFileName;
+    mvInputFileStream m_IfBudget;
     int *         m_Icelltype;
     int *         m_Idomain;
     int *         m_Iavert;
@@ -63,7 +80,9 @@ protected:
     int           m_Nvert;
     int           m_Ncpl;
     int           m_NumberOfBudgetItems;
-    int **        m_MfCell2VtkCells;
+    // The vtkcells of Modflow cell i are numbered m_MfCell2VtkCellOffset[i]
+    // through m_MfCell2VtkCellOffset[i + 1] - 1. Inactive cells have none.
+    int *         m_MfCell2VtkCellOffset;
     int *         m_ConnectivityArray;
     int *         m_LayerConnectivity;
     int *         m_StairsteppedGridConnectivity;
@@ -79,11 +98,66 @@ protected:
     double *      m_Delr;
     double *      m_Delc_revdir;
     double *      m_Elev;
+    // x and y of the cell2d vertices, and the top of each cell, of DISU grids
+    double *      m_Vertices;
+    double *      m_Top;
+    // Cell-to-point interpolation of DISU grids. The cells around vtkpoint p
+    // are m_PointCell[m_PointCellOffset[p]] through
+    // m_PointCell[m_PointCellOffset[p + 1] - 1], and m_PointCellWeight holds
+    // the inverse distance from the point to the center of each cell.
+    int *         m_PointCellOffset;
+    int *         m_PointCell;
+    double *      m_PointCellWeight;
 
     double        m_xorigin;
     double        m_yorigin;
     double        m_angrot;
 
+    // How the list of each budget item in a time step is decoded. The items are
+    // classified once, in CountBudgetAndFeatures, in the order they appear in
+    // each time step.
+    enum class BudgetItemKind
+    {
+        Ignored,
+        ModelFeature,
+        SpecificDischarge
+    };
+    std::vector<BudgetItemKind> m_BudgetSchema;
+    std::vector<char>           m_BudgetListBuffer;
+
+    // Offsets in the head and budget files of the end of the last time point
+    // counted. The budget offset is -1 until it has been found.
+    std::streamoff              m_HeadScanEnd;
+    std::streamoff              m_BudgetScanEnd;
+
+    // The subgrid to which head reads are restricted, and a buffer
+    // for the head values of one layer
+    int                         m_SubgridActive;
+    int                         m_SubgridExtent[6];
+    std::vector<double>         m_HeadBuffer;
+
+    // The scalar data types. The drawdowns are the heads at a reference
+    // time point, or in the comparison head file of a second run at the
+    // same time point, minus the current heads. Only the active data type
+    // is computed, as each layer record is read.
+    enum class ScalarDataType
+    {
+        Head,
+        Drawdown,
+        ComparisonDrawdown
+    };
+    ScalarDataType              m_ScalarDataType;
+    int                         m_ReferenceTimePoint;
+    // The heads of the reference time point, read when first needed
+    std::vector<double>         m_ReferenceHead;
+    mvInputFileStream           m_IfComparisonHead;
+    int                         m_NumberOfComparisonTimePoints;
+    std::vector<double>         m_OtherHeadBuffer;
+    // The time of each time point, as read from the head file
+    std::vector<double>         m_TimePoints;
+    // Offset in the head file of the time point read last, or -1
+    std::streamoff              m_CurrentHeadStart;
+
     const char *  ExtractModflowOutputFileNames(char *nameFile, char *gridFile, char *headFile, char *budgetFile);
     const char *  CreateDisGrid(char *gridFile);
     const char *  CreateDisvGrid(char *gridFile);
@@ -91,8 +165,23 @@ protected:
     const char *  CountHead(char *dataType);
     void          GetTimePoints(double *timePoints, int *periods, int *steps);
     const char *  CountBudgetAndFeatures();
+    size_t        HeadTimePointSize();
+    size_t        HeadRecordSize();
+    int           HeadRecordOfTimePoint(int timePointIndex);
+    void          GetSubgridCellRange(int *range);
+    void          InterpolateDisuPoints(const int *modflow_active_cell, int first, int last);
+    void          DecodeSpecificDischarge(const char *entry, int nlist, size_t entrySize, const int *modflow_active_cell);
+    int           GetHeadLocation(int cell, int &layer, int &index, int &q);
+    double        CheckHeadValue(int cell, int q, double value);
+    void          CheckHeadValues(int k, int first, double *values, int count);
+    const char *  CountComparisonHead();
+    void          ReadHeads(std::streamoff headStart, int *modflow_active_cell);
+    void          ComputeScalarValues(std::streamoff headStart, int k, int first, int count);
+    int           SkipBudgetRecord(std::streamoff end, int &kper, int &kstp);
+    void          MakeTimePointLabel(char *label, double time, int period, int step);
     int           PracticallyEqual(double value1, double value2);
     int           IsModelFeature(char *flowType);
+    int           StructuredNodeToVtkCell(int node);
     void          ExtractFileName(char *aString);
 };
 
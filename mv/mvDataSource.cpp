@@ -46,6 +46,8 @@ mvDataSource::mvDataSource()
     m_PathsBackwardsInTime        = 0;
     m_PathLineScalarMode          = MP_TRAVEL_TIME;
     m_StairsteppedGridCoordinates = 0;
+    m_LoadProgress                = nullptr;
+    m_LoadCancelled               = 0;
 }
 
 mvDataSource::~mvDataSource()
@@ -100,6 +102,29 @@ bool mvDataSource::ParseDataFileList(char *&pList, char *fileName)
     }
 }
 
+int mvDataSource::ReportLoadProgress(const char *stage, long long done, long long total)
+{
+    if (m_LoadProgress && !m_LoadCancelled && m_LoadProgress->Report(stage, done, total))
+    {
+        m_LoadCancelled = 1;
+    }
+    return m_LoadCancelled;
+}
+
+void mvDataSource::ReleaseGridCoordinates()
+{
+    if (CanReleaseInterpolatedGridCoordinates() && m_InterpolatedGridCoordinates)
+    {
+        delete[] m_InterpolatedGridCoordinates;
+        m_InterpolatedGridCoordinates = 0;
+    }
+    if (CanReleaseStairsteppedGridCoordinates() && m_StairsteppedGridCoordinates)
+    {
+        delete[] m_StairsteppedGridCoordinates;
+        m_StairsteppedGridCoordinates = 0;
+    }
+}
+
 int mvDataSource::GetDataSetToUseForRange()
 {
     if (GetPrimaryScalarMode() == ScalarMode::MV_CELL_SCALARS)
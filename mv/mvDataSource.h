@@ -6,6 +6,20 @@
 //#include "vtkCellArray.h"
 
 #include <string>
+#include <vector>
+
+/**
+ * Receives progress reports while a data source reads its data files. The
+ * reports may come from a worker thread. Report is given a description of
+ * the current stage and the number of bytes of the stage read so far, and
+ * returns nonzero to cancel loading.
+ */
+class MV_EXPORT mvLoadProgress
+{
+public:
+    virtual ~mvLoadProgress() {}
+    virtual int Report(const char *stage, long long done, long long total) = 0;
+};
 
 /**
  * Abstract base class to specify dataset behavior.
@@ -56,6 +70,14 @@ public:
      */
     virtual const char *LoadData(char *dataFileList)           = 0;
 
+    /**
+     * Sets the object that receives progress reports during LoadData, or
+     * nullptr for none. If the object cancels loading, LoadData returns
+     * an error message and LoadCancelled returns nonzero.
+     */
+    void                SetLoadProgress(mvLoadProgress *progress) { m_LoadProgress = progress; }
+    int                 LoadCancelled() const { return m_LoadCancelled; }
+
     /**
      * Reads data for the next time point. Reads scalar, vector, and pathline
      * data for the next time point.
@@ -68,22 +90,69 @@ public:
      */
     virtual void        SetTimePointTo(int timePointIndex)     = 0;
 
+    /**
+     * Restricts the scalar data read by SetTimePointTo to a subgrid, given as
+     * for mvManager::SetScalarSubgridExtent, and the cells around it. Values
+     * outside are set to the inactive cell value. Returns nonzero if the
+     * current time point must be reread. Data sources that always read the
+     * full grid ignore this.
+     */
+    virtual int         SetScalarSubgrid(int active, const int *extent) { return 0; }
+
     /**
      * Specifies the type of scalar data to be returned.
      */
     virtual void        SetScalarDataTypeTo(int dataTypeIndex) = 0;
 
+    /**
+     * Sets the time point that scalar data types computed as a change
+     * since an earlier time, such as drawdown, are relative to. Returns
+     * nonzero if the current time point must be reread. Data sources
+     * without such data types ignore this.
+     */
+    virtual int         SetReferenceTimePoint(int timePointIndex) { return 0; }
+    virtual int         GetReferenceTimePoint() { return 0; }
+
     /**
      * Returns the number of time points in the dataset.
      */
     virtual int         GetNumberOfTimePoints() { return m_NumberOfTimePoints; }
 
+    /**
+     * Looks for time points that have been appended to the data files since
+     * they were last counted, as happens while a model is running, and adds
+     * them to the time points and labels. Returns the number added.
+     */
+    virtual int         UpdateTimePoints() { return 0; }
+
+    /**
+     * Gets the scalar value of each of numCells cells at every time point.
+     * The cells are given by their index in the cell scalars returned by
+     * GetScalarArray. values receives GetNumberOfTimePoints() values for the
+     * first cell, then those for the second cell, and so on. Values of dry
+     * or inactive cells are the inactive cell value. Returns nonzero on
+     * success. Data sources that cannot read single cells return 0.
+     */
+    virtual int         GetTimeSeries(int numCells, const int *cells, double *values) { return 0; }
+
+    /**
+     * Returns a description of a cell, given as for GetTimeSeries,
+     * in model terms, such as its layer, row and column.
+     */
+    virtual std::string GetCellDescription(int cell) { return std::string(); }
+
     /**
      * Returns the time point labels. This is usually the times in any
      * array of character strings.
      */
     virtual char **     GetTimePointLabels() { return m_TimePointLabels; }
 
+    /**
+     * Returns the time of each time point, or 0 if the data source does not
+     * provide them. The labels may show the times rounded.
+     */
+    virtual const double *GetTimePoints() { return 0; }
+
     /**
      * Returns the number of scalar data types in the dataset.
      */
@@ -113,6 +182,15 @@ public:
     virtual double *    GetStairsteppedGridCoordinates() { return m_StairsteppedGridCoordinates; }
     virtual int         GetStairsteppedGridCoordinatesSize() { return 0; }
 
+    /**
+     * Returns nonzero if the data source does not use the grid coordinates
+     * itself after the grid is created. Such coordinates can be freed with
+     * ReleaseGridCoordinates once a copy has been made.
+     */
+    virtual int         CanReleaseInterpolatedGridCoordinates() { return 0; }
+    virtual int         CanReleaseStairsteppedGridCoordinates() { return 0; }
+    virtual void        ReleaseGridCoordinates();
+
     /**
      * Returns the scalar data.
      */
@@ -238,6 +316,15 @@ public:
     virtual int *       GetStairsteppedGridConnectivity() { return 0; }
     virtual int *       GetLayerConnectivity() { return 0; }
 
+    /**
+     * Gets the top of the model, in grid coordinates, for draping overlays.
+     * points receives x, y and z for each point, and polygons receives, for
+     * each polygon, the number of points followed by their indices. Polygons
+     * may overlap where cells are stacked, in which case the highest is the
+     * top. Returns 0 if the top is not available.
+     */
+    virtual int         GetTopSurface(std::vector<double> &points, std::vector<int> &polygons) { return 0; }
+
 protected:
     int     m_NumberOfTimePoints;
     char  **m_TimePointLabels;
@@ -279,8 +366,15 @@ protected:
     double *m_Particle_Concentrations;
     int     m_NumberOfParticles;
 
+    mvLoadProgress *m_LoadProgress;
+    int             m_LoadCancelled;
+
     bool    ParseDataFileList(char *&pList, char *fileName);
 
+    // Passes a progress report to the load progress object, if any. Returns
+    // nonzero, and sets m_LoadCancelled, if loading is to be cancelled.
+    int     ReportLoadProgress(const char *stage, long long done, long long total);
+
 public:
     double GetMinPositiveTime() { return m_MinPositiveTime; }
 };
@@ -0,0 +1,333 @@
+#include "mvDrapeIndex.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(_MSC_VER) && defined(_DEBUG) && defined(MV_DEBUG_MEMORY_LEAKS)
+#include <afx.h>
+#define new DEBUG_NEW
+#undef THIS_FILE
+static char THIS_FILE[] = __FILE__;
+#endif
+
+// Largest number of bins along a side
+#define MV_DRAPE_MAX_BINS 4096
+
+mvDrapeIndex::mvDrapeIndex()
+{
+    Clear();
+}
+
+void mvDrapeIndex::Clear()
+{
+    m_Points.clear();
+    m_Triangles.clear();
+    m_Overlapping = false;
+    m_BinStart.clear();
+    m_BinTriangles.clear();
+    m_Origin[0]        = 0;
+    m_Origin[1]        = 0;
+    m_BinSize[0]       = 1;
+    m_BinSize[1]       = 1;
+    m_NumBins[0]       = 0;
+    m_NumBins[1]       = 0;
+    m_StructuredDim[0] = 0;
+    m_StructuredDim[1] = 0;
+    for (int a = 0; a < 2; a++)
+    {
+        m_Axis[a].clear();
+        m_AxisLookup[a].clear();
+        m_AxisSign[a]  = 1;
+        m_AxisScale[a] = 1;
+    }
+}
+
+void mvDrapeIndex::Initialize(int numPoints, const double *xyz)
+{
+    Clear();
+    m_Points.assign(xyz, xyz + 3 * (size_t)numPoints);
+}
+
+void mvDrapeIndex::AddTriangle(int p0, int p1, int p2)
+{
+    m_Triangles.push_back(p0);
+    m_Triangles.push_back(p1);
+    m_Triangles.push_back(p2);
+}
+
+// True if the values are strictly increasing or strictly decreasing
+static bool IsMonotonic(const std::vector<double> &v)
+{
+    bool increasing = true;
+    bool decreasing = true;
+    for (size_t i = 1; i < v.size(); i++)
+    {
+        increasing = increasing && v[i] > v[i - 1];
+        decreasing = decreasing && v[i] < v[i - 1];
+    }
+    return increasing || decreasing;
+}
+
+void mvDrapeIndex::SetStructuredSurface(int nx, int ny, const double *xyz)
+{
+    Initialize(nx * ny, xyz);
+    if (nx < 2 || ny < 2)
+    {
+        return;
+    }
+
+    // Check whether every column of points has the same x and every row
+    // of points has the same y
+    bool aligned = true;
+    m_Axis[0].resize(nx);
+    m_Axis[1].resize(ny);
+    for (int i = 0; i < nx; i++)
+    {
+        m_Axis[0][i] = xyz[3 * i];
+    }
+    for (int j = 0; j < ny; j++)
+    {
+        m_Axis[1][j] = xyz[3 * (size_t)j * nx + 1];
+    }
+    for (int j = 0; j < ny && aligned; j++)
+    {
+        const double *row = xyz + 3 * (size_t)j * nx;
+        for (int i = 0; i < nx; i++)
+        {
+            if (row[3 * i] != m_Axis[0][i] || row[3 * i + 1] != m_Axis[1][j])
+            {
+                aligned = false;
+                break;
+            }
+        }
+    }
+
+    if (aligned && IsMonotonic(m_Axis[0]) && IsMonotonic(m_Axis[1]))
+    {
+        m_StructuredDim[0] = nx;
+        m_StructuredDim[1] = ny;
+        for (int a = 0; a < 2; a++)
+        {
+            // Decreasing coordinates are negated so that the
+            // search is always over increasing values
+            std::vector<double> &v = m_Axis[a];
+            int                  n = (int)v.size();
+            m_AxisSign[a]          = (v[0] < v[n - 1]) ? 1 : -1;
+            for (int i = 0; i < n; i++)
+            {
+                v[i] *= m_AxisSign[a];
+            }
+            // m_AxisLookup[a][b] is the interval that contains the start of
+            // lookup bin b. There are 4 bins per interval on average, so the
+            // search usually only looks at one or two intervals.
+            int nb            = 4 * (n - 1);
+            m_AxisScale[a]    = nb / (v[n - 1] - v[0]);
+            m_AxisLookup[a].resize(nb + 1);
+            int i             = 0;
+            for (int b = 0; b < nb; b++)
+            {
+                double start = v[0] + b / m_AxisScale[a];
+                while (i < n - 2 && v[i + 1] <= start)
+                {
+                    i++;
+                }
+                m_AxisLookup[a][b] = i;
+            }
+            m_AxisLookup[a][nb] = n - 2;
+        }
+        return;
+    }
+
+    m_Axis[0].clear();
+    m_Axis[1].clear();
+    for (int j = 0; j < ny - 1; j++)
+    {
+        for (int i = 0; i < nx - 1; i++)
+        {
+            int p = j * nx + i;
+            AddTriangle(p, p + 1, p + 1 + nx);
+            AddTriangle(p, p + 1 + nx, p + nx);
+        }
+    }
+    Build();
+}
+
+int mvDrapeIndex::FindInterval(int a, double x) const
+{
+    const std::vector<double> &v = m_Axis[a];
+    int                        n = (int)v.size();
+    x *= m_AxisSign[a];
+    if (x < v[0] || x > v[n - 1])
+    {
+        return -1;
+    }
+    int b  = std::min((int)((x - v[0]) * m_AxisScale[a]), (int)m_AxisLookup[a].size() - 2);
+    int lo = m_AxisLookup[a][b];
+    int hi = m_AxisLookup[a][b + 1] + 2;
+    int i  = (int)(std::upper_bound(v.begin() + lo, v.begin() + hi, x) - v.begin()) - 1;
+    return std::max(0, std::min(i, n - 2));
+}
+
+void mvDrapeIndex::Build()
+{
+    int numTriangles = GetNumberOfTriangles();
+    m_BinStart.clear();
+    m_BinTriangles.clear();
+    m_NumBins[0] = 0;
+    m_NumBins[1] = 0;
+    if (numTriangles == 0)
+    {
+        return;
+    }
+
+    double bounds[4] = {m_Points[0], m_Points[0], m_Points[1], m_Points[1]};
+    for (size_t i = 0; i < m_Points.size(); i += 3)
+    {
+        bounds[0] = std::min(bounds[0], m_Points[i]);
+        bounds[1] = std::max(bounds[1], m_Points[i]);
+        bounds[2] = std::min(bounds[2], m_Points[i + 1]);
+        bounds[3] = std::max(bounds[3], m_Points[i + 1]);
+    }
+    double width  = bounds[1] - bounds[0];
+    double height = bounds[3] - bounds[2];
+
+    // square bins, about one triangle per bin
+    double size   = std::sqrt(std::max(width * height, 1.0e-300) / numTriangles);
+    for (int i = 0; i < 2; i++)
+    {
+        double extent = (i == 0) ? width : height;
+        int    n      = (size > 0) ? (int)std::ceil(extent / size) : 1;
+        m_NumBins[i]  = std::max(1, std::min(n, MV_DRAPE_MAX_BINS));
+        m_BinSize[i]  = (extent > 0) ? extent / m_NumBins[i] : 1;
+    }
+    m_Origin[0] = bounds[0];
+    m_Origin[1] = bounds[2];
+
+    // count the triangles in each bin, then fill the bins
+    std::vector<int> binRange(4 * (size_t)numTriangles);
+    m_BinStart.assign((size_t)m_NumBins[0] * m_NumBins[1] + 1, 0);
+    for (int t = 0; t < numTriangles; t++)
+    {
+        double tb[4];
+        for (int c = 0; c < 3; c++)
+        {
+            const double *p = &m_Points[3 * (size_t)m_Triangles[3 * t + c]];
+            if (c == 0)
+            {
+                tb[0] = tb[1] = p[0];
+                tb[2] = tb[3] = p[1];
+            }
+            else
+            {
+                tb[0] = std::min(tb[0], p[0]);
+                tb[1] = std::max(tb[1], p[0]);
+                tb[2] = std::min(tb[2], p[1]);
+                tb[3] = std::max(tb[3], p[1]);
+            }
+        }
+        int *r = &binRange[4 * (size_t)t];
+        for (int i = 0; i < 2; i++)
+        {
+            r[2 * i]     = std::max(0, std::min(m_NumBins[i] - 1, (int)std::floor((tb[2 * i] - m_Origin[i]) / m_BinSize[i])));
+            r[2 * i + 1] = std::max(0, std::min(m_NumBins[i] - 1, (int)std::floor((tb[2 * i + 1] - m_Origin[i]) / m_BinSize[i])));
+        }
+        for (int j = r[2]; j <= r[3]; j++)
+        {
+            for (int i = r[0]; i <= r[1]; i++)
+            {
+                m_BinStart[(size_t)j * m_NumBins[0] + i + 1]++;
+            }
+        }
+    }
+    for (size_t b = 1; b < m_BinStart.size(); b++)
+    {
+        m_BinStart[b] += m_BinStart[b - 1];
+    }
+    m_BinTriangles.resize(m_BinStart.back());
+    std::vector<int> next(m_BinStart.begin(), m_BinStart.end() - 1);
+    for (int t = 0; t < numTriangles; t++)
+    {
+        const int *r = &binRange[4 * (size_t)t];
+        for (int j = r[2]; j <= r[3]; j++)
+        {
+            for (int i = r[0]; i <= r[1]; i++)
+            {
+                m_BinTriangles[next[(size_t)j * m_NumBins[0] + i]++] = t;
+            }
+        }
+    }
+}
+
+bool mvDrapeIndex::GetElevationInTriangle(int p0, int p1, int p2, double x, double y, double &z) const
+{
+    const double *a   = &m_Points[3 * (size_t)p0];
+    const double *b   = &m_Points[3 * (size_t)p1];
+    const double *c   = &m_Points[3 * (size_t)p2];
+    double        det = (b[1] - c[1]) * (a[0] - c[0]) + (c[0] - b[0]) * (a[1] - c[1]);
+    if (det == 0)
+    {
+        return false;
+    }
+    // barycentric coordinates of (x, y), allowing for round off
+    // in points on an edge
+    double w0 = ((b[1] - c[1]) * (x - c[0]) + (c[0] - b[0]) * (y - c[1])) / det;
+    double w1 = ((c[1] - a[1]) * (x - c[0]) + (a[0] - c[0]) * (y - c[1])) / det;
+    double w2 = 1 - w0 - w1;
+    if (w0 >= -1.0e-9 && w1 >= -1.0e-9 && w2 >= -1.0e-9)
+    {
+        z = w0 * a[2] + w1 * b[2] + w2 * c[2];
+        return true;
+    }
+    return false;
+}
+
+bool mvDrapeIndex::GetElevation(double x, double y, double &z) const
+{
+    if (m_StructuredDim[0] > 0)
+    {
+        int i = FindInterval(0, x);
+        int j = FindInterval(1, y);
+        if (i < 0 || j < 0)
+        {
+            return false;
+        }
+        int nx = m_StructuredDim[0];
+        int p  = j * nx + i;
+        return GetElevationInTriangle(p, p + 1, p + 1 + nx, x, y, z) ||
+               GetElevationInTriangle(p, p + 1 + nx, p + nx, x, y, z);
+    }
+
+    if (m_NumBins[0] == 0)
+    {
+        return false;
+    }
+    double fx = (x - m_Origin[0]) / m_BinSize[0];
+    double fy = (y - m_Origin[1]) / m_BinSize[1];
+    if (fx < -1.0e-9 || fy < -1.0e-9 || fx > m_NumBins[0] + 1.0e-9 || fy > m_NumBins[1] + 1.0e-9)
+    {
+        return false;
+    }
+    int ix = std::max(0, std::min(m_NumBins[0] - 1, (int)fx));
+    int iy = std::max(0, std::min(m_NumBins[1] - 1, (int)fy));
+    int b  = iy * m_NumBins[0] + ix;
+    bool found = false;
+    for (int k = m_BinStart[b]; k < m_BinStart[b + 1]; k++)
+    {
+        const int *tri = &m_Triangles[3 * (size_t)m_BinTriangles[k]];
+        double     zt;
+        if (GetElevationInTriangle(tri[0], tri[1], tri[2], x, y, zt))
+        {
+            if (!m_Overlapping)
+            {
+                z = zt;
+                return true;
+            }
+            if (!found || zt > z)
+            {
+                z = zt;
+            }
+            found = true;
+        }
+    }
+    return found;
+}
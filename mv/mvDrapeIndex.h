@@ -0,0 +1,86 @@
+#ifndef __mvDrapeIndex_h
+#define __mvDrapeIndex_h
+
+#include "mvHeader.h"
+
+#include <vector>
+
+/**
+ * A 2D index of a surface made of triangles, for finding the elevation of
+ * the surface directly above or below a point. The triangles are sorted
+ * into a uniform grid of bins sized so that each bin holds about one
+ * triangle, so a lookup only tests the few triangles in one bin.
+ *
+ * The top of a structured grid whose columns and rows of points are
+ * aligned with the x and y axes is not binned. Instead the column and
+ * row of a point are found from a lookup table over each axis.
+ *
+ * Lookups do not modify the index and may be made from several threads
+ * at once.
+ */
+class MV_EXPORT mvDrapeIndex
+{
+public:
+    mvDrapeIndex();
+
+    /**
+     * Starts a new surface with the given points (x, y, z for each point).
+     * The points are copied.
+     */
+    void   Initialize(int numPoints, const double *xyz);
+    void   AddTriangle(int p0, int p1, int p2);
+    /**
+     * Sets the surface to the nx by ny points of the top of a structured
+     * grid, ordered by column and then by row. Each cell is split into two
+     * triangles. The index is built, so Build does not need to be called.
+     */
+    void   SetStructuredSurface(int nx, int ny, const double *xyz);
+    /**
+     * Sorts the triangles into bins. Call after the last AddTriangle and
+     * before GetElevation.
+     */
+    void   Build();
+    void   Clear();
+    /**
+     * If the triangles overlap in plan, as the tops of stacked cells do,
+     * GetElevation returns the highest elevation at a point. Otherwise it
+     * returns the elevation of the first triangle found.
+     */
+    void   SetOverlapping(bool b) { m_Overlapping = b; }
+
+    int    GetNumberOfTriangles() const { return (int)m_Triangles.size() / 3; }
+    bool   IsEmpty() const { return m_StructuredDim[0] == 0 && m_NumBins[0] == 0; }
+
+    /**
+     * Sets z to the elevation of the surface at (x, y) and returns true, or
+     * returns false if (x, y) is not on the surface.
+     */
+    bool   GetElevation(double x, double y, double &z) const;
+
+protected:
+    // Elevation at (x, y) if it is in triangle p0, p1, p2
+    bool                GetElevationInTriangle(int p0, int p1, int p2, double x, double y, double &z) const;
+    // Column (a = 0) or row (a = 1) of a structured surface that contains
+    // coordinate x, or -1
+    int                 FindInterval(int a, double x) const;
+
+    std::vector<double> m_Points;
+    std::vector<int>    m_Triangles;
+    bool                m_Overlapping;
+    double              m_Origin[2];
+    double              m_BinSize[2];
+    int                 m_NumBins[2];
+    // m_BinTriangles[m_BinStart[b]] to m_BinTriangles[m_BinStart[b + 1] - 1]
+    // are the triangles that overlap bin b
+    std::vector<int>    m_BinStart;
+    std::vector<int>    m_BinTriangles;
+    // Coordinates of the columns and rows of a structured surface, or
+    // empty if the surface is binned
+    int                 m_StructuredDim[2];
+    std::vector<double> m_Axis[2];
+    double              m_AxisSign[2];
+    double              m_AxisScale[2];
+    std::vector<int>    m_AxisLookup[2];
+};
+
+#endif
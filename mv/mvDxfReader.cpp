@@ -3,10 +3,9 @@
 #include <math.h>
 #include <stdlib.h>
 #include "mvDxfReader.h"
-#include "mvLinkList.h"
 #include "mvUtil.h"
 
-const double PI = 3.14159265;
+const double PI = 3.14159265358979;
 
 // This must be below vtkStandardNewMacro
 #if defined(_MSC_VER) && defined(_DEBUG) && defined(MV_DEBUG_MEMORY_LEAKS)
@@ -16,53 +15,132 @@ const double PI = 3.14159265;
 static char THIS_FILE[] = __FILE__;
 #endif
 
-mvDxfReader::mvDxfReader()
-{
-    m_FileName                 = 0;
-    m_XCoord                   = 0;
-    m_YCoord                   = 0;
-    m_NumberOfVerticesInEntity = 0;
-    m_NumberOfEntities         = 0;
-    layer_name                 = 0;
-    layer_color                = 0;
-}
+// Size of the blocks read from the file. The buffer grows if a line is
+// longer than this.
+#define MV_DXF_BLOCK_SIZE (1 << 22)
 
-mvDxfReader::~mvDxfReader()
+// Parses a group code. Group codes are integers, possibly with leading
+// blanks, which have already been removed.
+static int ParseInt(const char *s)
 {
-    if (m_FileName)
+    int sign = 1;
+    if (*s == '-')
     {
-        delete[] m_FileName;
+        sign = -1;
+        s++;
     }
-    ClearData();
+    else if (*s == '+')
+    {
+        s++;
+    }
+    int value = 0;
+    while (*s >= '0' && *s <= '9')
+    {
+        value = 10 * value + (*s - '0');
+        s++;
+    }
+    return sign * value;
 }
 
-void mvDxfReader::ClearData()
+// Parses a number. Numbers with at most 15 significant digits and a small
+// exponent, which is almost every number in a DXF file, are converted
+// exactly from their digits. Others are left to strtod.
+static double ParseDouble(const char *s)
 {
-    int i;
-    if (m_XCoord)
+    static const double powers[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                     1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    const char         *p        = s;
+    bool                negative = false;
+    if (*p == '-' || *p == '+')
+    {
+        negative = (*p == '-');
+        p++;
+    }
+    long long mantissa = 0;
+    int       digits   = 0;
+    int       exponent = 0;
+    bool      any      = false;
+    while (*p >= '0' && *p <= '9')
     {
-        for (i = 0; i < m_NumberOfEntities; i++)
+        if (digits > 0 || *p != '0')
         {
-            if (m_XCoord[i]) delete[] m_XCoord[i];
+            digits++;
+        }
+        mantissa = 10 * mantissa + (*p - '0');
+        any      = true;
+        p++;
+        if (digits > 15)
+        {
+            return atof(s);
         }
-        delete[] m_XCoord;
-        m_XCoord = 0;
     }
-    if (m_YCoord)
+    if (*p == '.')
     {
-        for (i = 0; i < m_NumberOfEntities; i++)
+        p++;
+        while (*p >= '0' && *p <= '9')
         {
-            if (m_YCoord[i]) delete[] m_YCoord[i];
+            if (digits > 0 || *p != '0')
+            {
+                digits++;
+            }
+            mantissa = 10 * mantissa + (*p - '0');
+            exponent--;
+            any = true;
+            p++;
+            if (digits > 15)
+            {
+                return atof(s);
+            }
         }
-        delete[] m_YCoord;
-        m_YCoord = 0;
     }
-    if (m_NumberOfVerticesInEntity)
+    if (!any)
     {
-        delete[] m_NumberOfVerticesInEntity;
-        m_NumberOfVerticesInEntity = 0;
+        return 0;
     }
-    m_NumberOfEntities = 0;
+    if (*p == 'e' || *p == 'E')
+    {
+        exponent += ParseInt(p + 1);
+    }
+    else if (*p != '\0')
+    {
+        return atof(s);
+    }
+    double value = (double)mantissa;
+    if (exponent < -22 || exponent > 22)
+    {
+        return atof(s);
+    }
+    value = (exponent < 0) ? value / powers[-exponent] : value * powers[exponent];
+    return negative ? -value : value;
+}
+
+mvDxfReader::mvDxfReader()
+{
+    m_FileName   = 0;
+    m_File       = 0;
+    m_Buffer     = 0;
+    m_BufferSize = 0;
+    m_Next       = 0;
+    m_End        = 0;
+    m_EndOfFile  = 0;
+    m_VertexOffset.push_back(0);
+}
+
+mvDxfReader::~mvDxfReader()
+{
+    if (m_FileName)
+    {
+        delete[] m_FileName;
+    }
+    ClearData();
+}
+
+void mvDxfReader::ClearData()
+{
+    m_XCoord.clear();
+    m_YCoord.clear();
+    m_VertexOffset.assign(1, 0);
+    m_Arcs.clear();
 }
 
 void mvDxfReader::SetFileName(char *filename)
@@ -90,869 +168,447 @@ void mvDxfReader::SetFileName(char *filename)
 
 int mvDxfReader::GetNumberOfEntities()
 {
-    return m_NumberOfEntities;
+    return (int)m_VertexOffset.size() - 1;
 }
 
 int mvDxfReader::GetNumberOfVerticesInEntity(int i)
 {
-    if (!m_NumberOfVerticesInEntity || i > m_NumberOfEntities)
+    if (i < 0 || i >= GetNumberOfEntities())
     {
         return 0;
     }
     else
     {
-        return m_NumberOfVerticesInEntity[i];
+        return m_VertexOffset[i + 1] - m_VertexOffset[i];
     }
 }
 
 int mvDxfReader::GetCoordinates(int entity, int vertex, double &x, double &y)
 {
-    if (entity >= m_NumberOfEntities)
+    if (vertex < 0 || vertex >= GetNumberOfVerticesInEntity(entity))
     {
         return 0;
     }
-    if (!m_NumberOfVerticesInEntity || vertex >= m_NumberOfVerticesInEntity[entity])
+    x = m_XCoord[m_VertexOffset[entity] + vertex];
+    y = m_YCoord[m_VertexOffset[entity] + vertex];
+    return 1;
+}
+
+int mvDxfReader::GetNumberOfArcs()
+{
+    return (int)m_Arcs.size() / 5;
+}
+
+int mvDxfReader::GetArc(int i, double &cx, double &cy, double &radius, double &start, double &sweep)
+{
+    if (i < 0 || i >= GetNumberOfArcs())
     {
         return 0;
     }
-    if (!m_XCoord || !m_YCoord || !m_XCoord[entity] || !m_YCoord[entity])
+    const double *a = &m_Arcs[5 * (size_t)i];
+    cx              = a[0];
+    cy              = a[1];
+    radius          = a[2];
+    start           = a[3];
+    sweep           = a[4];
+    return 1;
+}
+
+void mvDxfReader::AddArc(double cx, double cy, double radius, double start, double sweep)
+{
+    m_Arcs.push_back(cx);
+    m_Arcs.push_back(cy);
+    m_Arcs.push_back(radius);
+    m_Arcs.push_back(start);
+    m_Arcs.push_back(sweep);
+}
+
+// Ends the entity whose vertices have been added since the last call.
+// Entities without vertices are dropped.
+void mvDxfReader::EndEntity()
+{
+    if ((int)m_XCoord.size() > m_VertexOffset.back())
     {
-        return 0;
+        m_VertexOffset.push_back((int)m_XCoord.size());
     }
-    x = m_XCoord[entity][vertex];
-    y = m_YCoord[entity][vertex];
-    return 1;
 }
 
 int mvDxfReader::Read(const char *errMsg)
 {
     double Xoff = 0.0;
     double Yoff = 0.0;
-    int    i;
-    int    test, code;
-    char   buffer[1024];
-    num_layers = 0;
-    errMsg     = nullptr;
+    int    code;
+    char  *value;
+    errMsg = nullptr;
     ClearData();
 
     // Open DXF file
-    if ((fdxf = fopen(m_FileName, "r")) == 0)
+    if ((m_File = fopen(m_FileName, "rb")) == 0)
     {
         errMsg = "Unable to open DXF file.";
         return 0;
     }
+    m_BufferSize = MV_DXF_BLOCK_SIZE;
+    m_Buffer     = new char[m_BufferSize + 1];
+    m_Next       = m_Buffer;
+    m_End        = m_Buffer;
+    m_EndOfFile  = 0;
+
+    // The file is read in one pass. The x and y offsets are in the
+    // HEADER section, which comes before the ENTITIES section.
+    int foundEntities = 0;
+    int more          = NextGroup(code, value);
+    while (more)
+    {
+        if (code == 9 && mvUtil::stricmp(value, "$ucsorg") == 0)
+        {
+            more = ReadUcsOrigin(code, value, Xoff, Yoff);
+        }
+        else if (code == 0 && mvUtil::stricmp(value, "section") == 0)
+        {
+            more = NextGroup(code, value);
+            if (more && code == 2 && mvUtil::stricmp(value, "entities") == 0)
+            {
+                foundEntities = 1;
+                break;
+            }
+        }
+        else
+        {
+            more = NextGroup(code, value);
+        }
+    }
 
-    // Get Layer Colors
-    get_layer_info();
-
-    // Read the x and y offsets
-    rewind(fdxf);
-    int found = 0;
-    do
+    // Process Entity Data
+    if (foundEntities)
     {
-        if (fgets(buffer, 1024, fdxf) == nullptr) break;
-        if (mvUtil::stricmp(buffer, "$ucsorg\n") == 0)
+        more = NextGroup(code, value);
+        while (more)
         {
-            for (;;)
+            if (code != 0)
+            {
+                more = SkipToNextEntity(code, value);
+            }
+            else if (!mvUtil::stricmp(value, "polyline"))
+            {
+                more = ReadPolylineEntity(code, value);
+            }
+            else if (!mvUtil::stricmp(value, "lwpolyline"))
+            {
+                more = ReadLwPolylineEntity(code, value);
+            }
+            else if (!mvUtil::stricmp(value, "line"))
+            {
+                more = ReadLineEntity(code, value);
+            }
+            else if (!mvUtil::stricmp(value, "circle"))
+            {
+                more = ReadCircleEntity(code, value);
+            }
+            else if (!mvUtil::stricmp(value, "arc"))
+            {
+                more = ReadArcEntity(code, value);
+            }
+            else if (!mvUtil::stricmp(value, "endsec"))
+            {
+                break;
+            }
+            else
             {
-                test = ReadValue(fdxf, &code);
-                if (code == 10)
-                {
-                    ReadValue(fdxf, &Xoff);
-                }
-                else if (code == 20)
-                {
-                    ReadValue(fdxf, &Yoff);
-                }
-                else if (code == 9)
-                {
-                    break;
-                }
-                else
-                {
-                    char* s = fgets(buffer, 1024, fdxf);
-                    assert(s);
-                }
+                more = SkipToNextEntity(code, value);
             }
-            found = 1;
         }
-    } while (!found);
+    }
+    fclose(m_File);
+    m_File = 0;
+    delete[] m_Buffer;
+    m_Buffer = 0;
 
-    //  Find Beginning of Entity Section
-    rewind(fdxf);
-    if (!find_entity())
+    if (!foundEntities)
     {
-        fclose(fdxf);
         errMsg = "No entities in DXF file.";
         return 0;
     }
 
-    // Process Entity Data
-    mvLinkList *lines = new mvLinkList;
-    do
+    if (Xoff != 0 || Yoff != 0)
     {
-        if (fgets(buffer, 1024, fdxf) == nullptr)
-        {
-            break;
-        }
-        if (!mvUtil::stricmp(buffer, "polyline\n"))
-        {
-            process_poly(lines);
-        }
-        else if (!mvUtil::stricmp(buffer, "lwpolyline\n"))
-        {
-            process_lwpoly(lines);
-        }
-        else if (!mvUtil::stricmp(buffer, "line\n"))
+        for (size_t i = 0; i < m_XCoord.size(); i++)
         {
-            process_line(lines);
+            m_XCoord[i] += Xoff;
+            m_YCoord[i] += Yoff;
         }
-        else if (!mvUtil::stricmp(buffer, "text\n"))
+        for (size_t i = 0; i < m_Arcs.size(); i += 5)
         {
-            process_text();
+            m_Arcs[i] += Xoff;
+            m_Arcs[i + 1] += Yoff;
         }
-        else if (!mvUtil::stricmp(buffer, "circle\n"))
-        {
-            process_circle(lines);
-        }
-        else if (!mvUtil::stricmp(buffer, "arc\n"))
-        {
-            process_arc(lines);
-        }
-        else if (!mvUtil::stricmp(buffer, "endsec\n"))
+    }
+    return 1;
+}
+
+// Sets line to the next line of the file, without leading and trailing
+// blanks. The line is in the buffer and is valid until the next call.
+int mvDxfReader::NextLine(char *&line)
+{
+    char *eol = (char *)memchr(m_Next, '\n', m_End - m_Next);
+    while (eol == 0 && !m_EndOfFile)
+    {
+        // Move the partial line to the start of the buffer, growing the
+        // buffer if the line fills it, and read the next block
+        size_t partial = m_End - m_Next;
+        if (partial == m_BufferSize)
         {
-            break;
+            char *buffer = new char[2 * m_BufferSize + 1];
+            memcpy(buffer, m_Next, partial);
+            delete[] m_Buffer;
+            m_Buffer = buffer;
+            m_BufferSize *= 2;
         }
         else
         {
-            process_none();
+            memmove(m_Buffer, m_Next, partial);
         }
-    } while (1);
-    fclose(fdxf);
-
-    // Extract coordinates
-    m_NumberOfEntities         = lines->GetNumberOfItems();
-    m_XCoord                   = new double *[m_NumberOfEntities];
-    m_YCoord                   = new double *[m_NumberOfEntities];
-    m_NumberOfVerticesInEntity = new int[m_NumberOfEntities];
-    for (i = 0; i < m_NumberOfEntities; i++)
-    {
-        m_XCoord[i]                   = 0;
-        m_YCoord[i]                   = 0;
-        m_NumberOfVerticesInEntity[i] = 0;
+        size_t n    = fread(m_Buffer + partial, 1, m_BufferSize - partial, m_File);
+        m_EndOfFile = (n < m_BufferSize - partial);
+        m_Next      = m_Buffer;
+        m_End       = m_Buffer + partial + n;
+        eol         = (char *)memchr(m_Buffer + partial, '\n', n);
     }
-    lines->InitTraversal();
-    for (i = 0; i < m_NumberOfEntities; i++)
+    if (eol == 0)
     {
-        mvLinkList *aLine             = (mvLinkList *)lines->GetNextItem();
-        int         nv                = aLine->GetNumberOfItems();
-        m_NumberOfVerticesInEntity[i] = nv;
-        m_XCoord[i]                   = new double[nv];
-        m_YCoord[i]                   = new double[nv];
-        aLine->InitTraversal();
-        for (int j = 0; j < nv; j++)
+        // the last line of the file may not end with a line feed
+        if (m_Next == m_End)
         {
-            double *u      = (double *)aLine->GetNextItem();
-            m_XCoord[i][j] = u[0] + Xoff;
-            m_YCoord[i][j] = u[1] + Yoff;
-            delete[] u;
+            return 0;
         }
-        delete aLine;
+        eol = m_End;
     }
-    delete lines;
-    lines = 0;
-
-    for (i = 0; i < num_layers; i++)
+    char *begin = m_Next;
+    char *end   = eol;
+    m_Next      = (eol == m_End) ? m_End : eol + 1;
+    while (begin < end && (*begin == ' ' || *begin == '\t'))
     {
-        delete[] layer_name[i];
+        begin++;
     }
-    delete[] layer_name;
-    layer_name = 0;
-    delete[] layer_color;
-    layer_color = 0;
-
+    while (end > begin && (end[-1] == '\r' || end[-1] == ' ' || end[-1] == '\t'))
+    {
+        end--;
+    }
+    *end = '\0';
+    line = begin;
     return 1;
 }
-/***********************************************************************/
-/*  get_layer_info  ..... The TABLES Section of a DXF file contains    */
-/*                        information about LAYERS, such as the color. */
-/***********************************************************************/
 
-void mvDxfReader::get_layer_info(void)
+int mvDxfReader::NextGroup(int &code, char *&value)
 {
-    int         test;
-    int         code;
-    char        buffer[1024];
-
-    mvLinkList *names  = new mvLinkList;
-    mvLinkList *colors = new mvLinkList;
-
-    do
-    {
-        if (fgets(buffer, 1024, fdxf) == nullptr) goto ProcessLayers;
-        if (mvUtil::stricmp(buffer, "tables\n") == 0)
-        {
-            do
-            {
-                if (fgets(buffer, 1024, fdxf) == nullptr) goto ProcessLayers;
-                if (mvUtil::stricmp(buffer, "layer\n") == 0)
-                {
-                    for (;;)
-                    {
-                        test = ReadValue(fdxf, &code);
-                        if (code == 2)
-                        {
-                            char *name = new char[1024];
-                            char *s    = fgets(name, 1024, fdxf);
-                            assert(s);
-                            if (s != nullptr) names->AddItem(name);
-                        }
-                        else if (code == 62)
-                        {
-                            int *color = new int;
-                            ReadValue(fdxf, color);
-                            colors->AddItem(color);
-                        }
-                        else if (code == 0)
-                        {
-                            break;
-                        }
-                        else
-                        {
-                            char* s = fgets(buffer, 1024, fdxf);
-                            assert(s != nullptr);
-                        }
-                    }
-                }
-                else if (mvUtil::stricmp(buffer, "endsec\n") == 0)
-                {
-                    goto ProcessLayers;
-                }
-            } while (1);
-        }
-    } while (1);
-
-ProcessLayers:
-    num_layers = names->GetNumberOfItems();
-    if (num_layers == 0)
-    {
-        delete names;
-        delete colors;
-        return;
-    }
-    int nnc     = colors->GetNumberOfItems();
-    layer_name  = new char *[num_layers];
-    layer_color = new int[num_layers];
-    names->InitTraversal();
-    colors->InitTraversal();
-    for (int i = 0; i < num_layers; i++)
+    char *line;
+    if (!NextLine(line))
     {
-        layer_name[i]  = (char *)names->GetNextItem();
-        int *c         = (int *)colors->GetNextItem();
-        layer_color[i] = *c;
-        delete c;
+        return 0;
     }
-    delete names;
-    delete colors;
+    code = ParseInt(line);
+    return NextLine(value);
 }
 
-/***********************************************************************/
-/*  get_layer     ..... Find color for layer.                          */
-/***********************************************************************/
-int mvDxfReader::get_layer(char *lname)
+// Reads the values of $UCSORG, up to the next header variable or
+// group code 0
+int mvDxfReader::ReadUcsOrigin(int &code, char *&value, double &x, double &y)
 {
-    int i;
-
-    for (i = 0; i < num_layers; i++)
+    while (NextGroup(code, value))
     {
-        if (mvUtil::stricmp(layer_name[i], lname) == 0)
+        if (code == 10)
         {
-            return layer_color[i];
+            x = ParseDouble(value);
+        }
+        else if (code == 20)
+        {
+            y = ParseDouble(value);
+        }
+        else if (code == 9 || code == 0)
+        {
+            return 1;
         }
     }
-    return -1;
+    return 0;
 }
 
-/***********************************************************************/
-/*  find_entity     ..... Find the beginning of the ENTITY section of  */
-/*                        the DXF file.                                */
-/***********************************************************************/
-int mvDxfReader::find_entity(void)
+int mvDxfReader::SkipToNextEntity(int &code, char *&value)
 {
-    int  test;
-    char buffer[1024];
-
-    do
+    while (NextGroup(code, value))
     {
-        if (fgets(buffer, 1024, fdxf) == nullptr)
-        {
-            test = feof(fdxf);
-            if (test)
-            { /*----- END OF FILE, START OVER -----*/
-                fclose(fdxf);
-                if ((fdxf = fopen(m_FileName, "r")) == 0)
-                {
-                    return 0;
-                }
-                do
-                {
-                    if (fgets(buffer, 1024, fdxf) == nullptr)
-                    {
-                        return 0;
-                    }
-                    if (mvUtil::stricmp(buffer, "entities\n") == 0)
-                    {
-                        char* s = fgets(buffer, 1024, fdxf);
-                        assert(s);
-                        return 1;
-                    }
-                } while (1);
-            }
-            else
-            {
-                return 0;
-            }
-        }
-        if (mvUtil::stricmp(buffer, "entities\n") == 0)
+        if (code == 0)
         {
-            char *s = fgets(buffer, 1024, fdxf);
-            assert(s);
             return 1;
         }
-    } while (1);
-    return 1;
+    }
+    return 0;
 }
 
-/***********************************************************************/
-/*  process_line     ..... Read critical data about the line entity    */
-/***********************************************************************/
-void mvDxfReader::process_line(mvLinkList *lines)
+int mvDxfReader::ReadLineEntity(int &code, char *&value)
 {
-    int    test;
-    int    code;
-    int    color;
-    char   buffer2[1024];
-    double x1, y1;
-    double x2, y2;
-    char * s;
-
-    color             = 1;
-
-    mvLinkList *aline = new mvLinkList;
-    lines->AddItem(aline);
-
-    do
+    double x1 = 0, y1 = 0;
+    double x2 = 0, y2 = 0;
+    int    more;
+    while ((more = NextGroup(code, value)) && code != 0)
     {
-        test = ReadValue(fdxf, &code);
-
         switch (code)
         {
-        case 8: /*----- layer name -----*/
-            s = fgets(buffer2, 1024, fdxf);
-            assert(s);
-            color = get_layer(buffer2);
-            break;
         case 10:
-            test = ReadValue(fdxf, &x1);
+            x1 = ParseDouble(value);
             break;
         case 20:
-            test = ReadValue(fdxf, &y1);
+            y1 = ParseDouble(value);
             break;
         case 11:
-            test = ReadValue(fdxf, &x2);
+            x2 = ParseDouble(value);
             break;
         case 21:
-            test = ReadValue(fdxf, &y2);
-            break;
-        case 62:
-            test = ReadValue(fdxf, &color);
-            break;
-        case 0:
-            break;
-        default:
-            s = fgets(buffer2, 1024, fdxf);
-            assert(s);
+            y2 = ParseDouble(value);
             break;
         }
-    } while (code != 0);
-    double *c = new double[2];
-    c[0]      = x1;
-    c[1]      = y1;
-    aline->AddItem(c);
-    c    = new double[2];
-    c[0] = x2;
-    c[1] = y2;
-    aline->AddItem(c);
+    }
+    m_XCoord.push_back(x1);
+    m_YCoord.push_back(y1);
+    m_XCoord.push_back(x2);
+    m_YCoord.push_back(y2);
+    EndEntity();
+    return more;
 }
 
-/***********************************************************************/
-/*  process_poly     ..... Read critical data about the poly entity    */
-/***********************************************************************/
-void mvDxfReader::process_poly(mvLinkList *lines)
+// A POLYLINE entity is followed by a VERTEX entity for each vertex, and
+// then by a SEQEND entity
+int mvDxfReader::ReadPolylineEntity(int &code, char *&value)
 {
-    int    test;
-    int    code;
-    int    temp, spline, quit, closed;
-    int    vert_num;
-    int    color;
-    double bulge;
-    double xstart, ystart;
-    double zz;
-    char   buffer2[1024];
-    double x1, y1;
-    double x2, y2;
-    char * s;
-
-    color             = 1;
-    quit              = 0;
-    spline            = 0;
-    closed            = 0;
-    int         found = 0;
-
-    mvLinkList *aline = new mvLinkList;
-    lines->AddItem(aline);
-
-    do
+    int    closed = 0;
+    double x = 0, y = 0;
+    int    more;
+    while ((more = NextGroup(code, value)) && code != 0)
     {
-        test = ReadValue(fdxf, &code);
-
-        switch (code)
+        if (code == 70)
         {
-        case 8: /*----- layer name -----*/
-            s = fgets(buffer2, 1024, fdxf);
-            assert(s);
-            color = get_layer(buffer2);
-            break;
-
-        case 30:
-            test  = ReadValue(fdxf, &zz);
-            found = 1;
-            break;
-
-        case 62:
-            test = ReadValue(fdxf, &color);
-            break;
-
-        case 70:
-            test = ReadValue(fdxf, &temp); /*-- Check for Splines --*/
-            if (temp == 4) spline = 1;
-            if (temp == 1) closed = 1;
-            break;
-
-        case 0:
-            break;
-        default:
-            s = fgets(buffer2, 1024, fdxf);
-            assert(s);
-            break;
+            closed = (ParseInt(value) == 1);
         }
-    } while (code != 0);
-
-    /*----- process vertices of polyline ----*/
-    vert_num = 0;
-    do
+    }
+    size_t first = m_XCoord.size();
+    while (more && mvUtil::stricmp(value, "vertex") == 0)
     {
-        s = fgets(buffer2, 1024, fdxf);
-        assert(s);
-        if (strstr(mvUtil::strlwr(buffer2), "vertex"))
+        while ((more = NextGroup(code, value)) && code != 0)
         {
-            vert_num++;
-            do
-            {
-                test = ReadValue(fdxf, &code);
-                switch (code)
-                {
-                case 8: /*----- layer name -----*/
-                    s = fgets(buffer2, 1024, fdxf);
-                    assert(s);
-                    // if(strstr(buffer2,"HARD") != NULL) found = 1;
-                    // if(strstr(buffer2,"TOP") != NULL) found = 1;
-                    /*                       color = get_layer(buffer2);*/
-                    break;
-                case 10:
-                    test = ReadValue(fdxf, &x2);
-                    break;
-                case 20:
-                    test = ReadValue(fdxf, &y2);
-                    break;
-                case 38:
-                    test  = ReadValue(fdxf, &zz);
-                    found = 1;
-                    break;
-                case 42:
-                    test = ReadValue(fdxf, &bulge); /* Not processing */
-                    break;                          /* Bulge Data Yet */
-                case 62:
-                    test = ReadValue(fdxf, &temp);
-                    break;
-                case 70:
-                    test = ReadValue(fdxf, &temp);
-                    if (spline == 1 && temp == 16 && vert_num == 2)
-                        quit = 1;
-                    break;
-                case 0:
-                    break;
-                default:
-                    s = fgets(buffer2, 1024, fdxf);
-                    assert(s);
-                    break;
-                }
-            } while (code != 0);
-            if (color <= 0 || color > 1000) color = 1;
-            if (vert_num == 1)
+            if (code == 10)
             {
-                xstart = x2;
-                ystart = y2;
+                x = ParseDouble(value);
             }
-            if (vert_num == 2 && !quit)
+            else if (code == 20)
             {
-                vert_num = 1;
-                x1       = x2;
-                y1       = y2;
+                y = ParseDouble(value);
             }
-            else
-            {
-                x1 = x2;
-                y1 = y2;
-            }
-            double *c = new double[2];
-            c[0]      = x2;
-            c[1]      = y2;
-            aline->AddItem(c);
         }
-        else
-        {
-            do
-            {
-                test = ReadValue(fdxf, &code);
-                switch (code)
-                {
-                case 8: /*----- layer name -----*/
-                    s = fgets(buffer2, 1024, fdxf);
-                    assert(s);
-                    color = get_layer(buffer2);
-                    if (color <= 0) color = 1;
-                    break;
-                case 0:
-                    break;
-                default:
-                    s = fgets(buffer2, 1024, fdxf);
-                    assert(s);
-                    break;
-                }
-            } while (code != 0);
-            if (color <= 0 || color > 1000) color = 1;
-            if (closed)
-            {
-                double *c = new double[2];
-                c[0]      = x2;
-                c[1]      = y2;
-                aline->AddItem(c);
-            }
-            return;
-        }
-    } while (1);
+        m_XCoord.push_back(x);
+        m_YCoord.push_back(y);
+    }
+    if (more && mvUtil::stricmp(value, "seqend") == 0)
+    {
+        more = SkipToNextEntity(code, value);
+    }
+    if (closed && m_XCoord.size() > first)
+    {
+        m_XCoord.push_back(m_XCoord[first]);
+        m_YCoord.push_back(m_YCoord[first]);
+    }
+    EndEntity();
+    return more;
 }
-/*******************************************************************************/
-/*  process_lwpoly     ..... Read critical data about the new lwpoly entity    */
-/*******************************************************************************/
-void mvDxfReader::process_lwpoly(mvLinkList *lines)
-{
-    int    test;
-    int    code;
-    int    temp, spline, quit, closed;
-    int    vert_num, firstone;
-    int    color;
-    double xstart, ystart;
-    double zz;
-    char   buffer2[1024];
-    double x1, y1;
-    double x2, y2;
-    char * s;
 
-    color             = 1;
-    quit              = 0;
-    spline            = 0;
-    closed            = 0;
-    int found         = 0;
-    vert_num          = 1;
-    firstone          = 1;
-
-    mvLinkList *aline = new mvLinkList;
-    lines->AddItem(aline);
-
-    do
+// The vertices of a LWPOLYLINE entity are given by repeated 10 and 20
+// group codes
+int mvDxfReader::ReadLwPolylineEntity(int &code, char *&value)
+{
+    int    closed = 0;
+    double x      = 0;
+    int    more;
+    size_t first = m_XCoord.size();
+    while ((more = NextGroup(code, value)) && code != 0)
     {
-        test = ReadValue(fdxf, &code);
-
         switch (code)
         {
-        case 8: /*----- layer name -----*/
-            s = fgets(buffer2, 1024, fdxf);
-            assert(s);
-            color = get_layer(buffer2);
-            break;
-
         case 10:
-            test = ReadValue(fdxf, &x2);
+            x = ParseDouble(value);
             break;
         case 20:
-            test = ReadValue(fdxf, &y2);
-            break;
-        case 30:
-            test  = ReadValue(fdxf, &zz);
-            found = 1;
-            break;
-
-        case 62:
-            test = ReadValue(fdxf, &color);
+            m_XCoord.push_back(x);
+            m_YCoord.push_back(ParseDouble(value));
             break;
-
         case 70:
-            test = ReadValue(fdxf, &temp); /*-- Check for Splines --*/
-            if (temp == 4) spline = 1;
-            if (temp == 1) closed = 1;
-            break;
-
-        case 0:
-            break;
-        default:
-            s = fgets(buffer2, 1024, fdxf);
-            assert(s);
+            closed = (ParseInt(value) == 1);
             break;
         }
-        if (code == 20)
-        { // Got the Y coordinate, write out line?
-            if (firstone == 1)
-            {
-                firstone = 0;
-                xstart   = x2;
-                ystart   = y2;
-                x1       = x2;
-                y1       = y2;
-            }
-            else if (!firstone && !quit)
-            {
-                x1 = x2;
-                y1 = y2;
-            }
-            double *c = new double[2];
-            c[0]      = x2;
-            c[1]      = y2;
-            aline->AddItem(c);
-        }
-    } while (code != 0);
-
-    if (closed)
+    }
+    if (closed && m_XCoord.size() > first)
     {
-        double *c = new double[2];
-        c[0]      = xstart;
-        c[1]      = ystart;
-        aline->AddItem(c);
+        m_XCoord.push_back(m_XCoord[first]);
+        m_YCoord.push_back(m_YCoord[first]);
     }
+    EndEntity();
+    return more;
 }
-/***********************************************************************/
-/*  process_text      ..... Read critical data about the text entity   */
-/***********************************************************************/
-void mvDxfReader::process_text(void)
-{
-    int    test;
-    int    code;
-    int    color;
-    int    symbol;
-    double angle;
-    double height;
-    char   buffer2[1024];
-    double x1, y1;
-    char * s;
-
-    angle  = 0.0;
-    symbol = -1;
-    color  = 1;
 
-    do
-    {
-        test = ReadValue(fdxf, &code);
-
-        switch (code)
-        {
-        case 8: /*----- layer name -----*/
-            s = fgets(buffer2, 1024, fdxf);
-            assert(s);
-            color = get_layer(buffer2);
-            break;
-        case 10:
-            test = ReadValue(fdxf, &x1);
-            break;
-        case 20:
-            test = ReadValue(fdxf, &y1);
-            break;
-        case 50:
-            test = ReadValue(fdxf, &angle);
-            break;
-        case 40:
-            test = ReadValue(fdxf, &height);
-            break;
-        case 62:
-            test = ReadValue(fdxf, &color);
-            break;
-        case 1:
-            s = fgets(buffer2, 1024, fdxf);
-            assert(s);
-            break;
-        case 0:
-            break;
-        default:
-            s = fgets(buffer2, 1024, fdxf);
-            assert(s);
-            break;
-        }
-    } while (code != 0);
-}
-/***********************************************************************/
-/*  process_circle  ..... Read critical data about the circle entity   */
-/***********************************************************************/
-void mvDxfReader::process_circle(mvLinkList *lines)
+int mvDxfReader::ReadCircleEntity(int &code, char *&value)
 {
-    int    test;
-    int    code;
-    int    color;
-    int    i;
-    double angle;
-    double cx, cy;
-    double radius;
-    char   buffer2[1024];
-    double x1, y1;
-    double x2, y2;
-    char * s;
-
-    radius = 0.0;
-    angle  = 0.0;
-    cx = cy           = 0.0;
-    color             = 1;
-
-    mvLinkList *aline = new mvLinkList;
-    lines->AddItem(aline);
-
-    do
+    double cx = 0, cy = 0;
+    double radius = 0;
+    int    more;
+    while ((more = NextGroup(code, value)) && code != 0)
     {
-        test = ReadValue(fdxf, &code);
-
         switch (code)
         {
-        case 8: /*----- layer name -----*/
-            s = fgets(buffer2, 1024, fdxf);
-            assert(s);
-            color = get_layer(buffer2);
-            break;
         case 10:
-            test = ReadValue(fdxf, &cx);
+            cx = ParseDouble(value);
             break;
         case 20:
-            test = ReadValue(fdxf, &cy);
+            cy = ParseDouble(value);
             break;
         case 40:
-            test = ReadValue(fdxf, &radius);
-            break;
-        case 62:
-            test = ReadValue(fdxf, &color);
-            break;
-        case 0:
-            break;
-        default:
-            s = fgets(buffer2, 1024, fdxf);
-            assert(s);
+            radius = ParseDouble(value);
             break;
         }
-    } while (code != 0);
-
-    if (radius == 0.0) return;
-    x1 = cx + (radius * cos(angle));
-    y1 = cy + (radius * sin(angle));
-    for (i = 0; i < 20; i++)
+    }
+    if (radius > 0.0)
     {
-        angle += 0.34906585; /*----- 1/20 degree in radians -----*/
-        x2        = cx + (radius * cos(angle));
-        y2        = cy + (radius * sin(angle));
-        double *c = new double[2];
-        c[0]      = x2;
-        c[1]      = y2;
-        aline->AddItem(c);
-        x1 = x2;
-        y1 = y2;
+        AddArc(cx, cy, radius, 0.0, 2.0 * PI);
     }
+    return more;
 }
-/***********************************************************************/
-/*  process_arc        ..... Read critical data about the arc entity   */
-/***********************************************************************/
-void mvDxfReader::process_arc(mvLinkList *lines)
-{
-    int    test;
-    int    code;
-    int    color;
-    int    num, i;
-    double cx, cy;
-    double radius;
-    double radians, t360, t2;
-    double astart, aend;
-    double angle;
-    char   buffer2[1024];
-    double x1, y1;
-    double x2, y2;
-    char * s;
 
-    radius = 0.0;
-    aend = astart = 0.0;
-    angle         = 0.0;
-    cx = cy           = 0.0;
-    color             = 1;
-    t2                = 2.0;
-    t360              = 360.0;
-    radians           = (PI * t2) / t360;
-
-    mvLinkList *aline = new mvLinkList;
-    lines->AddItem(aline);
-
-    do
+int mvDxfReader::ReadArcEntity(int &code, char *&value)
+{
+    double cx = 0, cy = 0;
+    double radius = 0;
+    double astart = 0, aend = 0;
+    int    more;
+    while ((more = NextGroup(code, value)) && code != 0)
     {
-        test = ReadValue(fdxf, &code);
-
         switch (code)
         {
-        case 8: /*----- layer name -----*/
-            s = fgets(buffer2, 1024, fdxf);
-            assert(s);
-            color = get_layer(buffer2);
-            break;
         case 10:
-            test = ReadValue(fdxf, &cx);
+            cx = ParseDouble(value);
             break;
         case 20:
-            test = ReadValue(fdxf, &cy);
+            cy = ParseDouble(value);
             break;
         case 40:
-            test = ReadValue(fdxf, &radius);
+            radius = ParseDouble(value);
             break;
         case 50:
-            test = ReadValue(fdxf, &astart);
+            astart = ParseDouble(value);
             break;
         case 51:
-            test = ReadValue(fdxf, &aend);
-            break;
-        case 62:
-            test = ReadValue(fdxf, &color);
-            break;
-        case 0:
-            break;
-        default:
-            s = fgets(buffer2, 1024, fdxf);
-            assert(s);
+            aend = ParseDouble(value);
             break;
         }
-    } while (code != 0);
+    }
 
-    if (radius == 0.0) return;
-    if (aend == astart) return;
+    if (radius == 0.0) return more;
+    if (aend == astart) return more;
 
     if (aend == 0.0) aend = 360.0;
     if (astart > aend)
@@ -960,78 +616,7 @@ void mvDxfReader::process_arc(mvLinkList *lines)
         aend += 360.0;
     }
 
-    num = (int)(fabs(astart - aend) / 20.0);
-    if (num < 5) num = 5;
-    angle = fabs(astart - aend) / ((double)num);
-    astart *= radians;
-    angle *= radians;
-    x1 = cx + (radius * cos(astart));
-    y1 = cy + (radius * sin(astart));
-    if (color <= 0 || color > 1000) color = 1;
-    for (i = 0; i < num; i++)
-    {
-        astart += angle; /*----- 1/20 degree in radians -----*/
-        x2        = cx + (radius * cos(astart));
-        y2        = cy + (radius * sin(astart));
-        double *c = new double[2];
-        c[0]      = x2;
-        c[1]      = y2;
-        aline->AddItem(c);
-    }
-}
-/***********************************************************************/
-/*  process_none      ..... Read critical data about the unknown entity*/
-/***********************************************************************/
-void mvDxfReader::process_none(void)
-{
-    int  test;
-    int  code;
-    char buffer3[275];
-    char *s;
-
-    do
-    {
-        test = ReadValue(fdxf, &code);
-        switch (code)
-        {
-        case 0:
-            break;
-        default:
-            s = fgets(buffer3, 274, fdxf);
-            assert(s);
-            break;
-        }
-    } while (code != 0);
-}
-
-int mvDxfReader::ReadValue(FILE *f1, int *ival)
-{
-    char field[80];
-    if (!fgets(field, 80, f1))
-    {
-        return 0;
-    }
-    // Replace the last character, which should be the line feed character,
-    // by the null character
-    field[strlen(field) - 1] = '\0';
-    mvUtil::TrimLeft(field);
-    mvUtil::TrimRight(field);
-    *ival = atoi(field);
-    return 1;
-}
-
-int mvDxfReader::ReadValue(FILE *f1, double *val)
-{
-    char field[80];
-    if (!fgets(field, 80, f1))
-    {
-        return 0;
-    }
-    // Replace the last character, which should be the line feed character,
-    // by the null character
-    field[strlen(field) - 1] = '\0';
-    mvUtil::TrimLeft(field);
-    mvUtil::TrimRight(field);
-    *val = atof(field);
-    return 1;
+    double radians = (PI * 2.0) / 360.0;
+    AddArc(cx, cy, radius, astart * radians, (aend - astart) * radians);
+    return more;
 }
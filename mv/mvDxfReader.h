@@ -3,9 +3,14 @@
 
 #include "mvHeader.h"
 #include <stdio.h>
+#include <vector>
 
-class mvLinkList;
-
+/**
+ * Reads the lines and polylines of an ASCII DXF file as polylines, and
+ * its circles and arcs as arcs, which are tessellated by the caller. The
+ * file is read in one pass through a large buffer, and the coordinates
+ * of all entities are kept in one array.
+ */
 class MV_EXPORT mvDxfReader
 {
 public:
@@ -17,34 +22,47 @@ public:
     int  GetNumberOfEntities();
     int  GetNumberOfVerticesInEntity(int i);
     int  GetCoordinates(int entity, int vertex, double &x, double &y);
+    int  GetNumberOfArcs();
+    /**
+     * Gets the center and radius of an arc, and its start angle and
+     * counterclockwise sweep in radians. The sweep of a circle is 2 pi.
+     */
+    int  GetArc(int i, double &cx, double &cy, double &radius, double &start, double &sweep);
 
 protected:
-    char    *m_FileName;
-    double **m_XCoord;
-    double **m_YCoord;
-    int     *m_NumberOfVerticesInEntity;
-    int      m_NumberOfEntities;
-
-    void     ClearData();
-
-    FILE    *fdxf;
-    char   **layer_name;
-    int     *layer_color;
-
-    int      num_layers;
-
-    int      find_entity(void);
-    void     get_layer_info(void);
-    int      get_layer(char *lname);
-    void     process_line(mvLinkList *lines);
-    void     process_poly(mvLinkList *lines);
-    void     process_lwpoly(mvLinkList *lines);
-    void     process_text(void);
-    void     process_circle(mvLinkList *lines);
-    void     process_arc(mvLinkList *lines);
-    void     process_none(void);
-    int      ReadValue(FILE *f1, int *ival);
-    int      ReadValue(FILE *f1, double *val);
+    char               *m_FileName;
+    // Vertex j of entity i is at m_VertexOffset[i] + j
+    std::vector<double> m_XCoord;
+    std::vector<double> m_YCoord;
+    std::vector<int>    m_VertexOffset;
+    // Center x, center y, radius, start and sweep of each arc
+    std::vector<double> m_Arcs;
+
+    void                ClearData();
+    void                EndEntity();
+    void                AddArc(double cx, double cy, double radius, double start, double sweep);
+
+    // The file is read into m_Buffer. The unread part of the buffer is
+    // from m_Next to m_End.
+    FILE               *m_File;
+    char               *m_Buffer;
+    size_t              m_BufferSize;
+    char               *m_Next;
+    char               *m_End;
+    int                 m_EndOfFile;
+
+    int                 NextLine(char *&line);
+    int                 NextGroup(int &code, char *&value);
+    // Each of these reads the group codes and values up to the next group
+    // code 0, which is left in code and value. They return 0 at the end of
+    // the file.
+    int                 ReadUcsOrigin(int &code, char *&value, double &x, double &y);
+    int                 ReadLineEntity(int &code, char *&value);
+    int                 ReadPolylineEntity(int &code, char *&value);
+    int                 ReadLwPolylineEntity(int &code, char *&value);
+    int                 ReadCircleEntity(int &code, char *&value);
+    int                 ReadArcEntity(int &code, char *&value);
+    int                 SkipToNextEntity(int &code, char *&value);
 };
 
 #endif
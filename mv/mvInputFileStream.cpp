@@ -0,0 +1,422 @@
+#include "mvInputFileStream.h"
+#include "vtk_zlib.h"
+
+#include <algorithm>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER) && defined(_DEBUG) && defined(MV_DEBUG_MEMORY_LEAKS)
+#include <afx.h>
+#define new DEBUG_NEW
+#undef THIS_FILE
+static char THIS_FILE[] = __FILE__;
+#endif
+
+// Uncompressed bytes between restart points. Each point keeps a copy of the
+// 32 KB deflate window, so the index of a 100 GB file takes about 100 MB.
+#define MV_GZIP_SPAN   (32 * 1024 * 1024)
+#define MV_GZIP_WINDOW 32768
+#define MV_GZIP_CHUNK  (256 * 1024)
+
+/**
+ * Stream buffer that inflates a gzip file and supports seeking through an
+ * index of restart points, in the manner of zlib's zran example. The most
+ * recent 32 KB of output is kept in a circular window, which is both the get
+ * area and the dictionary saved with each restart point.
+ */
+class mvGzipStreamBuf : public std::streambuf
+{
+public:
+    mvGzipStreamBuf();
+    ~mvGzipStreamBuf() override;
+
+    bool Open(const char *fileName);
+
+protected:
+    int_type underflow() override;
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override;
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override;
+
+private:
+    struct RestartPoint
+    {
+        long long                  out;  // offset in the uncompressed data
+        long long                  in;   // offset in the file of the first whole byte
+        int                        bits; // bits of the preceding byte that begin the block
+        std::vector<unsigned char> window;
+    };
+
+    std::ifstream              m_File;
+    z_stream                   m_Stream;
+    bool                       m_StreamOpen;
+    std::vector<unsigned char> m_In;
+    unsigned char              m_Window[MV_GZIP_WINDOW];
+    long long                  m_InPos;    // offset in the file of the end of the input read so far
+    long long                  m_GetStart; // uncompressed offset of eback()
+    long long                  m_TotalOut; // uncompressed offset of egptr()
+    long long                  m_Length;   // uncompressed length, or -1 until the end is reached
+    bool                       m_Raw;      // true when inflating raw deflate data after a restart
+    bool                       m_AtEnd;
+    std::vector<RestartPoint>  m_Index;
+
+    bool                       ReadInput();
+    bool                       Fill();
+    void                       AddRestartPoint(long long out);
+    void                       Restart(const RestartPoint *point);
+    const RestartPoint        *FindRestartPoint(long long target) const;
+};
+
+mvGzipStreamBuf::mvGzipStreamBuf()
+{
+    memset(&m_Stream, 0, sizeof(z_stream));
+    m_StreamOpen = false;
+    m_InPos      = 0;
+    m_GetStart   = 0;
+    m_TotalOut   = 0;
+    m_Length     = -1;
+    m_Raw        = false;
+    m_AtEnd      = false;
+}
+
+mvGzipStreamBuf::~mvGzipStreamBuf()
+{
+    if (m_StreamOpen)
+    {
+        inflateEnd(&m_Stream);
+    }
+}
+
+bool mvGzipStreamBuf::Open(const char *fileName)
+{
+    m_File.open(fileName, std::ios::in | std::ios::binary);
+    if (!m_File.is_open())
+    {
+        return false;
+    }
+    // 47 accepts either a gzip or a zlib header
+    if (inflateInit2(&m_Stream, 47) != Z_OK)
+    {
+        return false;
+    }
+    m_StreamOpen = true;
+    m_In.resize(MV_GZIP_CHUNK);
+    m_Stream.next_out  = m_Window;
+    m_Stream.avail_out = MV_GZIP_WINDOW;
+    setg((char *)m_Window, (char *)m_Window, (char *)m_Window);
+    return true;
+}
+
+bool mvGzipStreamBuf::ReadInput()
+{
+    m_File.read((char *)m_In.data(), m_In.size());
+    std::streamsize n  = m_File.gcount();
+    m_InPos           += n;
+    m_Stream.next_in   = m_In.data();
+    m_Stream.avail_in  = (uInt)n;
+    return n > 0;
+}
+
+// Inflates the next piece of the file into the window and makes it the get
+// area. Returns false at the end of the data.
+bool mvGzipStreamBuf::Fill()
+{
+    while (!m_AtEnd)
+    {
+        if (m_Stream.avail_out == 0)
+        {
+            m_Stream.next_out  = m_Window;
+            m_Stream.avail_out = MV_GZIP_WINDOW;
+        }
+        unsigned char *start = m_Stream.next_out;
+        int            ret   = Z_OK;
+        for (;;)
+        {
+            if (m_Stream.avail_in == 0 && !ReadInput())
+            {
+                // truncated file
+                ret = Z_DATA_ERROR;
+                break;
+            }
+            ret = inflate(&m_Stream, Z_BLOCK);
+            if (ret == Z_BUF_ERROR && m_Stream.avail_in == 0)
+            {
+                continue;
+            }
+            if (ret != Z_OK)
+            {
+                break;
+            }
+            // a block boundary, other than the end of the last block, is a restart point
+            if ((m_Stream.data_type & 128) && !(m_Stream.data_type & 64))
+            {
+                AddRestartPoint(m_TotalOut + (m_Stream.next_out - start));
+            }
+            if (m_Stream.next_out != start)
+            {
+                break;
+            }
+        }
+        long long produced = m_Stream.next_out - start;
+        setg((char *)start, (char *)start, (char *)m_Stream.next_out);
+        m_GetStart  = m_TotalOut;
+        m_TotalOut += produced;
+
+        if (ret == Z_STREAM_END)
+        {
+            // Raw inflation leaves the gzip trailer unread
+            if (m_Raw)
+            {
+                for (int i = 0; i < 8; i++)
+                {
+                    if (m_Stream.avail_in == 0 && !ReadInput())
+                    {
+                        break;
+                    }
+                    m_Stream.next_in++;
+                    m_Stream.avail_in--;
+                }
+            }
+            // A file may hold several gzip members one after another
+            if (m_Stream.avail_in == 0)
+            {
+                ReadInput();
+            }
+            if (m_Stream.avail_in > 0 && m_Stream.next_in[0] == 0x1f)
+            {
+                inflateReset2(&m_Stream, 31);
+                m_Raw = false;
+            }
+            else
+            {
+                m_AtEnd  = true;
+                m_Length = m_TotalOut;
+            }
+        }
+        else if (ret != Z_OK)
+        {
+            // treat corrupt or truncated data as the end of the file
+            m_AtEnd  = true;
+            m_Length = m_TotalOut;
+        }
+        if (produced > 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void mvGzipStreamBuf::AddRestartPoint(long long out)
+{
+    long long last = m_Index.empty() ? 0 : m_Index.back().out;
+    if (out - last < MV_GZIP_SPAN)
+    {
+        return;
+    }
+    RestartPoint point;
+    point.out  = out;
+    point.in   = m_InPos - m_Stream.avail_in;
+    point.bits = m_Stream.data_type & 7;
+    point.window.resize(MV_GZIP_WINDOW);
+    // the oldest output in the circular window follows next_out
+    unsigned left = m_Stream.avail_out;
+    if (left)
+    {
+        memcpy(point.window.data(), m_Window + MV_GZIP_WINDOW - left, left);
+    }
+    if (left < MV_GZIP_WINDOW)
+    {
+        memcpy(point.window.data() + left, m_Window, MV_GZIP_WINDOW - left);
+    }
+    m_Index.push_back(std::move(point));
+}
+
+const mvGzipStreamBuf::RestartPoint *mvGzipStreamBuf::FindRestartPoint(long long target) const
+{
+    auto it = std::upper_bound(m_Index.begin(), m_Index.end(), target,
+                               [](long long t, const RestartPoint &p) { return t < p.out; });
+    if (it == m_Index.begin())
+    {
+        return nullptr;
+    }
+    return &*(it - 1);
+}
+
+// Positions the inflater at a restart point, or at the start of the file
+// if point is null.
+void mvGzipStreamBuf::Restart(const RestartPoint *point)
+{
+    m_File.clear();
+    m_Stream.avail_in = 0;
+    if (point == nullptr)
+    {
+        m_File.seekg(0, std::ios::beg);
+        m_InPos = 0;
+        inflateReset2(&m_Stream, 47);
+        m_Raw      = false;
+        m_TotalOut = 0;
+    }
+    else
+    {
+        m_InPos = point->in - (point->bits ? 1 : 0);
+        m_File.seekg(m_InPos, std::ios::beg);
+        inflateReset2(&m_Stream, -15);
+        if (point->bits && ReadInput())
+        {
+            int ch = m_Stream.next_in[0];
+            m_Stream.next_in++;
+            m_Stream.avail_in--;
+            inflatePrime(&m_Stream, point->bits, ch >> (8 - point->bits));
+        }
+        inflateSetDictionary(&m_Stream, point->window.data(), MV_GZIP_WINDOW);
+        m_Raw      = true;
+        m_TotalOut = point->out;
+    }
+    m_Stream.next_out  = m_Window;
+    m_Stream.avail_out = MV_GZIP_WINDOW;
+    m_GetStart         = m_TotalOut;
+    m_AtEnd            = false;
+    setg((char *)m_Window, (char *)m_Window, (char *)m_Window);
+}
+
+mvGzipStreamBuf::int_type mvGzipStreamBuf::underflow()
+{
+    if (gptr() < egptr() || Fill())
+    {
+        return traits_type::to_int_type(*gptr());
+    }
+    return traits_type::eof();
+}
+
+mvGzipStreamBuf::pos_type mvGzipStreamBuf::seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which)
+{
+    long long target;
+    if (dir == std::ios_base::beg)
+    {
+        target = off;
+    }
+    else if (dir == std::ios_base::cur)
+    {
+        target = m_GetStart + (gptr() - eback()) + off;
+    }
+    else
+    {
+        // The length is only known after inflating the whole file, which
+        // also records the restart points.
+        while (m_Length < 0 && Fill())
+        {
+        }
+        target = m_Length + off;
+    }
+    return seekpos(pos_type(off_type(target)), which);
+}
+
+mvGzipStreamBuf::pos_type mvGzipStreamBuf::seekpos(pos_type pos, std::ios_base::openmode which)
+{
+    long long target = off_type(pos);
+    if (!(which & std::ios_base::in) || target < 0 || (m_Length >= 0 && target > m_Length))
+    {
+        return pos_type(off_type(-1));
+    }
+    if (target < m_GetStart || target > m_TotalOut)
+    {
+        // Restart if the target is behind, or if a restart point lies between
+        // the current position and the target.
+        const RestartPoint *point = FindRestartPoint(target);
+        if (target < m_GetStart || (point != nullptr && point->out > m_TotalOut))
+        {
+            Restart(point);
+        }
+        while (m_TotalOut < target)
+        {
+            if (!Fill())
+            {
+                return pos_type(off_type(-1));
+            }
+        }
+    }
+    setg(eback(), eback() + (target - m_GetStart), egptr());
+    return pos;
+}
+
+mvInputFileStream::mvInputFileStream()
+    : std::istream(nullptr)
+{
+    m_GzipBuf = nullptr;
+}
+
+mvInputFileStream::~mvInputFileStream()
+{
+    close();
+}
+
+void mvInputFileStream::open(const char *fileName, std::ios_base::openmode mode)
+{
+    close();
+    unsigned char magic[2] = {0, 0};
+    {
+        std::ifstream in(fileName, std::ios::in | std::ios::binary);
+        if (!in.is_open())
+        {
+            setstate(std::ios_base::failbit);
+            return;
+        }
+        in.read((char *)magic, 2);
+    }
+    if (magic[0] == 0x1f && magic[1] == 0x8b)
+    {
+        m_GzipBuf = new mvGzipStreamBuf;
+        if (!m_GzipBuf->Open(fileName))
+        {
+            delete m_GzipBuf;
+            m_GzipBuf = nullptr;
+            setstate(std::ios_base::failbit);
+            return;
+        }
+        rdbuf(m_GzipBuf);
+    }
+    else
+    {
+        if (!m_FileBuf.open(fileName, mode | std::ios_base::binary))
+        {
+            setstate(std::ios_base::failbit);
+            return;
+        }
+        rdbuf(&m_FileBuf);
+    }
+}
+
+void mvInputFileStream::close()
+{
+    rdbuf(nullptr);
+    if (m_GzipBuf)
+    {
+        delete m_GzipBuf;
+        m_GzipBuf = nullptr;
+    }
+    if (m_FileBuf.is_open())
+    {
+        m_FileBuf.close();
+    }
+}
+
+bool mvInputFileStream::is_open() const
+{
+    return m_GzipBuf != nullptr || m_FileBuf.is_open();
+}
+
+void mvInputFileStream::ResolveCompressedFileName(char *fileName, size_t size)
+{
+    std::ifstream in(fileName, std::ios::in | std::ios::binary);
+    if (in.is_open())
+    {
+        return;
+    }
+    std::string   compressed = std::string(fileName) + ".gz";
+    std::ifstream inCompressed(compressed.c_str(), std::ios::in | std::ios::binary);
+    if (inCompressed.is_open() && compressed.size() < size)
+    {
+        strcpy(fileName, compressed.c_str());
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef __mvInputFileStream_h
+#define __mvInputFileStream_h
+
+#include "mvHeader.h"
+
+#include <fstream>
+#include <istream>
+
+class mvGzipStreamBuf;
+
+/**
+ * A binary input stream that reads either a plain file or a gzip-compressed
+ * file, detected from the first two bytes. It has the subset of the
+ * std::ifstream interface used by the data sources, so a compressed head or
+ * budget file can be read with the same read, seekg and tellg calls.
+ *
+ * Seeking in a compressed file resumes decompression from the nearest
+ * restart point. Restart points are recorded as the file is decompressed, so
+ * once the file has been scanned (for example by seeking to its end) a jump
+ * to any time step only decompresses the part of the file near the target.
+ */
+class MV_EXPORT mvInputFileStream : public std::istream
+{
+public:
+    mvInputFileStream();
+    ~mvInputFileStream() override;
+
+    void        open(const char *fileName, std::ios_base::openmode mode = std::ios_base::in | std::ios_base::binary);
+    void        close();
+    bool        is_open() const;
+    bool        IsCompressed() const { return m_GzipBuf != nullptr; }
+
+    /**
+     * If fileName does not exist but a gzip-compressed copy named fileName.gz
+     * does, changes fileName (a buffer of the given size) to name the copy.
+     */
+    static void ResolveCompressedFileName(char *fileName, size_t size);
+
+protected:
+    std::filebuf     m_FileBuf;
+    mvGzipStreamBuf *m_GzipBuf;
+};
+
+#endif
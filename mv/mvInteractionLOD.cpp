@@ -0,0 +1,170 @@
+#include "mvInteractionLOD.h"
+#include "vtkActor.h"
+#include "vtkDataSetMapper.h"
+#include "vtkGeometryFilter.h"
+#include "vtkPolyData.h"
+#include "vtkPolyDataMapper.h"
+#include "vtkQuadricClustering.h"
+
+// This must be below vtkStandardNewMacro
+#if defined(_MSC_VER) && defined(_DEBUG) && defined(MV_DEBUG_MEMORY_LEAKS)
+#include <afx.h>
+#define new DEBUG_NEW
+#undef THIS_FILE
+static char THIS_FILE[] = __FILE__;
+#endif
+
+// Inputs with fewer cells than this are drawn at full resolution
+// during interaction
+#define MV_LOD_MIN_CELLS 100000
+
+// Number of clustering bins along the longest side of the bounds
+#define MV_LOD_DIVISIONS 128
+
+static vtkSmartPointer<vtkPolyData> Decimate(vtkSmartPointer<vtkDataSet> input)
+{
+    // This runs in a worker thread, on a copy of the input that is
+    // not connected to any pipeline.
+    vtkSmartPointer<vtkPolyData> polyData = vtkPolyData::SafeDownCast(input);
+    if (polyData == nullptr)
+    {
+        // the input of a data set mapper; only its surface is drawn
+        vtkSmartPointer<vtkGeometryFilter> geometry = vtkSmartPointer<vtkGeometryFilter>::New();
+        geometry->SetInputData(input);
+        geometry->Update();
+        polyData = geometry->GetOutput();
+    }
+    vtkSmartPointer<vtkQuadricClustering> cluster = vtkSmartPointer<vtkQuadricClustering>::New();
+    cluster->SetInputData(polyData);
+    cluster->AutoAdjustNumberOfDivisionsOn();
+    cluster->SetNumberOfDivisions(MV_LOD_DIVISIONS, MV_LOD_DIVISIONS, MV_LOD_DIVISIONS);
+    // Use input points so that point scalars are carried over
+    cluster->UseInputPointsOn();
+    cluster->CopyCellDataOn();
+    cluster->Update();
+    vtkSmartPointer<vtkPolyData> output = cluster->GetOutput();
+    return output;
+}
+
+mvInteractionLOD::mvInteractionLOD(vtkActor *actor)
+{
+    m_Actor         = actor;
+    m_LODMapper     = vtkSmartPointer<vtkPolyDataMapper>::New();
+    m_SourceMapper  = nullptr;
+    m_SourceTime    = 0;
+    m_PendingMapper = nullptr;
+    m_PendingTime   = 0;
+}
+
+mvInteractionLOD::~mvInteractionLOD()
+{
+    EndInteraction();
+    if (m_Pending.valid())
+    {
+        m_Pending.wait();
+    }
+}
+
+void mvInteractionLOD::CollectPending(bool wait)
+{
+    if (!m_Pending.valid())
+    {
+        return;
+    }
+    if (!wait && m_Pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+    {
+        return;
+    }
+    m_LODPolyData  = m_Pending.get();
+    m_SourceMapper = m_PendingMapper;
+    m_SourceTime   = m_PendingTime;
+}
+
+// Returns the input of a mapper that draws the surface of its input,
+// or null for other mappers
+static vtkDataSet *GetInput(vtkMapper *mapper)
+{
+    if (vtkPolyDataMapper::SafeDownCast(mapper) || vtkDataSetMapper::SafeDownCast(mapper))
+    {
+        return mapper->GetInput();
+    }
+    return nullptr;
+}
+
+void mvInteractionLOD::Refresh()
+{
+    if (m_FullMapper)
+    {
+        // interacting
+        return;
+    }
+    CollectPending(false);
+    if (m_Pending.valid())
+    {
+        // the previous copy is still being computed
+        return;
+    }
+
+    vtkMapper *mapper = m_Actor->GetMapper();
+    if (mapper == nullptr || !m_Actor->GetVisibility())
+    {
+        return;
+    }
+    vtkDataSet *input = GetInput(mapper);
+    if (input == nullptr || input->GetNumberOfCells() < MV_LOD_MIN_CELLS)
+    {
+        m_LODPolyData  = nullptr;
+        m_SourceMapper = nullptr;
+        return;
+    }
+    if (mapper == m_SourceMapper && input->GetMTime() == m_SourceTime)
+    {
+        return;
+    }
+
+    // The worker gets its own copy because the pipeline may modify
+    // the input while the copy is being decimated.
+    vtkSmartPointer<vtkDataSet> copy;
+    copy.TakeReference(input->NewInstance());
+    copy->DeepCopy(input);
+    m_PendingMapper = mapper;
+    m_PendingTime   = input->GetMTime();
+    m_Pending       = std::async(std::launch::async, Decimate, copy);
+}
+
+void mvInteractionLOD::BeginInteraction()
+{
+    if (m_FullMapper)
+    {
+        return;
+    }
+    CollectPending(false);
+
+    vtkMapper *mapper = m_Actor->GetMapper();
+    if (mapper == nullptr || m_LODPolyData == nullptr || mapper != m_SourceMapper)
+    {
+        return;
+    }
+    vtkDataSet *input = GetInput(mapper);
+    if (input == nullptr || input->GetMTime() != m_SourceTime)
+    {
+        // the coarse copy is out of date
+        return;
+    }
+
+    // ShallowCopy carries over the lookup table, scalar range and scalar
+    // mode, also from a data set mapper
+    m_LODMapper->ShallowCopy(mapper);
+    m_LODMapper->SetInputData(m_LODPolyData);
+    m_FullMapper = mapper;
+    m_Actor->SetMapper(m_LODMapper);
+}
+
+void mvInteractionLOD::EndInteraction()
+{
+    if (m_FullMapper)
+    {
+        m_Actor->SetMapper(m_FullMapper);
+        m_FullMapper = nullptr;
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef __mvInteractionLOD_h
+#define __mvInteractionLOD_h
+
+#include "mvHeader.h"
+#include "vtkSmartPointer.h"
+#include "vtkType.h"
+
+#include <chrono>
+#include <future>
+
+class vtkActor;
+class vtkMapper;
+class vtkPolyData;
+class vtkPolyDataMapper;
+
+/**
+ * Maintains a coarse copy of the polygons drawn by an actor, to be drawn
+ * while the user rotates or zooms the view. The coarse copy is made by
+ * quadric clustering in a background thread whenever the input to the
+ * actor's mapper has changed. BeginInteraction puts a mapper for the coarse
+ * copy on the actor, and EndInteraction restores the full resolution mapper.
+ * The input of a data set mapper is reduced to its surface before it is
+ * coarsened. Actors with other mappers, such as glyph mappers, or with
+ * small inputs, are left alone.
+ */
+class MV_EXPORT mvInteractionLOD
+{
+public:
+    mvInteractionLOD(vtkActor *actor);
+    ~mvInteractionLOD();
+
+    /**
+     * Starts computing a new coarse copy if the mapper input has changed.
+     * Call after a full resolution render, when the input is up to date.
+     */
+    void Refresh();
+    void BeginInteraction();
+    void EndInteraction();
+
+protected:
+    vtkActor                                 *m_Actor;
+    vtkSmartPointer<vtkMapper>                m_FullMapper;
+    vtkSmartPointer<vtkPolyDataMapper>        m_LODMapper;
+
+    // The coarse copy, and the mapper and input time it was computed for
+    vtkSmartPointer<vtkPolyData>              m_LODPolyData;
+    vtkMapper                                *m_SourceMapper;
+    vtkMTimeType                              m_SourceTime;
+
+    // The coarse copy being computed in the background
+    std::future<vtkSmartPointer<vtkPolyData>> m_Pending;
+    vtkMapper                                *m_PendingMapper;
+    vtkMTimeType                              m_PendingTime;
+
+    void                                      CollectPending(bool wait);
+};
+
+#endif
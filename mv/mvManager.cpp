@@ -12,11 +12,13 @@
 #include "mvGridShell.h"
 #include "mvGUISettings.h"
 #include "mvHashTable.h"
+#include "mvInteractionLOD.h"
 #include "mvLogColorTable.h"
 #include "mvModelFeatures.h"
 #include "mvModelList.h"
 #include "mvOverlay.h"
 #include "mvPathlines.h"
+#include "mvPointBinSampler.h"
 #include "mvSaveCurrentDirectory.h"
 #include "mvUtil.h"
 
@@ -34,15 +36,13 @@
 #include "vtkExtractCells.h"
 #include "vtkExtractGeometry.h"
 #include "vtkExtractGrid.h"
+#include "vtkFloatArray.h"
 #include "vtkGeometryFilter.h"
-#include "vtkGlyph3D.h"
+#include "vtkGlyph3DMapper.h"
 #include "vtkHedgeHog.h"
-#include "vtkHexagonalPrism.h"
-#include "vtkHexahedron.h"
 #include "vtkLogLookupTable.h"
 #include "vtkLookupTable.h"
 #include "vtkMaskPoints.h"
-#include "vtkPentagonalPrism.h"
 #include "vtkPlane.h"
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
@@ -54,8 +54,9 @@
 #include "vtkTextProperty.h"
 #include "vtkThreshold.h"
 #include "vtkThresholdPoints.h"
+#include "vtkTypeInt32Array.h"
+#include "vtkUnsignedCharArray.h"
 #include "vtkUnstructuredGrid.h"
-#include "vtkWedge.h"
 
 #include "mvDefine.h"
 
@@ -64,6 +65,7 @@
 #endif
 
 #include <sstream>
+#include <vector>
 
 using std::log;
 using std::ofstream;
@@ -87,6 +89,108 @@ constexpr auto MAX_PATH = 4096;
 #define VERIFY(f) ((void)(f))
 #endif
 
+// Sets the coordinates of points from an array of x-y-z triples owned by the
+// data source. If toFloat is nonzero, the coordinates are copied to a single
+// precision array, otherwise the data source array is used without copying.
+// The coordinates are relative to the model origin, so single precision is
+// adequate for display.
+static void SetPointCoordinates(vtkPoints *points, double *coordinates, int numPoints, int toFloat)
+{
+    if (toFloat)
+    {
+        vtkSmartPointer<vtkFloatArray> floatArray = vtkSmartPointer<vtkFloatArray>::New();
+        floatArray->SetNumberOfComponents(3);
+        floatArray->SetNumberOfTuples(numPoints);
+        float *f = floatArray->GetPointer(0);
+        for (int i = 0; i < 3 * numPoints; i++)
+        {
+            f[i] = static_cast<float>(coordinates[i]);
+        }
+        points->SetDataTypeToFloat();
+        points->SetData(floatArray);
+    }
+    else
+    {
+        vtkSmartPointer<vtkDoubleArray> doubleArray = vtkSmartPointer<vtkDoubleArray>::New();
+        doubleArray->SetNumberOfComponents(3);
+        doubleArray->SetArray(coordinates, 3 * numPoints, 1);
+        points->SetDataTypeToDouble();
+        points->SetData(doubleArray);
+    }
+}
+
+// Sets the cells of an unstructured grid from a connectivity array in which
+// the number of points of each cell precedes the point ids of the cell.
+// Cells with no points (inactive cells) are skipped. The offsets and
+// connectivity are filled directly and handed to the vtkCellArray, rather
+// than creating a vtkCell for each cell. Because the point count is
+// interleaved with the point ids, the data source array cannot be used as is.
+static void SetCellsFromConnectivity(vtkUnstructuredGrid *grid, const int *connectivity, int numCells)
+{
+    // count the active cells and the total number of point ids
+    int numActive = 0;
+    int size      = 0;
+    int k         = 0;
+    for (int i = 0; i < numCells; i++)
+    {
+        int nvert = connectivity[k++];
+        if (nvert > 0)
+        {
+            numActive++;
+            size += nvert;
+            k += nvert;
+        }
+    }
+
+    vtkSmartPointer<vtkTypeInt32Array>    offsets   = vtkSmartPointer<vtkTypeInt32Array>::New();
+    vtkSmartPointer<vtkTypeInt32Array>    conn      = vtkSmartPointer<vtkTypeInt32Array>::New();
+    vtkSmartPointer<vtkUnsignedCharArray> cellTypes = vtkSmartPointer<vtkUnsignedCharArray>::New();
+    offsets->SetNumberOfValues(numActive + 1);
+    conn->SetNumberOfValues(size);
+    cellTypes->SetNumberOfValues(numActive);
+    int           *pOffsets = offsets->GetPointer(0);
+    int           *pConn    = conn->GetPointer(0);
+    unsigned char *pTypes   = cellTypes->GetPointer(0);
+
+    int n = 0;
+    int m = 0;
+    k     = 0;
+    for (int i = 0; i < numCells; i++)
+    {
+        int nvert = connectivity[k++];
+        if (nvert <= 0)
+        {
+            continue;
+        }
+        switch (nvert)
+        {
+        case 6:
+            pTypes[n] = VTK_WEDGE;
+            break;
+        case 8:
+            pTypes[n] = VTK_HEXAHEDRON;
+            break;
+        case 10:
+            pTypes[n] = VTK_PENTAGONAL_PRISM;
+            break;
+        case 12:
+            pTypes[n] = VTK_HEXAGONAL_PRISM;
+            break;
+        default:
+            pTypes[n] = VTK_CONVEX_POINT_SET;
+        }
+        pOffsets[n++] = m;
+        memcpy(pConn + m, connectivity + k, nvert * sizeof(int));
+        m += nvert;
+        k += nvert;
+    }
+    pOffsets[n] = m;
+
+    vtkSmartPointer<vtkCellArray> cellArray = vtkSmartPointer<vtkCellArray>::New();
+    cellArray->SetData(offsets, conn);
+    grid->SetCells(cellTypes, cellArray);
+}
+
 mvManager::mvManager()
     : m_ColorBarDataSource{0}
 {
@@ -97,6 +201,10 @@ mvManager::mvManager()
     m_PathlineTimeClippingMode   = 0;
     m_ShowCroppedAwayPieces      = 0;
     m_TimePointIndex             = 0;
+    for (int i = 0; i < 6; i++)
+    {
+        m_ScalarSubgridExtent[i] = 0;
+    }
     m_VectorGlyphActivated       = 0;
     m_CropAngle                  = 0;
     m_PathlineClipTimeMax        = 0;
@@ -110,6 +218,13 @@ mvManager::mvManager()
     m_VectorSubsampleOffset[0]   = 0;
     m_VectorSubsampleOffset[1]   = 0;
     m_VectorSubsampleOffset[2]   = 0;
+    m_VectorScreenSpacing        = 10;
+    m_VectorWorldUnitsPerPixel   = 0;
+    m_SinglePrecision            = 0;
+    m_UpdateDepth                = 0;
+    m_UpdateRequests             = 0;
+    m_PendingSolidPipeline       = 0;
+    m_PendingIsosurfacePipeline  = 0;
     m_CropBounds[0]              = 0;
     m_CropBounds[1]              = 1;
     m_CropBounds[2]              = 0;
@@ -200,28 +315,13 @@ mvManager::mvManager()
     dynamic_cast<mvColorTable *>(m_LutReversedCustomScale)->SetLastCustomColor(0xf0f0f0);
     dynamic_cast<mvColorTable *>(m_LutReversedCustomScale)->SetReversedCustomColorScheme();
 
-    // Log Lookup tables
-    // Despite appearances to the contrary, the reversed color scheme is correct for
-    // m_LogLutBlueToRed and the unreversed color scheme is correct for m_LogLutRedToBlue
-    m_LogLutBlueToRed = mvLogColorTable::New();
-    dynamic_cast<mvLogColorTable *>(m_LogLutBlueToRed)->SetReversedDefaultColorScheme();
-    m_LogLutRedToBlue = mvLogColorTable::New();
-    dynamic_cast<mvLogColorTable *>(m_LogLutRedToBlue)->SetDefaultColorScheme();
-
-    m_LogLutModifiedBlueToRed = mvLogColorTable::New();
-    dynamic_cast<mvLogColorTable *>(m_LogLutModifiedBlueToRed)->SetModifiedColorScheme();
-    m_LogLutModifiedRedToBlue = mvLogColorTable::New();
-    dynamic_cast<mvLogColorTable *>(m_LogLutModifiedRedToBlue)->SetReversedModifiedColorScheme();
-
-    m_LogLutCustomScale = mvLogColorTable::New();
-    dynamic_cast<mvLogColorTable *>(m_LogLutCustomScale)->SetFirstCustomColor(0x5A5A5a);
-    dynamic_cast<mvLogColorTable *>(m_LogLutCustomScale)->SetLastCustomColor(0xf0f0f0);
-    dynamic_cast<mvLogColorTable *>(m_LogLutCustomScale)->SetCustomColorScheme();
-
-    m_LogLutReversedCustomScale = mvLogColorTable::New();
-    dynamic_cast<mvLogColorTable *>(m_LogLutReversedCustomScale)->SetFirstCustomColor(0x5A5A5a);
-    dynamic_cast<mvLogColorTable *>(m_LogLutReversedCustomScale)->SetLastCustomColor(0xf0f0f0);
-    dynamic_cast<mvLogColorTable *>(m_LogLutReversedCustomScale)->SetReversedCustomColorScheme();
+    // The log lookup tables are created when first needed
+    m_LogLutBlueToRed           = 0;
+    m_LogLutRedToBlue           = 0;
+    m_LogLutModifiedBlueToRed   = 0;
+    m_LogLutModifiedRedToBlue   = 0;
+    m_LogLutCustomScale         = 0;
+    m_LogLutReversedCustomScale = 0;
 
     // Solid mapper and actor. Note that input to the solid mapper is
     // determined by the method BuildPipelineForSolid.
@@ -255,9 +355,11 @@ mvManager::mvManager()
     m_Pathlines->SetInputData(m_PathlineDataSet);
 
     // Flow or velocity vectors
-    m_ExtractStructuredGridVector = vtkSmartPointer<vtkExtractGrid>::New();
-    //	m_ExtractUnstructuredGridVector = vtkSmartPointer<vtkMaskPoints>::New();
-    m_CropVectors                 = vtkSmartPointer<vtkExtractGeometry>::New();
+    m_ExtractStructuredGridVector   = vtkSmartPointer<vtkExtractGrid>::New();
+    // Layered and unstructured grids are subsampled by keeping one vector
+    // per bin, with the bin size set from the screen spacing and the zoom
+    m_ExtractUnstructuredGridVector = vtkSmartPointer<mvPointBinSampler>::New();
+    m_CropVectors                   = vtkSmartPointer<vtkExtractGeometry>::New();
     m_CropVectors->ExtractInsideOff();
     m_CropBoxForVectors = mvClipBox::New();
     m_CropVectors->SetImplicitFunction(m_CropBoxForVectors);
@@ -280,14 +382,15 @@ mvManager::mvManager()
     m_VectorActor->VisibilityOff();
 
     // Vector Base
-    m_CubeSource  = vtkSmartPointer<vtkCubeSource>::New();
-    m_VectorGlyph = vtkSmartPointer<vtkGlyph3D>::New();
-    m_VectorGlyph->SetSourceConnection(m_CubeSource->GetOutputPort());
-    m_VectorGlyph->SetInputConnection(m_ActiveVectorDataSet->GetOutputPort());
-    m_VectorGlyph->ScalingOff();
-    m_VectorGlyph->OrientOff();
-    m_VectorGlyphMapper = vtkSmartPointer<vtkPolyDataMapper>::New();
-    m_VectorGlyphMapper->SetInputConnection(m_VectorGlyph->GetOutputPort());
+    // The cube is drawn once per vector base by the glyph mapper (instanced
+    // on the GPU), so only the point positions are uploaded when the time
+    // step changes instead of one copy of the cube geometry per point.
+    m_CubeSource        = vtkSmartPointer<vtkCubeSource>::New();
+    m_VectorGlyphMapper = vtkSmartPointer<vtkGlyph3DMapper>::New();
+    m_VectorGlyphMapper->SetSourceConnection(m_CubeSource->GetOutputPort());
+    m_VectorGlyphMapper->SetInputConnection(m_ActiveVectorDataSet->GetOutputPort());
+    m_VectorGlyphMapper->ScalingOff();
+    m_VectorGlyphMapper->OrientOff();
     m_VectorGlyphMapper->ScalarVisibilityOff();
     m_VectorGlyphActor = vtkSmartPointer<vtkActor>::New();
     m_VectorGlyphActor->SetMapper(m_VectorGlyphMapper);
@@ -335,7 +438,8 @@ mvManager::mvManager()
     m_ModelFeatures = new mvModelFeatures;
 
     // Overlay
-    m_Overlay       = new mvOverlay;
+    m_Overlay        = new mvOverlay;
+    m_OverlayPending = 0;
     // The SetFullGrid method of m_Overlay will be invoked after model is loaded
     m_Overlay->SetSubgrid(m_ExtractStructuredGridForSubgrid->GetOutput());
 
@@ -361,6 +465,15 @@ mvManager::mvManager()
 
     m_PropCollection->AddItem(m_GridLayer->GetActor());
 
+    m_InteractionLOD[0] = new mvInteractionLOD(m_SolidActor);
+    m_InteractionLOD[1] = new mvInteractionLOD(m_CroppedAwayPiecesActor);
+    m_InteractionLOD[2] = new mvInteractionLOD(m_GridShell->GetActor());
+    m_InteractionLOD[3] = new mvInteractionLOD(m_GridLines[0]->GetActor());
+    m_InteractionLOD[4] = new mvInteractionLOD(m_GridLines[1]->GetActor());
+    m_InteractionLOD[5] = new mvInteractionLOD(m_GridLines[2]->GetActor());
+    m_InteractionLOD[6] = new mvInteractionLOD(m_Overlay->GetActor());
+    m_InteractionLOD[7] = new mvInteractionLOD(m_ModelFeatures->GetActor());
+
     // Smooth solid. A series of filters to create the solid after
     // values outside the min-max range are clipped. The Smooth Solid
     // consists of the clipped grid shell (values outside the min-max
@@ -398,37 +511,15 @@ mvManager::mvManager()
     m_Plane[4]->SetNormal(0, 0, 1);
     m_Plane[5]->SetNormal(0, 0, -1);
 
-    // The cropper is a series of filters to crop either solid or the
-    // isosurfaces. Cropping means removal of portions that lie beyond
-    // cropping planes, which are normal to the x, y and z directions.
-    for (int i = 0; i < 6; i++)
-    {
-        m_Cropper[i] = vtkSmartPointer<vtkClipPolyData>::New();
-        m_Cropper[i]->SetClipFunction(m_Plane[i]);
-        m_Cropper[i]->GenerateClippedOutputOn();
-    }
+    // The croppers, the face extractors and croppers, and the isosurface
+    // cutters are only used while cropping. They are created by GetCropper,
+    // GetExtractFace, GetFaceCrop and GetIsosurfaceCutter.
+    m_ReleaseDataFlag = 0;
 
     // Cropped Solid. The cropped solid is either the smooth or blocky
     // solid that has been cropped.
     m_CroppedSolid = mvCustomAppendPolyData::New();
 
-    // Filters to extract "faces" corresponding to the cropping planes.
-    for (int i = 0; i < 6; i++)
-    {
-        m_ExtractFace[i] = vtkSmartPointer<vtkCutter>::New();
-        m_ExtractFace[i]->SetCutFunction(m_Plane[i]);
-        m_ExtractFace[i]->SetInputConnection(m_ActiveScalarDataSet->GetOutputPort());
-    }
-
-    // Filters to crop the extracted faces. Each extracted face must be
-    // cropped 4 times. For example, the face extracted on a plane normal
-    // to x must be cropped in the y and z extents at the min and max positions.
-    for (int i = 0; i < 24; i++)
-    {
-        m_FaceCrop[i] = vtkSmartPointer<vtkClipPolyData>::New();
-        m_FaceCrop[i]->SetClipFunction(m_Plane[i / 4]);
-    }
-
     // The cropped faces are appended into a single data set (m_Faces) for
     // clipping.
     m_Faces        = mvCustomAppendPolyData::New();
@@ -448,11 +539,6 @@ mvManager::mvManager()
     m_FacesThresholdGeometry = vtkSmartPointer<vtkGeometryFilter>::New();
     m_FacesThresholdGeometry->SetInputConnection(m_FacesThreshold->GetOutputPort());
 
-    for (int i = 0; i < 3; i++)
-    {
-        m_IsosurfaceCutter[i] = vtkSmartPointer<vtkCutter>::New();
-    }
-
     // SetImmediateModeRendering(1);
 }
 
@@ -470,12 +556,15 @@ mvManager::~mvManager()
     m_LutModifiedBlueToRed->Delete();
     m_LutCustomScale->Delete();
     m_LutReversedCustomScale->Delete();
-    m_LogLutBlueToRed->Delete();
-    m_LogLutRedToBlue->Delete();
-    m_LogLutModifiedRedToBlue->Delete();
-    m_LogLutModifiedBlueToRed->Delete();
-    m_LogLutCustomScale->Delete();
-    m_LogLutReversedCustomScale->Delete();
+    if (m_LogLutBlueToRed)
+    {
+        m_LogLutBlueToRed->Delete();
+        m_LogLutRedToBlue->Delete();
+        m_LogLutModifiedRedToBlue->Delete();
+        m_LogLutModifiedBlueToRed->Delete();
+        m_LogLutCustomScale->Delete();
+        m_LogLutReversedCustomScale->Delete();
+    }
 
     m_SmoothSolid->Delete();
     m_CroppedSolid->Delete();
@@ -483,6 +572,12 @@ mvManager::~mvManager()
     m_CropBoxForVectors->Delete();
     m_ColorBar->Delete();
 
+    // these refer to the actors of the display objects
+    for (i = 0; i < MV_NUM_INTERACTION_LOD; i++)
+    {
+        delete m_InteractionLOD[i];
+    }
+
     // mv display objects
     delete m_Pathlines;
     for (i = 0; i < 3; i++)
@@ -604,27 +699,62 @@ mvManager::~mvManager()
     }
 }
 
+mvSessionFile::mvSessionFile()
+{
+    m_HashTable    = nullptr;
+    m_ModelName[0] = '\0';
+    m_DataFileList = nullptr;
+}
+
+mvSessionFile::~mvSessionFile()
+{
+    if (m_HashTable) delete m_HashTable;
+    if (m_DataFileList) delete[] m_DataFileList;
+}
+
 const char *mvManager::LoadData(char *modelName, char *dataFileList)
 {
     // Reading data from a file is done in "Deserialize".
 
+    mvDataSource *newDataSource = nullptr;
+    const char   *errMsg        = ReadDataSource(modelName, dataFileList, newDataSource);
+    if (errMsg != nullptr)
+    {
+        return errMsg;
+    }
+    SetDataSource(newDataSource);
+    return nullptr;
+}
+
+const char *mvManager::ReadDataSource(char *modelName, char *dataFileList, mvDataSource *&dataSource,
+                                      mvLoadProgress *progress)
+{
+    // This may run in a worker thread, so it must not touch the pipeline.
+    dataSource                  = nullptr;
     mvDataSource *newDataSource = mvModelList::CreateDataSource(modelName);
     if (newDataSource == 0)
     {
         return "Model is not supported by this program";
     }
 
-    m_WarningMessage[0] = '\0';
-
-    const char *errMsg  = newDataSource->LoadData(dataFileList);
+    newDataSource->SetLoadProgress(progress);
+    const char *errMsg = newDataSource->LoadData(dataFileList);
+    newDataSource->SetLoadProgress(nullptr);
     if (errMsg != nullptr)
     {
         delete newDataSource;
         return errMsg;
     }
+    dataSource = newDataSource;
+    return nullptr;
+}
+
+void mvManager::SetDataSource(mvDataSource *dataSource)
+{
+    m_WarningMessage[0]      = '\0';
 
     // Data files are loaded OK. We keep the new data source object
-    m_DataSource             = newDataSource;
+    m_DataSource             = dataSource;
 
     int numVTKPoints         = m_DataSource->GetNumVTKPoints();
     int numVTKCells          = m_DataSource->GetNumVTKCells();
@@ -663,28 +793,7 @@ const char *mvManager::LoadData(char *modelName, char *dataFileList)
         m_StairsteppedGrid->SetPoints(m_StairsteppedGridPoints);
         m_StairsteppedGrid->GetCellData()->SetScalars(m_CellScalars);
 
-        int                           i;
-        int                           vtk_cell_index = 0;
-        int                           j              = 0;
-        int                          *cellType       = new int[numVTKCells];
-        vtkSmartPointer<vtkCellArray> cellArray      = vtkSmartPointer<vtkCellArray>::New();
-        for (i = 0; i < numVTKCells; i++)
-        {
-            cellType[vtk_cell_index]            = VTK_HEXAHEDRON;
-            vtkSmartPointer<vtkHexahedron> cell = vtkSmartPointer<vtkHexahedron>::New();
-            cell->GetPointIds()->SetId(3, j++);
-            cell->GetPointIds()->SetId(2, j++);
-            cell->GetPointIds()->SetId(1, j++);
-            cell->GetPointIds()->SetId(0, j++);
-            cell->GetPointIds()->SetId(7, j++);
-            cell->GetPointIds()->SetId(6, j++);
-            cell->GetPointIds()->SetId(5, j++);
-            cell->GetPointIds()->SetId(4, j++);
-            cellArray->InsertNextCell(cell);
-            vtk_cell_index++;
-        }
-        m_StairsteppedGrid->SetCells(cellType, cellArray);
-        delete[] cellType;
+        SetCellsFromConnectivity(m_StairsteppedGrid, m_DataSource->GetStairsteppedGridConnectivity(), numVTKCells);
     }
     else if (m_DataSource->GetGridType() == GridType::MV_LAYERED_GRID)
     {
@@ -701,47 +810,8 @@ const char *mvManager::LoadData(char *modelName, char *dataFileList)
         // fileter to extract layers
         m_ExtractCellsForSubgrid->SetInputData(m_ScalarLayeredGrid);
 
-        int                          *connectivity   = m_DataSource->GetConnectivityArray();
-        vtkSmartPointer<vtkCellArray> cellArray      = vtkSmartPointer<vtkCellArray>::New();
-        int                          *cellType       = new int[numVTKCells];
-        int                           k              = 0;
-        int                           vtk_cell_index = 0;
-        for (int i = 0; i < numVTKCells; i++)
-        {
-            vtkCell3D *cell;
-            int        nvert = connectivity[k++];
-            if (nvert > 0) // vtk cells are built only for modflow cells with idomain > 0.
-            {
-                switch (nvert)
-                {
-                case 6:
-                    cellType[vtk_cell_index++] = VTK_WEDGE;
-                    cell                       = vtkWedge::New();
-                    break;
-                case 8:
-                    cellType[vtk_cell_index++] = VTK_HEXAHEDRON;
-                    cell                       = vtkHexahedron::New();
-                    break;
-                case 10:
-                    cellType[vtk_cell_index++] = VTK_PENTAGONAL_PRISM;
-                    cell                       = vtkPentagonalPrism::New();
-                    break;
-                case 12:
-                    cellType[vtk_cell_index++] = VTK_HEXAGONAL_PRISM;
-                    cell                       = vtkHexagonalPrism::New();
-                }
-                for (int j = 0; j < nvert; j++)
-                {
-                    cell->GetPointIds()->SetId(j, connectivity[k++]);
-                }
-                cellArray->InsertNextCell(cell);
-                cell->Delete();
-            }
-        }
-        m_ScalarLayeredGrid->SetCells(cellType, cellArray);
-        // Note the data in cellType are copied by m_ScalarUnstructuredGrid.
-        // Because cellType is not referenced inside m_ScalarLayeredGrid, cellType can be deleted.
-        delete[] cellType;
+        SetCellsFromConnectivity(m_ScalarLayeredGrid, m_DataSource->GetConnectivityArray(), numVTKCells);
+        m_Overlay->SetFullGrid(m_ScalarLayeredGrid);
 
         // Grid Layer lines
         m_BlockySolidThreshold->SetInputData(m_ScalarLayeredGrid);
@@ -754,46 +824,7 @@ const char *mvManager::LoadData(char *modelName, char *dataFileList)
         m_StairsteppedGrid->SetPoints(m_StairsteppedGridPoints);
         m_StairsteppedGrid->GetCellData()->SetScalars(m_CellScalars);
 
-        connectivity   = m_DataSource->GetStairsteppedGridConnectivity();
-        cellArray      = vtkSmartPointer<vtkCellArray>::New();
-        cellType       = new int[numVTKCells];
-
-        vtk_cell_index = 0;
-        k              = 0;
-        for (int i = 0; i < numVTKCells; i++)
-        {
-            vtkCell3D *cell;
-            int        nvert = connectivity[k++];
-            if (nvert > 0)
-            {
-                switch (nvert)
-                {
-                case 6:
-                    cellType[vtk_cell_index++] = VTK_WEDGE;
-                    cell                       = vtkWedge::New();
-                    break;
-                case 8:
-                    cellType[vtk_cell_index++] = VTK_HEXAHEDRON;
-                    cell                       = vtkHexahedron::New();
-                    break;
-                case 10:
-                    cellType[vtk_cell_index++] = VTK_PENTAGONAL_PRISM;
-                    cell                       = vtkPentagonalPrism::New();
-                    break;
-                case 12:
-                    cellType[vtk_cell_index++] = VTK_HEXAGONAL_PRISM;
-                    cell                       = vtkHexagonalPrism::New();
-                }
-                for (int j = 0; j < nvert; j++)
-                {
-                    cell->GetPointIds()->SetId(j, connectivity[k++]);
-                }
-                cellArray->InsertNextCell(cell);
-                cell->Delete();
-            }
-        }
-        m_StairsteppedGrid->SetCells(cellType, cellArray);
-        delete[] cellType;
+        SetCellsFromConnectivity(m_StairsteppedGrid, m_DataSource->GetStairsteppedGridConnectivity(), numVTKCells);
     }
     else if (m_DataSource->GetGridType() == GridType::MV_UNSTRUCTURED_GRID)
     {
@@ -810,45 +841,11 @@ const char *mvManager::LoadData(char *modelName, char *dataFileList)
         m_BlockySolidThreshold->SetInputData(m_ScalarUnstructuredGrid);
         // no subgrid capability for unstructured grid
 
-        int                          *connectivity   = m_DataSource->GetStairsteppedGridConnectivity();
-        vtkSmartPointer<vtkCellArray> cellArray      = vtkSmartPointer<vtkCellArray>::New();
-        int                          *cellType       = new int[numVTKCells];
-        int                           k              = 0;
-        int                           vtk_cell_index = 0;
-        for (int i = 0; i < numVTKCells; i++)
-        {
-            vtkCell3D *cell;
-            int        nvert = connectivity[k++];
-            switch (nvert)
-            {
-            case 6:
-                cellType[vtk_cell_index++] = VTK_WEDGE;
-                cell                       = vtkWedge::New();
-                break;
-            case 8:
-                cellType[vtk_cell_index++] = VTK_HEXAHEDRON;
-                cell                       = vtkHexahedron::New();
-                break;
-            case 10:
-                cellType[vtk_cell_index++] = VTK_PENTAGONAL_PRISM;
-                cell                       = vtkPentagonalPrism::New();
-                break;
-            case 12:
-                cellType[vtk_cell_index++] = VTK_HEXAGONAL_PRISM;
-                cell                       = vtkHexagonalPrism::New();
-            }
-            for (int j = 0; j < nvert; j++)
-            {
-                cell->GetPointIds()->SetId(j, connectivity[k++]);
-            }
-            cellArray->InsertNextCell(cell);
-            cell->Delete();
-        }
-        m_ScalarUnstructuredGrid->SetCells(cellType, cellArray);
-        // Note the data in cellType are copied by m_ScalarUnstructuredGrid.
-        // Because cellType is not referenced inside m_ScalarUnstructuredGrid, cellType can be deleted.
-        delete[] cellType;
+        SetCellsFromConnectivity(m_ScalarUnstructuredGrid, m_DataSource->GetStairsteppedGridConnectivity(), numVTKCells);
+        m_Overlay->SetFullGrid(m_ScalarUnstructuredGrid);
     }
+    // the overlay drapes on the top of the grid read from the data source
+    m_Overlay->SetDataSource(m_DataSource);
 
     // Vector Data Set
     m_VectorGridPoints = vtkSmartPointer<vtkPoints>::New();
@@ -866,54 +863,40 @@ const char *mvManager::LoadData(char *modelName, char *dataFileList)
         m_ExtractStructuredGridVector->SetInputData(m_VectorDataSet);
         m_ActiveVectorDataSet->SetInputConnection(m_ExtractStructuredGridVector->GetOutputPort());
     }
-    else if (m_DataSource->GetGridType() == GridType::MV_LAYERED_GRID)
+    else
     {
         m_VectorDataSet          = 0;
         m_VectorUnstructuredGrid = vtkSmartPointer<vtkUnstructuredGrid>::New();
         m_VectorUnstructuredGrid->SetPoints(m_VectorGridPoints);
         m_VectorUnstructuredGrid->GetPointData()->SetVectors(m_Vectors);
         m_VectorUnstructuredGrid->GetPointData()->SetScalars(m_VectorMagnitudes);
-        //		m_ExtractUnstructuredGridVector->SetInputData(m_VectorUnstructuredGrid);
-        //		m_ActiveVectorDataSet->SetInputConnection(m_ExtractUnstructuredGridVector->GetOutputPort());
-        m_ActiveVectorDataSet->SetInputData(m_VectorUnstructuredGrid);
-    }
-    else
-    {
+        m_ExtractUnstructuredGridVector->SetInputData(m_VectorUnstructuredGrid);
+        m_ActiveVectorDataSet->SetInputConnection(m_ExtractUnstructuredGridVector->GetOutputPort());
     }
 
     m_Pathlines->SetMinPositiveValue(m_DataSource->GetMinPositiveTime());
 
-    // Set the point coordinates
-    vtkSmartPointer<vtkDoubleArray> doubleArray = vtkSmartPointer<vtkDoubleArray>::New();
-    doubleArray->SetNumberOfComponents(3);
-    doubleArray->SetArray(m_DataSource->GetInterpolatedGridCoordinates(), 3 * numVTKPoints, 1);
-    m_InterpolatedGridPoints->SetDataTypeToDouble();
-    m_InterpolatedGridPoints->SetData(doubleArray);
+    // Set the point coordinates. In single precision mode, coordinate arrays that the
+    // data source no longer needs are copied to float arrays and then freed.
+    int singleInterpolated = m_SinglePrecision && m_DataSource->CanReleaseInterpolatedGridCoordinates();
+    int singleStairstepped = m_SinglePrecision && m_DataSource->CanReleaseStairsteppedGridCoordinates();
+    SetPointCoordinates(m_InterpolatedGridPoints, m_DataSource->GetInterpolatedGridCoordinates(),
+                        numVTKPoints, singleInterpolated);
 
-    if (m_DataSource->GetGridType() == GridType::MV_STRUCTURED_GRID)
+    if (m_DataSource->GetGridType() == GridType::MV_STRUCTURED_GRID ||
+        m_DataSource->GetGridType() == GridType::MV_LAYERED_GRID)
     {
-        vtkSmartPointer<vtkDoubleArray> doubleArray = vtkSmartPointer<vtkDoubleArray>::New();
-        doubleArray->SetNumberOfComponents(3);
-        doubleArray->SetArray(m_DataSource->GetStairsteppedGridCoordinates(), 24 * numVTKCells, 1);
-        m_StairsteppedGridPoints->SetDataTypeToDouble();
-        m_StairsteppedGridPoints->SetData(doubleArray);
+        SetPointCoordinates(m_StairsteppedGridPoints, m_DataSource->GetStairsteppedGridCoordinates(),
+                            m_DataSource->GetStairsteppedGridCoordinatesSize() / 3, singleStairstepped);
     }
-    else if (m_DataSource->GetGridType() == GridType::MV_LAYERED_GRID)
+    else if (m_DataSource->GetGridType() == GridType::MV_UNSTRUCTURED_GRID)
     {
-        vtkSmartPointer<vtkDoubleArray> doubleArray = vtkSmartPointer<vtkDoubleArray>::New();
-        doubleArray->SetNumberOfComponents(3);
-        int size = m_DataSource->GetStairsteppedGridCoordinatesSize();
-        doubleArray->SetArray(m_DataSource->GetStairsteppedGridCoordinates(), size, 1);
-        m_StairsteppedGridPoints->SetDataTypeToDouble();
-        m_StairsteppedGridPoints->SetData(doubleArray);
+        SetPointCoordinates(m_StairsteppedGridPoints, m_DataSource->GetStairsteppedGridCoordinates(),
+                            numVTKPoints, singleStairstepped);
     }
-    else if (m_DataSource->GetGridType() == GridType::MV_UNSTRUCTURED_GRID)
+    if (singleInterpolated || singleStairstepped)
     {
-        vtkSmartPointer<vtkDoubleArray> doubleArray = vtkSmartPointer<vtkDoubleArray>::New();
-        doubleArray->SetNumberOfComponents(3);
-        doubleArray->SetArray(m_DataSource->GetStairsteppedGridCoordinates(), 3 * numVTKPoints, 1);
-        m_StairsteppedGridPoints->SetDataTypeToDouble();
-        m_StairsteppedGridPoints->SetData(doubleArray);
+        m_DataSource->ReleaseGridCoordinates();
     }
 
     // Set Point Data
@@ -1024,25 +1007,14 @@ const char *mvManager::LoadData(char *modelName, char *dataFileList)
             m_VectorDataSet->SetDimensions(vdim[0], vdim[1], vdim[2]);
             np = vdim[0] * vdim[1] * vdim[2];
         }
-        else if (m_DataSource->GetGridType() == GridType::MV_LAYERED_GRID)
-        {
-            np = m_DataSource->GetNumModelCells();
-            // vtkCellArray *connectivity = vtkCellArray::New();
-            // int *types = new int[numCells];
-            // m_DataSource->BuildCellsForDisvGrid(types, connectivity,
-            // m_VectorUnstructuredGrid->SetCells(types, connectivity);
-            // delete [] types;
-        }
         else
         {
+            np = m_DataSource->GetNumModelCells();
         }
 
-        // Set the point coordinates
-        doubleArray = vtkDoubleArray::New();
-        doubleArray->SetNumberOfComponents(3);
-        doubleArray->SetArray(m_DataSource->GetVectorGridCoordinates(), 3 * np, 1);
-        m_VectorGridPoints->SetData(doubleArray);
-        doubleArray->Delete();
+        // Set the point coordinates. The data source keeps the vector grid
+        // coordinates, so they are shared rather than copied.
+        SetPointCoordinates(m_VectorGridPoints, m_DataSource->GetVectorGridCoordinates(), np, 0);
 
         // Set the scaled vector data
         m_ScaledVectorArray = new double[3 * np];
@@ -1150,7 +1122,10 @@ const char *mvManager::LoadData(char *modelName, char *dataFileList)
     m_SmoothSolidIsosurface->SetInputConnection(m_ActiveScalarDataSet->GetOutputPort());
     for (int i = 0; i < 6; i++)
     {
-        m_ExtractFace[i]->SetInputConnection(m_ActiveScalarDataSet->GetOutputPort());
+        if (m_ExtractFace[i])
+        {
+            m_ExtractFace[i]->SetInputConnection(m_ActiveScalarDataSet->GetOutputPort());
+        }
     }
     //   m_GridLines[0]->SetAllCellsAreActive(0);
     //   m_GridLines[1]->SetAllCellsAreActive(0);
@@ -1208,8 +1183,6 @@ const char *mvManager::LoadData(char *modelName, char *dataFileList)
     {
         SetSolidDisplayToBlocky();
     }
-
-    return nullptr;
 }
 
 const mvDataSource *mvManager::GetDataSource() const
@@ -1219,6 +1192,8 @@ const mvDataSource *mvManager::GetDataSource() const
 
 void mvManager::ApplyDefaultSettings()
 {
+    BeginUpdate();
+
     // Hide Everything
     HideScalarData();
     HideCroppedAwayPieces();
@@ -1351,6 +1326,7 @@ void mvManager::ApplyDefaultSettings()
     {
         const int *vdim = m_DataSource->GetVectorGridDimensions();
         SubsampleVectors(0, vdim[0] - 1, 1, 0, vdim[1] - 1, 1, 0, vdim[2] - 1, 1);
+        SetVectorScreenSpacing(10);
         SetVectorSizeToOptimal();
         if (m_VectorLog10Transform)
         {
@@ -1407,6 +1383,8 @@ void mvManager::ApplyDefaultSettings()
     SetOverlayDrapeGap(0);
 
     // Grid Display
+
+    EndUpdate();
 }
 
 #if ((VTK_MAJOR_VERSION == 8) && (VTK_MINOR_VERSION <= 1) || (VTK_MAJOR_VERSION < 8))  //  https://vtk.org/Wiki/VTK/API_Changes_8_0_1_to_8_1_0
@@ -1436,17 +1414,125 @@ void mvManager::SetReleaseDataFlag(int b)
     m_Faces->SetReleaseDataFlag(b);
     m_FacesClipMin->SetReleaseDataFlag(b);
     m_FacesClipMax->SetReleaseDataFlag(b);
+    // the filters that have not been created get the flag when they are
+    m_ReleaseDataFlag = b;
     for (i = 0; i < 3; i++)
     {
-        m_IsosurfaceCutter[i]->SetReleaseDataFlag(b);
+        if (m_IsosurfaceCutter[i])
+        {
+            m_IsosurfaceCutter[i]->SetReleaseDataFlag(b);
+        }
     }
     for (i = 0; i < 6; i++)
     {
-        m_Cropper[i]->SetReleaseDataFlag(b);
+        if (m_Cropper[i])
+        {
+            m_Cropper[i]->SetReleaseDataFlag(b);
+        }
     }
     for (i = 0; i < 24; i++)
     {
-        m_FaceCrop[i]->SetReleaseDataFlag(b);
+        if (m_FaceCrop[i])
+        {
+            m_FaceCrop[i]->SetReleaseDataFlag(b);
+        }
+    }
+}
+
+// The cropper is a series of filters to crop either solid or the
+// isosurfaces. Cropping means removal of portions that lie beyond
+// cropping planes, which are normal to the x, y and z directions.
+vtkClipPolyData *mvManager::GetCropper(int i)
+{
+    if (!m_Cropper[i])
+    {
+        m_Cropper[i] = vtkSmartPointer<vtkClipPolyData>::New();
+        m_Cropper[i]->SetClipFunction(m_Plane[i]);
+        m_Cropper[i]->GenerateClippedOutputOn();
+        m_Cropper[i]->SetReleaseDataFlag(m_ReleaseDataFlag);
+    }
+    return m_Cropper[i];
+}
+
+// Filters to extract "faces" corresponding to the cropping planes.
+vtkCutter *mvManager::GetExtractFace(int i)
+{
+    if (!m_ExtractFace[i])
+    {
+        m_ExtractFace[i] = vtkSmartPointer<vtkCutter>::New();
+        m_ExtractFace[i]->SetCutFunction(m_Plane[i]);
+        m_ExtractFace[i]->SetInputConnection(m_ActiveScalarDataSet->GetOutputPort());
+    }
+    return m_ExtractFace[i];
+}
+
+// Filters to crop the extracted faces. Each extracted face must be
+// cropped 4 times. For example, the face extracted on a plane normal
+// to x must be cropped in the y and z extents at the min and max positions.
+vtkClipPolyData *mvManager::GetFaceCrop(int i)
+{
+    if (!m_FaceCrop[i])
+    {
+        m_FaceCrop[i] = vtkSmartPointer<vtkClipPolyData>::New();
+        m_FaceCrop[i]->SetClipFunction(m_Plane[i / 4]);
+        m_FaceCrop[i]->SetReleaseDataFlag(m_ReleaseDataFlag);
+    }
+    return m_FaceCrop[i];
+}
+
+vtkCutter *mvManager::GetIsosurfaceCutter(int i)
+{
+    if (!m_IsosurfaceCutter[i])
+    {
+        m_IsosurfaceCutter[i] = vtkSmartPointer<vtkCutter>::New();
+        m_IsosurfaceCutter[i]->SetReleaseDataFlag(m_ReleaseDataFlag);
+    }
+    return m_IsosurfaceCutter[i];
+}
+
+void mvManager::CreateLogLookupTables()
+{
+    if (m_LogLutBlueToRed)
+    {
+        return;
+    }
+
+    // Log Lookup tables
+    // Despite appearances to the contrary, the reversed color scheme is correct for
+    // m_LogLutBlueToRed and the unreversed color scheme is correct for m_LogLutRedToBlue
+    m_LogLutBlueToRed = mvLogColorTable::New();
+    dynamic_cast<mvLogColorTable *>(m_LogLutBlueToRed)->SetReversedDefaultColorScheme();
+    m_LogLutRedToBlue = mvLogColorTable::New();
+    dynamic_cast<mvLogColorTable *>(m_LogLutRedToBlue)->SetDefaultColorScheme();
+
+    m_LogLutModifiedBlueToRed = mvLogColorTable::New();
+    dynamic_cast<mvLogColorTable *>(m_LogLutModifiedBlueToRed)->SetModifiedColorScheme();
+    m_LogLutModifiedRedToBlue = mvLogColorTable::New();
+    dynamic_cast<mvLogColorTable *>(m_LogLutModifiedRedToBlue)->SetReversedModifiedColorScheme();
+
+    m_LogLutCustomScale = mvLogColorTable::New();
+    dynamic_cast<mvLogColorTable *>(m_LogLutCustomScale)->SetFirstCustomColor(GetColorBarFirstCustomColor());
+    dynamic_cast<mvLogColorTable *>(m_LogLutCustomScale)->SetLastCustomColor(GetColorBarLastCustomColor());
+    dynamic_cast<mvLogColorTable *>(m_LogLutCustomScale)->SetCustomColorScheme();
+
+    m_LogLutReversedCustomScale = mvLogColorTable::New();
+    dynamic_cast<mvLogColorTable *>(m_LogLutReversedCustomScale)->SetFirstCustomColor(GetColorBarFirstCustomColor());
+    dynamic_cast<mvLogColorTable *>(m_LogLutReversedCustomScale)->SetLastCustomColor(GetColorBarLastCustomColor());
+    dynamic_cast<mvLogColorTable *>(m_LogLutReversedCustomScale)->SetReversedCustomColorScheme();
+
+    // Bring the ranges up to date with the linear tables. The log tables
+    // keep their range when the linear range includes zero.
+    vtkLookupTable *luts[6]    = {m_LutBlueToRed, m_LutRedToBlue, m_LutModifiedBlueToRed,
+                                  m_LutModifiedRedToBlue, m_LutCustomScale, m_LutReversedCustomScale};
+    vtkLookupTable *logLuts[6] = {m_LogLutBlueToRed, m_LogLutRedToBlue, m_LogLutModifiedBlueToRed,
+                                  m_LogLutModifiedRedToBlue, m_LogLutCustomScale, m_LogLutReversedCustomScale};
+    for (int i = 0; i < 6; i++)
+    {
+        double *range = luts[i]->GetRange();
+        if (range[0] * range[1] > 0)
+        {
+            logLuts[i]->SetRange(range[0], range[1]);
+        }
     }
 }
 
@@ -1510,6 +1596,30 @@ char **mvManager::GetTimePointLabels()
     }
 }
 
+const double *mvManager::GetTimePoints()
+{
+    if (!m_DataSource)
+    {
+        return 0;
+    }
+    else
+    {
+        return m_DataSource->GetTimePoints();
+    }
+}
+
+int mvManager::UpdateTimePoints()
+{
+    if (!m_DataSource)
+    {
+        return 0;
+    }
+    else
+    {
+        return m_DataSource->UpdateTimePoints();
+    }
+}
+
 int mvManager::GetNumberOfScalarDataTypes() const
 {
     if (!m_DataSource)
@@ -1697,6 +1807,12 @@ void mvManager::UpdateColorBands()
 
 void mvManager::SetScalarSubgridExtent(int imin, int imax, int jmin, int jmax, int kmin, int kmax)
 {
+    m_ScalarSubgridExtent[0] = imin;
+    m_ScalarSubgridExtent[1] = imax;
+    m_ScalarSubgridExtent[2] = jmin;
+    m_ScalarSubgridExtent[3] = jmax;
+    m_ScalarSubgridExtent[4] = kmin;
+    m_ScalarSubgridExtent[5] = kmax;
     if (m_DataSource->GetGridType() == GridType::MV_STRUCTURED_GRID)
     {
         // note that imin, imax, jmin, etc refer to point indices, starting from zero, and using vtk convention
@@ -1769,6 +1885,10 @@ void mvManager::ScalarSubgridOn()
         const int *g2   = m_GridLines[2]->GetExtent();
         if (v[0] == g2[0] && v[1] == g2[1] && v[2] == g2[2] && v[3] == g2[3] && v[4] == g1[4] && v[5] == g1[5])
         {
+            // The pipeline is unchanged, but the data source must still
+            // read the new extent, as when the subgrid is widened back to
+            // the whole grid
+            UpdateDataSourceSubgrid();
             return;
         }
 
@@ -1794,7 +1914,10 @@ void mvManager::ScalarSubgridOn()
             m_SmoothSolidIsosurface->SetInputConnection(m_ActiveScalarDataSet->GetOutputPort());
             for (int i = 0; i < 6; i++)
             {
-                m_ExtractFace[i]->SetInputConnection(m_ActiveScalarDataSet->GetOutputPort());
+                if (m_ExtractFace[i])
+                {
+                    m_ExtractFace[i]->SetInputConnection(m_ActiveScalarDataSet->GetOutputPort());
+                }
             }
             //	}
             int p = max(v[0], min(g0[0], v[1]));
@@ -1880,6 +2003,7 @@ void mvManager::ScalarSubgridOn()
     {
         return;
     }
+    UpdateDataSourceSubgrid();
 
     // Recompute bounds for the bounding box
     double bounds[6];
@@ -1945,7 +2069,10 @@ void mvManager::ScalarSubgridOff()
         m_SmoothSolidIsosurface->SetInputConnection(m_ActiveScalarDataSet->GetOutputPort());
         for (int i = 0; i < 6; i++)
         {
-            m_ExtractFace[i]->SetInputConnection(m_ActiveScalarDataSet->GetOutputPort());
+            if (m_ExtractFace[i])
+            {
+                m_ExtractFace[i]->SetInputConnection(m_ActiveScalarDataSet->GetOutputPort());
+            }
         }
     }
     else if (m_DataSource->GetGridType() == GridType::MV_LAYERED_GRID)
@@ -1961,6 +2088,8 @@ void mvManager::ScalarSubgridOff()
             m_BlockySolidThreshold->SetInputData(m_StairsteppedGrid);
         }
     }
+    UpdateDataSourceSubgrid();
+
     // Recompute the bounds for the bounding box
     double bounds[6];
     // if (m_DataSource->AreAllCellsActive())
@@ -2001,6 +2130,17 @@ void mvManager::ScalarSubgridOff()
     }
 }
 
+void mvManager::UpdateDataSourceSubgrid()
+{
+    // Let the data source skip the data outside the subgrid, and reread
+    // the current time point if that changes what is read
+    if (m_DataSource->SetScalarSubgrid(IsScalarSubgridOn(), m_ScalarSubgridExtent))
+    {
+        m_DataSource->SetTimePointTo(m_TimePointIndex);
+        OnDataModified();
+    }
+}
+
 int mvManager::IsScalarSubgridOn() const
 {
     if (m_DataSource->GetGridType() == GridType::MV_STRUCTURED_GRID)
@@ -2126,14 +2266,14 @@ void mvManager::VectorThresholdOn()
 {
     m_DoVectorThreshold = 1;
     m_HedgeHog->SetInputConnection(m_VectorThreshold->GetOutputPort());
-    m_VectorGlyph->SetInputConnection(m_VectorThreshold->GetOutputPort());
+    m_VectorGlyphMapper->SetInputConnection(m_VectorThreshold->GetOutputPort());
 }
 
 void mvManager::VectorThresholdOff()
 {
     m_DoVectorThreshold = 0;
     m_HedgeHog->SetInputConnection(m_ActiveVectorDataSet->GetOutputPort());
-    m_VectorGlyph->SetInputConnection(m_ActiveVectorDataSet->GetOutputPort());
+    m_VectorGlyphMapper->SetInputConnection(m_ActiveVectorDataSet->GetOutputPort());
 }
 
 int mvManager::IsVectorThresholdOn() const
@@ -2219,8 +2359,7 @@ void mvManager::CropVectors(double xmin, double xmax,
         }
         else
         {
-            //			m_CropVectors->SetInputConnection(m_ExtractUnstructuredGridVector->GetOutputPort());
-            m_CropVectors->SetInputData(m_VectorUnstructuredGrid);
+            m_CropVectors->SetInputConnection(m_ExtractUnstructuredGridVector->GetOutputPort());
         }
         m_ActiveVectorDataSet->SetInputConnection(m_CropVectors->GetOutputPort());
     }
@@ -2232,8 +2371,7 @@ void mvManager::CropVectors(double xmin, double xmax,
         }
         else
         {
-            //			m_ActiveVectorDataSet->SetInputConnection(m_ExtractUnstructuredGridVector->GetOutputPort());
-            m_ActiveVectorDataSet->SetInputData(m_VectorUnstructuredGrid);
+            m_ActiveVectorDataSet->SetInputConnection(m_ExtractUnstructuredGridVector->GetOutputPort());
         }
     };
 }
@@ -2282,6 +2420,34 @@ void mvManager::GetVectorSubsampleExtentAndRate(int *extent, int *rate)
     rate[2]      = r[2];
 }
 
+void mvManager::SetVectorScreenSpacing(int pixels)
+{
+    m_VectorScreenSpacing = (pixels > 0) ? pixels : 0;
+    UpdateVectorBinSize(m_VectorWorldUnitsPerPixel);
+}
+
+void mvManager::UpdateVectorBinSize(double worldUnitsPerPixel)
+{
+    // Called by the view whenever the zoom may have changed. The bin size is
+    // rounded to a quarter power of two so that small changes in zoom do not
+    // cause the vectors to be resampled.
+    m_VectorWorldUnitsPerPixel = worldUnitsPerPixel;
+    if (m_DataSource == 0 || GetGridType() == GridType::MV_STRUCTURED_GRID)
+    {
+        return;
+    }
+    double binSize = m_VectorScreenSpacing * worldUnitsPerPixel;
+    if (binSize > 0)
+    {
+        binSize = pow(2.0, floor(log(binSize) / log(2.0) * 4 + 0.5) / 4);
+    }
+    else
+    {
+        binSize = 0;
+    }
+    m_ExtractUnstructuredGridVector->SetBinSize(binSize);
+}
+
 void mvManager::ActivateVectorGlyph(int active)
 {
     m_VectorGlyphActivated = active;
@@ -2468,6 +2634,11 @@ int mvManager::GetPathlineLogTransform() const
 
 void mvManager::SetPathlineLogTransform(int Value)
 {
+    if (Value)
+    {
+        // the color bar shows the pathline times with a log table
+        CreateLogLookupTables();
+    }
     m_Pathlines->SetLogTransform(Value);
 }
 
@@ -2721,6 +2892,32 @@ const double *mvManager::GetGridLineColor() const
     return m_GridLines[0]->GetColor();
 }
 
+void mvManager::BeginInteraction()
+{
+    for (int i = 0; i < MV_NUM_INTERACTION_LOD; i++)
+    {
+        m_InteractionLOD[i]->BeginInteraction();
+    }
+}
+
+void mvManager::EndInteraction()
+{
+    for (int i = 0; i < MV_NUM_INTERACTION_LOD; i++)
+    {
+        m_InteractionLOD[i]->EndInteraction();
+    }
+}
+
+void mvManager::UpdateInteractionLOD()
+{
+    // Called after each full resolution render. Coarse versions are
+    // recomputed in the background for the actors whose input changed.
+    for (int i = 0; i < MV_NUM_INTERACTION_LOD; i++)
+    {
+        m_InteractionLOD[i]->Refresh();
+    }
+}
+
 // Sets the xyz scale for actors.
 void mvManager::SetScale(double xScale, double yScale, double zScale)
 {
@@ -2735,6 +2932,7 @@ void mvManager::SetScale(double xScale, double yScale, double zScale)
     m_CroppedAwayPiecesActor->SetScale(xScale, yScale, zScale);
     m_VectorActor->SetScale(xScale, yScale, zScale);
     m_VectorGlyphActor->SetScale(xScale, yScale, zScale);
+    m_ExtractUnstructuredGridVector->SetScale(xScale, yScale, zScale);
     m_GridShell->SetScale(xScale, yScale, zScale);
     m_BoundingBox->SetScale(xScale, yScale, zScale);
     m_CubeSource->SetXLength(m_CubeSource->GetXLength() * s[0] / xScale);
@@ -2973,6 +3171,94 @@ int mvManager::GetInitialDisplayTimePoint()
     }
 }
 
+int mvManager::FindScalarCell(const double *point, const double *normal)
+{
+    if (m_DataSource == 0)
+    {
+        return -1;
+    }
+    // The cells of the stairstepped grid are the model cells. DISU grids
+    // are only displayed stairstepped.
+    vtkUnstructuredGrid *grid = m_StairsteppedGrid;
+    if (m_DataSource->GetGridType() == GridType::MV_UNSTRUCTURED_GRID)
+    {
+        grid = m_ScalarUnstructuredGrid;
+    }
+    if (grid == 0 || grid->GetNumberOfCells() == 0)
+    {
+        return -1;
+    }
+
+    // The picked point is on the surface of a cell, so move it slightly
+    // into the cell, and undo the scaling of the actors.
+    const double *scale    = GetScale();
+    double        diagonal = grid->GetLength();
+    double        x[3];
+    for (int i = 0; i < 3; i++)
+    {
+        x[i] = point[i] / scale[i];
+        if (normal)
+        {
+            x[i] -= normal[i] / scale[i] * 1.0e-6 * diagonal;
+        }
+    }
+    int                 subId;
+    double              pcoords[3];
+    std::vector<double> weights(std::max(grid->GetMaxCellSize(), 1));
+    vtkIdType           cell = grid->FindCell(x, nullptr, -1, 1.0e-12 * diagonal * diagonal, subId, pcoords, weights.data());
+    return (int)cell;
+}
+
+int mvManager::GetTimeSeries(int numCells, const int *cells, double *values)
+{
+    if (m_DataSource == 0)
+    {
+        return 0;
+    }
+    return m_DataSource->GetTimeSeries(numCells, cells, values);
+}
+
+std::string mvManager::GetCellDescription(int cell)
+{
+    if (m_DataSource == 0)
+    {
+        return std::string();
+    }
+    return m_DataSource->GetCellDescription(cell);
+}
+
+void mvManager::SetReferenceTimePoint(int timePointIndex)
+{
+    if (m_DataSource == 0)
+    {
+        return;
+    }
+    // The current values only change if drawdown is displayed
+    if (m_DataSource->SetReferenceTimePoint(timePointIndex))
+    {
+        m_DataSource->SetTimePointTo(m_TimePointIndex);
+        OnDataModified();
+    }
+}
+
+int mvManager::GetReferenceTimePoint() const
+{
+    if (m_DataSource == 0)
+    {
+        return 0;
+    }
+    return m_DataSource->GetReferenceTimePoint();
+}
+
+double mvManager::GetInactiveCellValue() const
+{
+    if (m_DataSource == 0)
+    {
+        return 1.0e30;
+    }
+    return m_DataSource->GetInactiveCellValue();
+}
+
 void mvManager::OnDataModified()
 {
     m_PointScalars->Modified();
@@ -3174,6 +3460,8 @@ void mvManager::SetScalarDataTypeTo(int dataTypeIndex)
 
     m_ActiveDataType = dataTypeIndex;
 
+    // the settings of the data type are applied with one pipeline rebuild
+    BeginUpdate();
     if (m_ColorBarDataSource == 0)
     {
         SetColorBarEndPoints(m_ColorBarValueBlue[dataTypeIndex], m_ColorBarValueRed[dataTypeIndex]);
@@ -3235,6 +3523,7 @@ void mvManager::SetScalarDataTypeTo(int dataTypeIndex)
     {
         BuildPipelineForIsosurface();
     }
+    EndUpdate();
 }
 
 void mvManager::SetSolidDisplayToBlocky()
@@ -3319,7 +3608,7 @@ void mvManager::SetColorBarEndPoints(double valueBlue, double valueRed)
         m_LutBlueToRed->SetRange(range[0], range[1]);
         m_LutModifiedBlueToRed->SetRange(range[0], range[1]);
         m_LutCustomScale->SetRange(range[0], range[1]);
-        if (range[0] * range[1] > 0)
+        if (range[0] * range[1] > 0 && m_LogLutBlueToRed)
         {
             m_LogLutBlueToRed->SetRange(range[0], range[1]);
             m_LogLutModifiedBlueToRed->SetRange(range[0], range[1]);
@@ -3386,7 +3675,7 @@ void mvManager::SetColorBarEndPoints(double valueBlue, double valueRed)
         m_LutRedToBlue->SetRange(range[0], range[1]);
         m_LutModifiedRedToBlue->SetRange(range[0], range[1]);
         m_LutReversedCustomScale->SetRange(range[0], range[1]);
-        if (range[0] * range[1] > 0)
+        if (range[0] * range[1] > 0 && m_LogLutRedToBlue)
         {
             m_LogLutRedToBlue->SetRange(range[0], range[1]);
             m_LogLutModifiedRedToBlue->SetRange(range[0], range[1]);
@@ -3538,6 +3827,7 @@ void mvManager::UseLinearColorBar()
 
 void mvManager::UseLogColorBar()
 {
+    CreateLogLookupTables();
     if (m_SolidMapper->GetLookupTable() == m_LutBlueToRed)
     {
         m_SolidMapper->SetLookupTable(m_LogLutBlueToRed);
@@ -3879,11 +4169,14 @@ void mvManager::SetColorBarFirstCustomColor(std::uint32_t value)
     dynamic_cast<mvColorTable *>(m_LutReversedCustomScale)->SetFirstCustomColor(value);
     dynamic_cast<mvColorTable *>(m_LutReversedCustomScale)->SetReversedCustomColorScheme();
 
-    dynamic_cast<mvLogColorTable *>(m_LogLutCustomScale)->SetFirstCustomColor(value);
-    dynamic_cast<mvLogColorTable *>(m_LogLutCustomScale)->SetCustomColorScheme();
+    if (m_LogLutCustomScale)
+    {
+        dynamic_cast<mvLogColorTable *>(m_LogLutCustomScale)->SetFirstCustomColor(value);
+        dynamic_cast<mvLogColorTable *>(m_LogLutCustomScale)->SetCustomColorScheme();
 
-    dynamic_cast<mvLogColorTable *>(m_LogLutReversedCustomScale)->SetFirstCustomColor(value);
-    dynamic_cast<mvLogColorTable *>(m_LogLutReversedCustomScale)->SetReversedCustomColorScheme();
+        dynamic_cast<mvLogColorTable *>(m_LogLutReversedCustomScale)->SetFirstCustomColor(value);
+        dynamic_cast<mvLogColorTable *>(m_LogLutReversedCustomScale)->SetReversedCustomColorScheme();
+    }
 }
 
 void mvManager::SetColorBarLastCustomColor(std::uint32_t value)
@@ -3894,11 +4187,14 @@ void mvManager::SetColorBarLastCustomColor(std::uint32_t value)
     dynamic_cast<mvColorTable *>(m_LutReversedCustomScale)->SetLastCustomColor(value);
     dynamic_cast<mvColorTable *>(m_LutReversedCustomScale)->SetReversedCustomColorScheme();
 
-    dynamic_cast<mvLogColorTable *>(m_LogLutCustomScale)->SetLastCustomColor(value);
-    dynamic_cast<mvLogColorTable *>(m_LogLutCustomScale)->SetCustomColorScheme();
+    if (m_LogLutCustomScale)
+    {
+        dynamic_cast<mvLogColorTable *>(m_LogLutCustomScale)->SetLastCustomColor(value);
+        dynamic_cast<mvLogColorTable *>(m_LogLutCustomScale)->SetCustomColorScheme();
 
-    dynamic_cast<mvLogColorTable *>(m_LogLutReversedCustomScale)->SetLastCustomColor(value);
-    dynamic_cast<mvLogColorTable *>(m_LogLutReversedCustomScale)->SetReversedCustomColorScheme();
+        dynamic_cast<mvLogColorTable *>(m_LogLutReversedCustomScale)->SetLastCustomColor(value);
+        dynamic_cast<mvLogColorTable *>(m_LogLutReversedCustomScale)->SetReversedCustomColorScheme();
+    }
 }
 
 int mvManager::GetColorBarSource() const
@@ -4405,8 +4701,44 @@ void mvManager::SetCustomIsosurfaces(int count, const double *values)
     }
 }
 
+void mvManager::BeginUpdate()
+{
+    m_UpdateDepth++;
+}
+
+void mvManager::EndUpdate()
+{
+    if (m_UpdateDepth == 0 || --m_UpdateDepth > 0)
+    {
+        return;
+    }
+    int solid                   = m_PendingSolidPipeline;
+    int isosurface              = m_PendingIsosurfacePipeline;
+    m_PendingSolidPipeline      = 0;
+    m_PendingIsosurfacePipeline = 0;
+    m_UpdateRequests            = 0;
+    if (solid && (!isosurface || solid < isosurface))
+    {
+        BuildPipelineForSolid();
+        solid = 0;
+    }
+    if (isosurface)
+    {
+        BuildPipelineForIsosurface();
+    }
+    if (solid)
+    {
+        BuildPipelineForSolid();
+    }
+}
+
 void mvManager::BuildPipelineForSolid()
 {
+    if (m_UpdateDepth > 0)
+    {
+        m_PendingSolidPipeline = ++m_UpdateRequests;
+        return;
+    }
     int                 i;
 
     // Step 1: Determine which type of solid to start with.
@@ -4444,50 +4776,50 @@ void mvManager::BuildPipelineForSolid()
     int hasFaces = 0;
     if (m_CropBounds[0] > 0)
     {
-        m_Cropper[0]->SetInputConnection(previousAlgorithmOutput);
-        previousAlgorithmOutput = m_Cropper[0]->GetOutputPort();
-        m_CroppedAwayPieces->AddInputData(m_Cropper[0]->GetClippedOutput());
-        face[0]  = m_ExtractFace[0]->GetOutputPort();
+        GetCropper(0)->SetInputConnection(previousAlgorithmOutput);
+        previousAlgorithmOutput = GetCropper(0)->GetOutputPort();
+        m_CroppedAwayPieces->AddInputData(GetCropper(0)->GetClippedOutput());
+        face[0]  = GetExtractFace(0)->GetOutputPort();
         hasFaces = 1;
     }
     if (m_CropBounds[1] < 1)
     {
-        m_Cropper[1]->SetInputConnection(previousAlgorithmOutput);
-        previousAlgorithmOutput = m_Cropper[1]->GetOutputPort();
-        m_CroppedAwayPieces->AddInputData(m_Cropper[1]->GetClippedOutput());
-        face[1]  = m_ExtractFace[1]->GetOutputPort();
+        GetCropper(1)->SetInputConnection(previousAlgorithmOutput);
+        previousAlgorithmOutput = GetCropper(1)->GetOutputPort();
+        m_CroppedAwayPieces->AddInputData(GetCropper(1)->GetClippedOutput());
+        face[1]  = GetExtractFace(1)->GetOutputPort();
         hasFaces = 1;
     }
     if (m_CropBounds[2] > 0)
     {
-        m_Cropper[2]->SetInputConnection(previousAlgorithmOutput);
-        previousAlgorithmOutput = m_Cropper[2]->GetOutputPort();
-        m_CroppedAwayPieces->AddInputData(m_Cropper[2]->GetClippedOutput());
-        face[2]  = m_ExtractFace[2]->GetOutputPort();
+        GetCropper(2)->SetInputConnection(previousAlgorithmOutput);
+        previousAlgorithmOutput = GetCropper(2)->GetOutputPort();
+        m_CroppedAwayPieces->AddInputData(GetCropper(2)->GetClippedOutput());
+        face[2]  = GetExtractFace(2)->GetOutputPort();
         hasFaces = 1;
     }
     if (m_CropBounds[3] < 1)
     {
-        m_Cropper[3]->SetInputConnection(previousAlgorithmOutput);
-        previousAlgorithmOutput = m_Cropper[3]->GetOutputPort();
-        m_CroppedAwayPieces->AddInputData(m_Cropper[3]->GetClippedOutput());
-        face[3]  = m_ExtractFace[3]->GetOutputPort();
+        GetCropper(3)->SetInputConnection(previousAlgorithmOutput);
+        previousAlgorithmOutput = GetCropper(3)->GetOutputPort();
+        m_CroppedAwayPieces->AddInputData(GetCropper(3)->GetClippedOutput());
+        face[3]  = GetExtractFace(3)->GetOutputPort();
         hasFaces = 1;
     }
     if (m_CropBounds[4] > 0)
     {
-        m_Cropper[4]->SetInputConnection(previousAlgorithmOutput);
-        previousAlgorithmOutput = m_Cropper[4]->GetOutputPort();
-        m_CroppedAwayPieces->AddInputData(m_Cropper[4]->GetClippedOutput());
-        face[4]  = m_ExtractFace[4]->GetOutputPort();
+        GetCropper(4)->SetInputConnection(previousAlgorithmOutput);
+        previousAlgorithmOutput = GetCropper(4)->GetOutputPort();
+        m_CroppedAwayPieces->AddInputData(GetCropper(4)->GetClippedOutput());
+        face[4]  = GetExtractFace(4)->GetOutputPort();
         hasFaces = 1;
     }
     if (m_CropBounds[5] < 1)
     {
-        m_Cropper[5]->SetInputConnection(previousAlgorithmOutput);
-        previousAlgorithmOutput = m_Cropper[5]->GetOutputPort();
-        m_CroppedAwayPieces->AddInputData(m_Cropper[5]->GetClippedOutput());
-        face[5]  = m_ExtractFace[5]->GetOutputPort();
+        GetCropper(5)->SetInputConnection(previousAlgorithmOutput);
+        previousAlgorithmOutput = GetCropper(5)->GetOutputPort();
+        m_CroppedAwayPieces->AddInputData(GetCropper(5)->GetClippedOutput());
+        face[5]  = GetExtractFace(5)->GetOutputPort();
         hasFaces = 1;
     }
 
@@ -4521,138 +4853,138 @@ void mvManager::BuildPipelineForSolid()
         {
             if (face[2] != 0)
             {
-                m_FaceCrop[0]->SetInputConnection(face[2]);
-                face[2] = m_FaceCrop[0]->GetOutputPort();
+                GetFaceCrop(0)->SetInputConnection(face[2]);
+                face[2] = GetFaceCrop(0)->GetOutputPort();
             }
             if (face[3] != 0)
             {
-                m_FaceCrop[1]->SetInputConnection(face[3]);
-                face[3] = m_FaceCrop[1]->GetOutputPort();
+                GetFaceCrop(1)->SetInputConnection(face[3]);
+                face[3] = GetFaceCrop(1)->GetOutputPort();
             }
             if (face[4] != 0)
             {
-                m_FaceCrop[2]->SetInputConnection(face[4]);
-                face[4] = m_FaceCrop[2]->GetOutputPort();
+                GetFaceCrop(2)->SetInputConnection(face[4]);
+                face[4] = GetFaceCrop(2)->GetOutputPort();
             }
             if (face[5] != 0)
             {
-                m_FaceCrop[3]->SetInputConnection(face[5]);
-                face[5] = m_FaceCrop[3]->GetOutputPort();
+                GetFaceCrop(3)->SetInputConnection(face[5]);
+                face[5] = GetFaceCrop(3)->GetOutputPort();
             }
         }
         if (m_CropBounds[1] < 1)
         {
             if (face[2] != 0)
             {
-                m_FaceCrop[4]->SetInputConnection(face[2]);
-                face[2] = m_FaceCrop[4]->GetOutputPort();
+                GetFaceCrop(4)->SetInputConnection(face[2]);
+                face[2] = GetFaceCrop(4)->GetOutputPort();
             }
             if (face[3] != 0)
             {
-                m_FaceCrop[5]->SetInputConnection(face[3]);
-                face[3] = m_FaceCrop[5]->GetOutputPort();
+                GetFaceCrop(5)->SetInputConnection(face[3]);
+                face[3] = GetFaceCrop(5)->GetOutputPort();
             }
             if (face[4] != 0)
             {
-                m_FaceCrop[6]->SetInputConnection(face[4]);
-                face[4] = m_FaceCrop[6]->GetOutputPort();
+                GetFaceCrop(6)->SetInputConnection(face[4]);
+                face[4] = GetFaceCrop(6)->GetOutputPort();
             }
             if (face[5] != 0)
             {
-                m_FaceCrop[7]->SetInputConnection(face[5]);
-                face[5] = m_FaceCrop[7]->GetOutputPort();
+                GetFaceCrop(7)->SetInputConnection(face[5]);
+                face[5] = GetFaceCrop(7)->GetOutputPort();
             }
         }
         if (m_CropBounds[2] > 0)
         {
             if (face[0] != 0)
             {
-                m_FaceCrop[8]->SetInputConnection(face[0]);
-                face[0] = m_FaceCrop[8]->GetOutputPort();
+                GetFaceCrop(8)->SetInputConnection(face[0]);
+                face[0] = GetFaceCrop(8)->GetOutputPort();
             }
             if (face[1] != 0)
             {
-                m_FaceCrop[9]->SetInputConnection(face[1]);
-                face[1] = m_FaceCrop[9]->GetOutputPort();
+                GetFaceCrop(9)->SetInputConnection(face[1]);
+                face[1] = GetFaceCrop(9)->GetOutputPort();
             }
             if (face[4] != 0)
             {
-                m_FaceCrop[10]->SetInputConnection(face[4]);
-                face[4] = m_FaceCrop[10]->GetOutputPort();
+                GetFaceCrop(10)->SetInputConnection(face[4]);
+                face[4] = GetFaceCrop(10)->GetOutputPort();
             }
             if (face[5] != 0)
             {
-                m_FaceCrop[11]->SetInputConnection(face[5]);
-                face[5] = m_FaceCrop[11]->GetOutputPort();
+                GetFaceCrop(11)->SetInputConnection(face[5]);
+                face[5] = GetFaceCrop(11)->GetOutputPort();
             }
         }
         if (m_CropBounds[3] < 1)
         {
             if (face[0] != 0)
             {
-                m_FaceCrop[12]->SetInputConnection(face[0]);
-                face[0] = m_FaceCrop[12]->GetOutputPort();
+                GetFaceCrop(12)->SetInputConnection(face[0]);
+                face[0] = GetFaceCrop(12)->GetOutputPort();
             }
             if (face[1] != 0)
             {
-                m_FaceCrop[13]->SetInputConnection(face[1]);
-                face[1] = m_FaceCrop[13]->GetOutputPort();
+                GetFaceCrop(13)->SetInputConnection(face[1]);
+                face[1] = GetFaceCrop(13)->GetOutputPort();
             }
             if (face[4] != 0)
             {
-                m_FaceCrop[14]->SetInputConnection(face[4]);
-                face[4] = m_FaceCrop[14]->GetOutputPort();
+                GetFaceCrop(14)->SetInputConnection(face[4]);
+                face[4] = GetFaceCrop(14)->GetOutputPort();
             }
             if (face[5] != 0)
             {
-                m_FaceCrop[15]->SetInputConnection(face[5]);
-                face[5] = m_FaceCrop[15]->GetOutputPort();
+                GetFaceCrop(15)->SetInputConnection(face[5]);
+                face[5] = GetFaceCrop(15)->GetOutputPort();
             }
         }
         if (m_CropBounds[4] > 0)
         {
             if (face[0] != 0)
             {
-                m_FaceCrop[16]->SetInputConnection(face[0]);
-                face[0] = m_FaceCrop[16]->GetOutputPort();
+                GetFaceCrop(16)->SetInputConnection(face[0]);
+                face[0] = GetFaceCrop(16)->GetOutputPort();
             }
             if (face[1] != 0)
             {
-                m_FaceCrop[17]->SetInputConnection(face[1]);
-                face[1] = m_FaceCrop[17]->GetOutputPort();
+                GetFaceCrop(17)->SetInputConnection(face[1]);
+                face[1] = GetFaceCrop(17)->GetOutputPort();
             }
             if (face[2] != 0)
             {
-                m_FaceCrop[18]->SetInputConnection(face[2]);
-                face[2] = m_FaceCrop[18]->GetOutputPort();
+                GetFaceCrop(18)->SetInputConnection(face[2]);
+                face[2] = GetFaceCrop(18)->GetOutputPort();
             }
             if (face[3] != 0)
             {
-                m_FaceCrop[19]->SetInputConnection(face[3]);
-                face[3] = m_FaceCrop[19]->GetOutputPort();
+                GetFaceCrop(19)->SetInputConnection(face[3]);
+                face[3] = GetFaceCrop(19)->GetOutputPort();
             }
         }
         if (m_CropBounds[5] < 1)
         {
             if (face[0] != 0)
             {
-                m_FaceCrop[20]->SetInputConnection(face[0]);
-                face[0] = m_FaceCrop[20]->GetOutputPort();
+                GetFaceCrop(20)->SetInputConnection(face[0]);
+                face[0] = GetFaceCrop(20)->GetOutputPort();
             }
             if (face[1] != 0)
             {
-                m_FaceCrop[21]->SetInputConnection(face[1]);
-                face[1] = m_FaceCrop[21]->GetOutputPort();
+                GetFaceCrop(21)->SetInputConnection(face[1]);
+                face[1] = GetFaceCrop(21)->GetOutputPort();
             }
             if (face[2] != 0)
             {
-                m_FaceCrop[22]->SetInputConnection(face[2]);
-                face[2] = m_FaceCrop[22]->GetOutputPort();
+                GetFaceCrop(22)->SetInputConnection(face[2]);
+                face[2] = GetFaceCrop(22)->GetOutputPort();
             }
             if (face[3] != 0)
             {
-                m_FaceCrop[23]->SetInputConnection(face[3]);
-                face[3] = m_FaceCrop[23]->GetOutputPort();
+                GetFaceCrop(23)->SetInputConnection(face[3]);
+                face[3] = GetFaceCrop(23)->GetOutputPort();
             }
         }
 
@@ -4711,83 +5043,88 @@ void mvManager::BuildPipelineForSolid()
 
 void mvManager::BuildPipelineForIsosurface()
 {
+    if (m_UpdateDepth > 0)
+    {
+        m_PendingIsosurfacePipeline = ++m_UpdateRequests;
+        return;
+    }
     vtkAlgorithmOutput *previousAlgorithmOutput = m_Isosurface->GetOutputPort();
     if (m_CropBounds[0] == m_CropBounds[1])
     {
-        m_IsosurfaceCutter[0]->SetInputConnection(previousAlgorithmOutput);
-        previousAlgorithmOutput = m_IsosurfaceCutter[0]->GetOutputPort();
+        GetIsosurfaceCutter(0)->SetInputConnection(previousAlgorithmOutput);
+        previousAlgorithmOutput = GetIsosurfaceCutter(0)->GetOutputPort();
         if (m_CropBounds[0] == 0)
         {
-            m_IsosurfaceCutter[0]->SetCutFunction(m_Plane[0]);
+            GetIsosurfaceCutter(0)->SetCutFunction(m_Plane[0]);
         }
         else
         {
-            m_IsosurfaceCutter[0]->SetCutFunction(m_Plane[1]);
+            GetIsosurfaceCutter(0)->SetCutFunction(m_Plane[1]);
         }
     }
     else
     {
         if (m_CropBounds[0] > 0)
         {
-            m_Cropper[0]->SetInputConnection(previousAlgorithmOutput);
-            previousAlgorithmOutput = m_Cropper[0]->GetOutputPort();
+            GetCropper(0)->SetInputConnection(previousAlgorithmOutput);
+            previousAlgorithmOutput = GetCropper(0)->GetOutputPort();
         }
         if (m_CropBounds[1] < 1)
         {
-            m_Cropper[1]->SetInputConnection(previousAlgorithmOutput);
-            previousAlgorithmOutput = m_Cropper[1]->GetOutputPort();
+            GetCropper(1)->SetInputConnection(previousAlgorithmOutput);
+            previousAlgorithmOutput = GetCropper(1)->GetOutputPort();
         }
     }
     if (m_CropBounds[2] == m_CropBounds[3])
     {
-        m_IsosurfaceCutter[1]->SetInputConnection(previousAlgorithmOutput);
-        previousAlgorithmOutput = m_IsosurfaceCutter[1]->GetOutputPort();
+        GetIsosurfaceCutter(1)->SetInputConnection(previousAlgorithmOutput);
+        previousAlgorithmOutput = GetIsosurfaceCutter(1)->GetOutputPort();
         if (m_CropBounds[2] == 0)
         {
-            m_IsosurfaceCutter[1]->SetCutFunction(m_Plane[2]);
+            GetIsosurfaceCutter(1)->SetCutFunction(m_Plane[2]);
         }
         else
         {
-            m_IsosurfaceCutter[1]->SetCutFunction(m_Plane[3]);
+            GetIsosurfaceCutter(1)->SetCutFunction(m_Plane[3]);
         }
     }
     else
     {
         if (m_CropBounds[2] > 0)
         {
-            m_Cropper[2]->SetInputConnection(previousAlgorithmOutput);
-            previousAlgorithmOutput = m_Cropper[2]->GetOutputPort();
+            GetCropper(2)->SetInputConnection(previousAlgorithmOutput);
+            previousAlgorithmOutput = GetCropper(2)->GetOutputPort();
         }
         if (m_CropBounds[3] < 1)
         {
-            m_Cropper[3]->SetInputConnection(previousAlgorithmOutput);
-            previousAlgorithmOutput = m_Cropper[3]->GetOutputPort();
+            GetCropper(3)->SetInputConnection(previousAlgorithmOutput);
+            previousAlgorithmOutput = GetCropper(3)->GetOutputPort();
         }
     }
     if (m_CropBounds[4] == m_CropBounds[5])
     {
-        m_IsosurfaceCutter[2]->SetInputConnection(previousAlgorithmOutput);
-        previousAlgorithmOutput = m_IsosurfaceCutter[2]->GetOutputPort();
+        GetIsosurfaceCutter(2)->SetInputConnection(previousAlgorithmOutput);
+        previousAlgorithmOutput = GetIsosurfaceCutter(2)->GetOutputPort();
         if (m_CropBounds[4] == 0)
         {
-            m_IsosurfaceCutter[2]->SetCutFunction(m_Plane[4]);
+            GetIsosurfaceCutter(2)->SetCutFunction(m_Plane[4]);
         }
         else
         {
-            m_IsosurfaceCutter[2]->SetCutFunction(m_Plane[5]);
+            GetIsosurfaceCutter(2)->SetCutFunction(m_Plane[5]);
         }
     }
     else
     {
         if (m_CropBounds[4] > 0)
         {
-            m_Cropper[4]->SetInputConnection(previousAlgorithmOutput);
-            previousAlgorithmOutput = m_Cropper[4]->GetOutputPort();
+            GetCropper(4)->SetInputConnection(previousAlgorithmOutput);
+            previousAlgorithmOutput = GetCropper(4)->GetOutputPort();
         }
         if (m_CropBounds[5] < 1)
         {
-            m_Cropper[5]->SetInputConnection(previousAlgorithmOutput);
-            previousAlgorithmOutput = m_Cropper[5]->GetOutputPort();
+            GetCropper(5)->SetInputConnection(previousAlgorithmOutput);
+            previousAlgorithmOutput = GetCropper(5)->GetOutputPort();
         }
     }
     m_IsosurfaceMapper->SetInputConnection(previousAlgorithmOutput);
@@ -4804,27 +5141,27 @@ void mvManager::BuildPipelineForIsosurface()
     {
         if (m_CropBounds[0] > 0)
         {
-            m_CroppedAwayPieces->AddInputData(m_Cropper[0]->GetClippedOutput());
+            m_CroppedAwayPieces->AddInputData(GetCropper(0)->GetClippedOutput());
         }
         if (m_CropBounds[1] < 1)
         {
-            m_CroppedAwayPieces->AddInputData(m_Cropper[1]->GetClippedOutput());
+            m_CroppedAwayPieces->AddInputData(GetCropper(1)->GetClippedOutput());
         }
         if (m_CropBounds[2] > 0)
         {
-            m_CroppedAwayPieces->AddInputData(m_Cropper[2]->GetClippedOutput());
+            m_CroppedAwayPieces->AddInputData(GetCropper(2)->GetClippedOutput());
         }
         if (m_CropBounds[3] < 1)
         {
-            m_CroppedAwayPieces->AddInputData(m_Cropper[3]->GetClippedOutput());
+            m_CroppedAwayPieces->AddInputData(GetCropper(3)->GetClippedOutput());
         }
         if (m_CropBounds[4] > 0)
         {
-            m_CroppedAwayPieces->AddInputData(m_Cropper[4]->GetClippedOutput());
+            m_CroppedAwayPieces->AddInputData(GetCropper(4)->GetClippedOutput());
         }
         if (m_CropBounds[5] < 1)
         {
-            m_CroppedAwayPieces->AddInputData(m_Cropper[5]->GetClippedOutput());
+            m_CroppedAwayPieces->AddInputData(GetCropper(5)->GetClippedOutput());
         }
     }
 }
@@ -4881,6 +5218,7 @@ char *mvManager::Serialize(const char *fileName, mvGUISettings *gui) const
     int numDataTypes = m_DataSource->GetNumberOfScalarDataTypes();
     out << "Data type count = " << numDataTypes << endl;
     out << "Data type active = " << m_ActiveDataType << endl;
+    out << "Reference time point = " << GetReferenceTimePoint() << endl;
 
     // Color bar, solid and isosurface control
     const double *rgb = GetColorBarTextColor();
@@ -4991,6 +5329,7 @@ char *mvManager::Serialize(const char *fileName, mvGUISettings *gui) const
 
         out << "Vector Log transform = " << m_VectorLog10Transform << endl;
         out << "Vector Line Width = " << m_VectorActor->GetProperty()->GetLineWidth() << endl;
+        out << "Vector screen spacing = " << m_VectorScreenSpacing << endl;
     }
 
     // Pathlines
@@ -5122,7 +5461,7 @@ char *mvManager::Serialize(const char *fileName, mvGUISettings *gui) const
     out << "Visibility Overlay = " << m_Overlay->GetVisibility() << endl;
 
     // Overlay
-    if (m_Overlay->HasData())
+    if (HasOverlay())
     {
         std::string relative = mvSaveCurrentDirectory::GetRelativePath(fileName, m_Overlay->GetFileName());
         out << "Overlay file = " << relative << endl;
@@ -5150,11 +5489,10 @@ char *mvManager::Serialize(const char *fileName, mvGUISettings *gui) const
 }
 
 // Read parameters from file
-void mvManager::Deserialize(const char *fileName, mvGUISettings *gui, std::string &errorMsg)
+int mvManager::BeginDeserialize(const char *fileName, mvSessionFile &session, std::string &errorMsg)
 {
-    int    i, ivalue, i1, i2, i3, i4, i5, i6, i7, i8, i9;
-    double fvalue, f1, f2, f3, f4, f5, f6;
-    char   key[100], buffer[1024];
+    int  i;
+    char key[100], buffer[1024];
 
     // Open an input stream
     ifstream in(fileName, std::ifstream::in);
@@ -5162,11 +5500,12 @@ void mvManager::Deserialize(const char *fileName, mvGUISettings *gui, std::strin
     if (!in.is_open())
     {
         errorMsg = "Unable to open the Model Viewer file.";
-        return;
+        return 0;
     }
 
     // Create a hash table and read the data file into the hash table
     mvHashTable *hashTable = new mvHashTable;
+    session.m_HashTable    = hashTable;
     while (!in.eof())
     {
         if (mvUtil::ExtractLabelAndValue(&in, key, buffer))
@@ -5181,32 +5520,29 @@ void mvManager::Deserialize(const char *fileName, mvGUISettings *gui, std::strin
     hashTable->GetHashTableValue("Application name", buffer);
     if (strcmp(buffer, "Model Viewer") != 0)
     {
-        delete hashTable;
         errorMsg = "This file does not contain data for Model Viewer";
-        return;
+        return 0;
     }
     buffer[0] = '\0';
     hashTable->GetHashTableValue("Version", buffer);
     if (strcmp(buffer, MV_VERSION) != 0)
     {
-        delete hashTable;
         std::ostringstream oss;
         oss << "This file does not contain data for Model Viewer version " << MV_VERSION;
         errorMsg = oss.str();
-        return;
+        return 0;
     }
 
     // Read data file names
-    char modelName[1024];
-    modelName[0] = '\0';
+    char *modelName = session.m_ModelName;
+    modelName[0]    = '\0';
     hashTable->GetHashTableValue("Model name", modelName);
     int ncode = 0;
     hashTable->GetHashTableValue("File code count", ncode);
     if (ncode == 0)
     {
-        delete hashTable;
         errorMsg = "The Model Viewer file is damaged and cannot be loaded.";
-        return;
+        return 0;
     }
 
     // Get absolute paths for all file codes
@@ -5215,16 +5551,15 @@ void mvManager::Deserialize(const char *fileName, mvGUISettings *gui, std::strin
     char        fullpath[MAX_PATH];
     char *      dataFileList = new char[ncode * 1024];
     dataFileList[0]          = '\0';
+    session.m_DataFileList   = dataFileList;
     for (i = 0; i < ncode; i++)
     {
         buffer[0] = '\0';
         sprintf(key, "File code %u", i + 1);
         if (!hashTable->GetHashTableValue(key, buffer))
         {
-            delete hashTable;
-            delete[] dataFileList;
             errorMsg = "The Model Viewer file is damaged and cannot be loaded.";
-            return;
+            return 0;
         }
         if (strlen(buffer))
         {
@@ -5245,12 +5580,10 @@ void mvManager::Deserialize(const char *fileName, mvGUISettings *gui, std::strin
             }
             if (!QFileInfo::exists(fullpath))
             {
-                delete hashTable;
-                delete[] dataFileList;
                 std::ostringstream oss;
                 oss << "Unable to open \"" << filepath.toLocal8Bit().constData() << "\".";
                 errorMsg = oss.str();
-                return;
+                return 0;
             }
             strcat(dataFileList, fullpath.toLocal8Bit().constData());
 #else
@@ -5259,12 +5592,10 @@ void mvManager::Deserialize(const char *fileName, mvGUISettings *gui, std::strin
             mvUtil::PathCanonicalizeA(fullpath, szDest);
             if (!mvUtil::PathFileExistsA(fullpath))
             {
-                delete hashTable;
-                delete[] dataFileList;
                 std::ostringstream oss;
                 oss << "Unable to open \"" << fullpath << "\".";
                 errorMsg = oss.str();
-                return;
+                return 0;
             }
             strcat(dataFileList, fullpath);
 #endif
@@ -5276,28 +5607,52 @@ void mvManager::Deserialize(const char *fileName, mvGUISettings *gui, std::strin
         strcat(dataFileList, "\n");
     }
 
-    std::shared_ptr<mvSaveCurrentDirectory> spCurDir;
-    if (ncode == 1)
+    // this assumes that the remaining files are relative
+    // to the first file (which should be the name file (*.nam - not mfsim.nam).
+    // A second file code, such as a comparison head file, is already an
+    // absolute path in dataFileList.
+    //
+    // save current directory and cd to the directory of the first file
+    std::string nameFile(dataFileList, strcspn(dataFileList, "\n"));
+    if (!nameFile.empty())
     {
-        // this assumes that the remaining files are relative
-        // to this file (which should be the name file (*.nam - not mfsim.nam)
-        // 
-        // save current directory and cd to dataFileList
-        spCurDir.reset(new mvSaveCurrentDirectory(dataFileList));
+        session.m_CurrentDirectory.reset(new mvSaveCurrentDirectory(nameFile.c_str()));
     }
 
-    // Load the data and set up the visualization pipeline
+    return 1;
+}
 
-    const char *err = LoadData(modelName, dataFileList);
-    delete[] dataFileList;
+void mvManager::Deserialize(const char *fileName, mvGUISettings *gui, std::string &errorMsg)
+{
+    mvSessionFile session;
+    if (!BeginDeserialize(fileName, session, errorMsg))
+    {
+        return;
+    }
 
+    // Load the data and set up the visualization pipeline
+    mvDataSource *dataSource = nullptr;
+    const char   *err        = ReadDataSource(session.GetModelName(), session.GetDataFileList(), dataSource);
     if (err)
     {
-        delete hashTable;
         errorMsg = err;
         return;
     }
+    EndDeserialize(fileName, session, dataSource, gui);
+}
+
+void mvManager::EndDeserialize(const char *fileName, mvSessionFile &session, mvDataSource *dataSource, mvGUISettings *gui)
+{
+    int          i, ivalue, i1, i2, i3, i4, i5, i6, i7, i8, i9;
+    double       fvalue, f1, f2, f3, f4, f5, f6;
+    char         key[100], buffer[1024];
+    mvHashTable *hashTable = session.m_HashTable;
+    std::string  dirname   = mvSaveCurrentDirectory::GetDirName(fileName);
+
+    SetDataSource(dataSource);
 
+    // the pipelines are rebuilt once, after all the settings are applied
+    BeginUpdate();
     SetTimePointTo(m_DataSource->GetInitialDisplayTimePoint());
     SetScalarDataTypeTo(0);
     ApplyDefaultSettings();
@@ -5694,6 +6049,10 @@ void mvManager::Deserialize(const char *fileName, mvGUISettings *gui, std::strin
                 m_NumberOfCustomIsosurfaces  = numberOfCustomIsosurfaces;
                 m_CustomIsosurfaceValues     = customIsosurfaceValues;
 
+                if (hashTable->GetHashTableValue("Reference time point", ivalue))
+                {
+                    m_DataSource->SetReferenceTimePoint(ivalue);
+                }
                 if (hashTable->GetHashTableValue("Data type active", ivalue))
                 {
                     SetScalarDataTypeTo(ivalue);
@@ -5902,6 +6261,10 @@ void mvManager::Deserialize(const char *fileName, mvGUISettings *gui, std::strin
         {
             SetVectorScaleFactor(fvalue);
         }
+        if (hashTable->GetHashTableValue("Vector screen spacing", ivalue))
+        {
+            SetVectorScreenSpacing(ivalue);
+        }
     }
 
     // Pathline
@@ -6068,15 +6431,19 @@ void mvManager::Deserialize(const char *fileName, mvGUISettings *gui, std::strin
     if (hashTable->GetHashTableValue("Overlay file", filename))
     {
         SetOverlayFileName(mvSaveCurrentDirectory::GetFullPath(filename, dirname.c_str()).c_str());
-        if (!UpdateOverlay(errMsg))
+        // A hidden overlay is read when it is first shown
+        if (!IsOverlayVisible())
+        {
+            m_OverlayPending = 1;
+        }
+        else if (!UpdateOverlay(errMsg))
         {
             strcat(m_WarningMessage, "Unable to load overlay file. Overlay will not be displayed.");
         }
     }
+    EndUpdate();
 
     gui->Deserialize(hashTable);
-
-    delete hashTable;
 }
 
 char *mvManager::GetDataFileList() const
@@ -6117,12 +6484,30 @@ int mvManager::HasPathlineData() const
 
 int mvManager::HasOverlay()
 {
-    return m_Overlay->HasData();
+    return m_Overlay->HasData() || m_OverlayPending;
+}
+
+int mvManager::IsOverlayPending() const
+{
+    return m_OverlayPending;
+}
+
+void mvManager::LoadPendingOverlay()
+{
+    if (m_OverlayPending)
+    {
+        const char *errMsg = nullptr;
+        UpdateOverlay(errMsg);
+    }
 }
 
 void mvManager::ShowOverlay()
 {
-    m_Overlay->VisibilityOn();
+    LoadPendingOverlay();
+    if (m_Overlay->HasData())
+    {
+        m_Overlay->VisibilityOn();
+    }
 }
 
 void mvManager::HideOverlay()
@@ -6137,6 +6522,7 @@ int mvManager::IsOverlayVisible() const
 
 void mvManager::ClearOverlayData()
 {
+    m_OverlayPending = 0;
     m_Overlay->ClearData();
 }
 
@@ -6192,9 +6578,29 @@ void mvManager::SetOverlayDrapeGap(double d)
 
 int mvManager::UpdateOverlay(const char *errMsg)
 {
+    m_OverlayPending = 0;
     return m_Overlay->Update(errMsg);
 }
 
+void mvManager::UpdateOverlayResolution(double worldUnitsPerPixel)
+{
+    // Called by the view whenever the zoom may have changed. Arcs are drawn
+    // to within half a pixel. The tolerance is rounded down to a power of
+    // two so that the arcs are only tessellated again when the zoom
+    // changes by a factor of two.
+    const double *s         = GetScale();
+    double        tolerance = 0.5 * worldUnitsPerPixel / std::max(s[0], s[1]);
+    if (tolerance > 0)
+    {
+        tolerance = pow(2.0, floor(log(tolerance) / log(2.0)));
+    }
+    else
+    {
+        tolerance = 0;
+    }
+    m_Overlay->SetArcTolerance(tolerance);
+}
+
 char *mvManager::GetOverlayFileName()
 {
     return m_Overlay->GetFileName();
@@ -6252,6 +6658,7 @@ void mvManager::GetOverlayBounds(double &xmin, double &xmax, double &ymin, doubl
 
 void mvManager::RemoveOverlay()
 {
+    m_OverlayPending = 0;
     m_Overlay->ClearData();
     m_Overlay->SetFileName(0);
     m_Overlay->SetCoordinatesAtGridOrigin(0, 0);
@@ -10,10 +10,13 @@
 #include <math.h>
 #include <typeinfo>
 #include <algorithm>
+#include <memory>
 #include <string>
 
 class mvCustomAppendPolyData;
 class mvGUISettings;
+class mvHashTable;
+class mvSaveCurrentDirectory;
 class mvPathlines;
 class mvGridLines;
 class mvGridLayer;
@@ -25,6 +28,8 @@ class mvColorBar;
 class mvDisplayText;
 class mvOverlay;
 class mvClipBox;
+class mvInteractionLOD;
+class mvPointBinSampler;
 
 class vtkActor;
 class vtkBandedPolyDataContourFilter;
@@ -37,7 +42,7 @@ class vtkDataSetMapper;
 class vtkExtractGrid;
 class vtkExtractCells;
 class vtkGeometryFilter;
-class vtkGlyph3D;
+class vtkGlyph3DMapper;
 class vtkHedgeHog;
 class vtkLookupTable;
 class vtkLogLookupTable;
@@ -58,6 +63,32 @@ class vtkUnstructuredGrid;
 using std::max;
 using std::min;
 
+/**
+ * The contents of a Model Viewer file between mvManager::BeginDeserialize
+ * and mvManager::EndDeserialize. While this object exists, the current
+ * directory is the one the data files are read relative to.
+ */
+class MV_EXPORT mvSessionFile
+{
+public:
+    mvSessionFile();
+    ~mvSessionFile();
+
+    char *GetModelName() { return m_ModelName; }
+    char *GetDataFileList() { return m_DataFileList; }
+
+protected:
+    friend class mvManager;
+
+    mvHashTable                            *m_HashTable;
+    char                                    m_ModelName[1024];
+    char                                   *m_DataFileList;
+    std::shared_ptr<mvSaveCurrentDirectory> m_CurrentDirectory;
+};
+
+// Number of actors drawn with coarse versions during interaction
+#define MV_NUM_INTERACTION_LOD 8
+
 class MV_EXPORT mvManager
 {
 public:
@@ -71,6 +102,15 @@ public:
     // void ClearData();
     const mvDataSource *               GetDataSource() const;
     const char *                       LoadData(char *modelType, char *dataFileList);
+    // LoadData in two steps. ReadDataSource reads the data files without touching
+    // the pipeline, so it may run in a worker thread. SetDataSource takes ownership
+    // of the data source and sets up the pipeline, and must run in the GUI thread.
+    static const char *                ReadDataSource(char *modelType, char *dataFileList, mvDataSource *&dataSource,
+                                                      mvLoadProgress *progress = nullptr);
+    void                               SetDataSource(mvDataSource *dataSource);
+    // Single precision grid coordinates, applied when data are loaded
+    void                               SetSinglePrecision(int singlePrecision) { m_SinglePrecision = singlePrecision; }
+    int                                GetSinglePrecision() const { return m_SinglePrecision; }
     char                              *GetDataFileList() const;
     int                                HasVectorData() const;
     int                                HasPathlineData() const;
@@ -78,6 +118,10 @@ public:
     GridType                           GetGridType() const;
     bool                               GetIsStructuredGrid();
     void                               ApplyDefaultSettings();
+    // Changes made between BeginUpdate and EndUpdate rebuild the solid and
+    // isosurface pipelines only once, in EndUpdate. Calls may be nested.
+    void                               BeginUpdate();
+    void                               EndUpdate();
 #if ((VTK_MAJOR_VERSION == 8) && (VTK_MINOR_VERSION <= 1) || (VTK_MAJOR_VERSION < 8))  //  https://vtk.org/Wiki/VTK/API_Changes_8_0_1_to_8_1_0
     void                               SetImmediateModeRendering(int b);  // deprecated vtk 8.1
 #endif
@@ -88,11 +132,16 @@ public:
     vtkSmartPointer<vtkPropCollection> GetPropCollection() const { return m_PropCollection; }
     int                                GetNumberOfTimePoints() const;
     char                             **GetTimePointLabels();
+    const double                      *GetTimePoints();
+    int                                UpdateTimePoints();
     int                                GetNumberOfScalarDataTypes() const;
     char                             **GetDataTypeLabels() const;
     int                                GetCurrentTimePointIndex() const { return m_TimePointIndex; }
     void                               SetScalarDataTypeTo(int dataTypeIndex);
     int                                GetActiveScalarDataType() const { return m_ActiveDataType; }
+    // Time point that drawdown is measured from
+    void                               SetReferenceTimePoint(int timePointIndex);
+    int                                GetReferenceTimePoint() const;
     const char *                       GetActiveScalarDataName() const;
     ScalarMode                         GetPrimaryScalarMode() const;
     const char *                       GetModelName() const;
@@ -100,6 +149,12 @@ public:
     void                               SetTimePointTo(int timePointIndex);
     void                               AdvanceOneTimePoint();
     int                                GetInitialDisplayTimePoint();
+    // Values of cells at all time points, for hydrographs. FindScalarCell returns
+    // the cell at a picked point on the surface with the given normal, or -1.
+    int                                FindScalarCell(const double *point, const double *normal);
+    int                                GetTimeSeries(int numCells, const int *cells, double *values);
+    std::string                        GetCellDescription(int cell);
+    double                             GetInactiveCellValue() const;
     char                              *GetWarningMessage() { return m_WarningMessage; }
     void                               ClearWarningMessage() { m_WarningMessage[0] = '\0'; }
 
@@ -135,6 +190,9 @@ public:
     void                               SubsampleVectors(int imin, int imax, int irate, int jmin, int jmax, int jrate,
                                                         int kmin, int kmax, int krate);
     void                               GetVectorSubsampleExtentAndRate(int *extent, int *rate);
+    void                               SetVectorScreenSpacing(int pixels);
+    int                                GetVectorScreenSpacing() const { return m_VectorScreenSpacing; }
+    void                               UpdateVectorBinSize(double worldUnitsPerPixel);
     void                               VectorThresholdOn();
     void                               VectorThresholdOff();
     int                                IsVectorThresholdOn() const;
@@ -192,6 +250,9 @@ public:
 
     // Overlay
     int                                HasOverlay();
+    // True if the overlay file of a session has not been read yet because
+    // the overlay has not been shown. Its bounds are not known until then.
+    int                                IsOverlayPending() const;
     void                               ShowOverlay();
     void                               HideOverlay();
     int                                IsOverlayVisible() const;
@@ -218,6 +279,7 @@ public:
     int                                GetOverlayCrop();
     void                               GetOverlayBounds(double &xmin, double &xmax, double &ymin, double &ymax);
     int                                UpdateOverlay(const char *errMsg);
+    void                               UpdateOverlayResolution(double worldUnitsPerPixel);
     void                               RemoveOverlay();
 
     // Grid shell
@@ -345,6 +407,11 @@ public:
     double                             GetSpecularLighting() const;
     double                             GetSpecularPower() const;
 
+    // Reduced detail while the view is rotated or zoomed
+    void                               BeginInteraction();
+    void                               EndInteraction();
+    void                               UpdateInteractionLOD();
+
     // X-Y-Z Scaling
     void                               SetScale(double xScale, double yScale, double zScale);
     const double                      *GetScale() const;
@@ -388,6 +455,11 @@ public:
     // Serialization
     char                              *Serialize(const char *fileName, mvGUISettings *gui) const;
     void                               Deserialize(const char *fileName, mvGUISettings *gui, std::string &errorMsg);
+    // Deserialize in steps: BeginDeserialize reads the Model Viewer file, the data files are
+    // then read with ReadDataSource, and EndDeserialize sets up the pipeline and applies the
+    // settings in the file. BeginDeserialize returns 0 on error.
+    int                                BeginDeserialize(const char *fileName, mvSessionFile &session, std::string &errorMsg);
+    void                               EndDeserialize(const char *fileName, mvSessionFile &session, mvDataSource *dataSource, mvGUISettings *gui);
 
 protected:
     int                                             m_ActivatedGridLinesVisibility;
@@ -397,17 +469,28 @@ protected:
     int                                             m_GridLinesActivated[3];
     int                                             m_NumScalarDataTypes;
     int                                             m_PathlineTimeClippingMode;
+    int                                             m_ScalarSubgridExtent[6];
     int                                             m_ShowCroppedAwayPieces;
     int                                             m_TimePointIndex; // used to keep track of time point when animating
     int                                             m_VectorClippingAngle;
     int                                             m_VectorGlyphActivated;
     int                                             m_VectorLog10Transform;
     int                                             m_VectorSubsampleOffset[3];
+    int                                             m_VectorScreenSpacing;
     int                                             m_GridDisplayMode;
+    int                                             m_SinglePrecision;
+    // Nesting depth of BeginUpdate, and the work deferred to EndUpdate. The
+    // pipelines share filters, so they are rebuilt in the order requested;
+    // each pending flag is the position of its last request, or 0.
+    int                                             m_UpdateDepth;
+    int                                             m_UpdateRequests;
+    int                                             m_PendingSolidPipeline;
+    int                                             m_PendingIsosurfacePipeline;
     double                                          m_CropAngle;
     double                                          m_MinPositiveVector;
     double                                          m_PathlineClipTimeMax;
     double                                          m_PathlineClipTimeMin;
+    double                                          m_VectorWorldUnitsPerPixel;
     double                                          m_VectorClippingXMin;
     double                                          m_VectorClippingXMax;
     double                                          m_VectorClippingYMin;
@@ -474,7 +557,7 @@ protected:
     vtkSmartPointer<vtkPolyDataMapper>              m_CroppedAwayPiecesMapper;
     vtkSmartPointer<vtkPolyDataMapper>              m_IsosurfaceMapper;
     vtkSmartPointer<vtkPolyDataMapper>              m_VectorMapper;
-    vtkSmartPointer<vtkPolyDataMapper>              m_VectorGlyphMapper;
+    vtkSmartPointer<vtkGlyph3DMapper>               m_VectorGlyphMapper;
 
     // Lookup tables
     vtkLookupTable                                 *m_LutRedToBlue;
@@ -484,6 +567,8 @@ protected:
     vtkLookupTable                                 *m_LutCustomScale;
     vtkLookupTable                                 *m_LutReversedCustomScale;
 
+    // Created by CreateLogLookupTables when a logarithmic color bar is
+    // first used
     vtkLogLookupTable                              *m_LogLutRedToBlue;
     vtkLogLookupTable                              *m_LogLutBlueToRed;
     vtkLogLookupTable                              *m_LogLutModifiedRedToBlue;
@@ -522,9 +607,12 @@ protected:
     vtkSmartPointer<vtkGeometryFilter>              m_BlockySolid;
     vtkSmartPointer<vtkExtractCells>                m_ExtractCellsForSubgrid;
 
-    // Filters for cropping
+    // Filters for cropping. The croppers, face extractors, face croppers
+    // and isosurface cutters are created by their Get methods when the
+    // pipeline first needs them.
     vtkSmartPointer<vtkPlane>                       m_Plane[6];
     vtkSmartPointer<vtkClipPolyData>                m_Cropper[6];
+    int                                             m_ReleaseDataFlag;
 
     // Cropped Solid
     vtkSmartPointer<vtkCutter>                      m_ExtractFace[6];
@@ -541,7 +629,7 @@ protected:
 
     // Filter to create vector lines
     vtkSmartPointer<vtkExtractGrid>                 m_ExtractStructuredGridVector;
-    //	vtkSmartPointer<vtkMaskPoints> m_ExtractUnstructuredGridVector;
+    vtkSmartPointer<mvPointBinSampler>              m_ExtractUnstructuredGridVector;
     vtkSmartPointer<vtkExtractGeometry>             m_CropVectors;
     mvClipBox                                      *m_CropBoxForVectors;
 
@@ -549,7 +637,6 @@ protected:
     vtkSmartPointer<vtkThresholdPoints>             m_VectorThreshold;
     vtkSmartPointer<vtkHedgeHog>                    m_HedgeHog;
     vtkSmartPointer<vtkCubeSource>                  m_CubeSource;
-    vtkSmartPointer<vtkGlyph3D>                     m_VectorGlyph;
 
     mvPathlines                                    *m_Pathlines;
     mvGridLines                                    *m_GridLines[3];
@@ -565,17 +652,31 @@ protected:
     mvDisplayText                                  *m_Title;
 
     mvOverlay                                      *m_Overlay;
+    // Set when a session names an overlay that is hidden. The overlay file
+    // is not read until the overlay is first shown or updated.
+    int                                             m_OverlayPending;
+
+    // Coarse versions of the solid, cropped away pieces, grid shell,
+    // grid lines, overlay and model features
+    mvInteractionLOD                               *m_InteractionLOD[MV_NUM_INTERACTION_LOD];
 
     // Protected methods
     //	void SetAllCellsAreActive(int b);
     void                                            ComputeActiveScalarRange();
+    void                                            LoadPendingOverlay();
     void                                            ComputeVectorMagnitudes();
     void                                            OnDataModified();
+    void                                            UpdateDataSourceSubgrid();
     void                                            UpdateScaledVectorArray();
     void                                            UpdateColorBands();
     void                                            UpdateCrop();
     void                                            BuildPipelineForSolid();
     void                                            BuildPipelineForIsosurface();
+    vtkClipPolyData                                *GetCropper(int i);
+    vtkCutter                                      *GetExtractFace(int i);
+    vtkClipPolyData                                *GetFaceCrop(int i);
+    vtkCutter                                      *GetIsosurfaceCutter(int i);
+    void                                            CreateLogLookupTables();
     //	void ReleaseArrayMemory();
     //	void UpdateLogTransformedData();
 
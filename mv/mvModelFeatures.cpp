@@ -4,7 +4,7 @@
 #include "vtkPolyData.h"
 #include "vtkPointData.h"
 #include "vtkPoints.h"
-#include "vtkGlyph3D.h"
+#include "vtkGlyph3DMapper.h"
 #include "vtkCubeSource.h"
 #include "vtkStructuredGrid.h"
 #include "vtkThreshold.h"
@@ -51,7 +51,7 @@ mvModelFeatures::mvModelFeatures()
 
     // Objects for glyph display
     m_PolyData        = vtkSmartPointer<vtkPolyData>::New();
-    m_Glyph           = vtkSmartPointer<vtkGlyph3D>::New();
+    m_GlyphMapper     = vtkSmartPointer<vtkGlyph3DMapper>::New();
     m_CubeSource      = vtkSmartPointer<vtkCubeSource>::New();
     m_ThresholdPoints = vtkSmartPointer<vtkThresholdPoints>::New();
     m_ThresholdPoints->ThresholdBetween(0.5, 10000);
@@ -60,10 +60,14 @@ mvModelFeatures::mvModelFeatures()
     m_ThresholdPoints->SetInputData(m_PolyData);
     m_TransformFilter->SetInputConnection(m_ThresholdPoints->GetOutputPort());
     m_TransformFilter->SetTransform(m_Transform);
-    m_Glyph->SetInputConnection(m_TransformFilter->GetOutputPort());
-    m_Glyph->SetScaleModeToDataScalingOff();
-    m_Glyph->SetColorModeToColorByScalar();
-    m_Glyph->SetSourceConnection(m_CubeSource->GetOutputPort());
+    // The glyph mapper draws one instance of the cube per point, so a change
+    // in the features only uploads the points and their scalars.
+    m_GlyphMapper->SetInputConnection(m_TransformFilter->GetOutputPort());
+    m_GlyphMapper->SetSourceConnection(m_CubeSource->GetOutputPort());
+    m_GlyphMapper->ScalingOff();
+    m_GlyphMapper->OrientOff();
+    m_GlyphMapper->SetColorModeToMapScalars();
+    m_GlyphMapper->SetLookupTable(m_Lut);
     m_DefaultGlyphSize   = 1;
     m_NumberOfGlyphs     = 0;
     m_Dim[0]             = 0;
@@ -77,6 +81,8 @@ mvModelFeatures::mvModelFeatures()
     m_Subgrid[5]         = 0;
     m_GlyphScalarArray   = 0;
     m_DisplayOrder       = 0;
+    m_FeatureOffset      = 0;
+    m_GlyphOffset        = 0;
     m_NumberOfCells      = 0;
     m_CellScalarArray    = 0;
     m_ModelFeatureArray  = 0;
@@ -100,6 +106,14 @@ mvModelFeatures::~mvModelFeatures()
     {
         delete[] m_CellScalarArray;
     }
+    if (m_FeatureOffset != 0)
+    {
+        delete[] m_FeatureOffset;
+    }
+    if (m_GlyphOffset != 0)
+    {
+        delete[] m_GlyphOffset;
+    }
 }
 
 void mvModelFeatures::SetDisplayMode(int displayMode)
@@ -147,7 +161,12 @@ void mvModelFeatures::SetModelFeatureArray(int *modelFeatureArray)
 {
     m_ModelFeatureArray = modelFeatureArray;
 
-    if (m_ModelFeatureArray == 0 || m_CellScalarArray == 0)
+    if (m_ModelFeatureArray == 0)
+    {
+        return;
+    }
+    BuildFeatureOffsets();
+    if (m_DisplayMode != MV_DISPLAY_MODEL_FEATURES_AS_GLYPHS && m_CellScalarArray == 0)
     {
         return;
     }
@@ -171,7 +190,12 @@ void mvModelFeatures::SetModelFeatureArray(int *modelFeatureArray)
 
     if (m_DisplayMode == MV_DISPLAY_MODEL_FEATURES_AS_GLYPHS)
     {
-        // TO DO: Implement this
+        // The number of features of each type can change from one
+        // stress period to the next, so the glyph points are regenerated.
+        if (m_DisplayOrder != 0)
+        {
+            UpdateGlyphs();
+        }
     }
     else
     {
@@ -194,12 +218,13 @@ void mvModelFeatures::SetGridPoints(vtkPoints *gridPoints)
 
 void mvModelFeatures::Build()
 {
-    int i, j, k, m;
+    int i;
     if (m_ModelFeatureArray == 0)
     {
         return;
     }
     m_Mapper->SetScalarRange(1, m_NumberOfModelFeatureTypes);
+    BuildFeatureOffsets();
     if (m_DisplayOrder != 0)
     {
         delete[] m_DisplayOrder;
@@ -214,48 +239,17 @@ void mvModelFeatures::Build()
     m_Actor->SetScale(1, 1, 1);
     if (m_DisplayMode == MV_DISPLAY_MODEL_FEATURES_AS_GLYPHS)
     {
-        SetMapperInputConnection(m_Glyph->GetOutputPort());
+        m_Actor->SetMapper(m_GlyphMapper);
+        m_LODActor->SetMapper(m_GlyphMapper);
+        m_GlyphMapper->SetScalarRange(1, m_NumberOfModelFeatureTypes);
         m_ThresholdPoints->ThresholdBetween(0.5, m_NumberOfModelFeatureTypes + 0.5);
-        int count = 0;
-        k         = 0;
-        for (i = 0; i < m_NumberOfModelFeatureTypes; i++)
-        {
-            count += m_ModelFeatureArray[k];
-            k += (m_ModelFeatureArray[k] + 1);
-        }
-        m_NumberOfGlyphs = count;
-        if (m_GlyphScalarArray != 0)
-        {
-            delete[] m_GlyphScalarArray;
-        }
-        m_GlyphScalarArray                      = new double[m_NumberOfGlyphs];
-        vtkSmartPointer<vtkPoints>      points  = vtkSmartPointer<vtkPoints>::New();
-        vtkSmartPointer<vtkDoubleArray> scalars = vtkSmartPointer<vtkDoubleArray>::New();
-        m                                       = 0;
-        k                                       = 0;
-        for (i = 0; i < m_NumberOfModelFeatureTypes; i++)
-        {
-            int numGlyph = m_ModelFeatureArray[k];
-            k++;
-            for (j = 0; j < numGlyph; j++)
-            {
-                double *p = m_GridPoints->GetPoint(m_ModelFeatureArray[k]);
-                points->InsertNextPoint(p[0], p[1], p[2]);
-                // Note that we start counting from 1. Also, all glyphs are
-                // set to be initially invisible.
-                m_GlyphScalarArray[m] = (double)(i + 1 + m_NumberOfModelFeatureTypes);
-                k++;
-                m++;
-            }
-        }
-        scalars->SetArray(m_GlyphScalarArray, m_NumberOfGlyphs, 1);
-
-        m_PolyData->SetPoints(points);
-        m_PolyData->GetPointData()->SetScalars(scalars);
+        BuildGlyphs();
     }
     else
     {
         SetMapperInputConnection(m_ThresholdCells->GetOutputPort());
+        m_Actor->SetMapper(m_Mapper);
+        m_LODActor->SetMapper(m_Mapper);
 #if ((VTK_MAJOR_VERSION == 9) && (VTK_MINOR_VERSION < 1) || (VTK_MAJOR_VERSION < 9))
         m_ThresholdCells->ThresholdBetween(0.5, m_NumberOfModelFeatureTypes + 0.5);    // deprecated as of VTK 9.1
 #else
@@ -391,6 +385,12 @@ void mvModelFeatures::SubgridOn()
             for (j = 0; j < numGlyph; j++)
             {
                 index = m_ModelFeatureArray[k];
+                if (index < 0)
+                {
+                    k++;
+                    m++;
+                    continue;
+                }
                 kk    = index / (m_Dim[0] * m_Dim[1]);
                 index -= kk * (m_Dim[0] * m_Dim[1]);
                 jj = index / m_Dim[0];
@@ -463,6 +463,98 @@ void mvModelFeatures::SubgridOff()
     m_SubgridIsActivated = 0;
 }
 
+void mvModelFeatures::BuildGlyphs()
+{
+    int i, j, k, m;
+    int count = 0;
+    k         = 0;
+    for (i = 0; i < m_NumberOfModelFeatureTypes; i++)
+    {
+        if (m_ModelFeatureArray[k] > 0)
+        {
+            count += m_ModelFeatureArray[k];
+            k += m_ModelFeatureArray[k];
+        }
+        k++;
+    }
+    m_NumberOfGlyphs = count;
+    if (m_GlyphScalarArray != 0)
+    {
+        delete[] m_GlyphScalarArray;
+    }
+    m_GlyphScalarArray                      = new double[m_NumberOfGlyphs];
+    vtkSmartPointer<vtkPoints>      points  = vtkSmartPointer<vtkPoints>::New();
+    vtkSmartPointer<vtkDoubleArray> scalars = vtkSmartPointer<vtkDoubleArray>::New();
+    points->SetNumberOfPoints(m_NumberOfGlyphs);
+    m                                       = 0;
+    k                                       = 0;
+    for (i = 0; i < m_NumberOfModelFeatureTypes; i++)
+    {
+        int numGlyph = m_ModelFeatureArray[k];
+        k++;
+        for (j = 0; j < numGlyph; j++)
+        {
+            int index = m_ModelFeatureArray[k];
+            if (index >= 0)
+            {
+                points->SetPoint(m, m_GridPoints->GetPoint(index));
+                // Note that we start counting from 1. Also, all glyphs are
+                // set to be initially invisible.
+                m_GlyphScalarArray[m] = (double)(i + 1 + m_NumberOfModelFeatureTypes);
+            }
+            else
+            {
+                // A scalar of zero is never displayed.
+                points->SetPoint(m, 0, 0, 0);
+                m_GlyphScalarArray[m] = 0;
+            }
+            k++;
+            m++;
+        }
+    }
+    scalars->SetArray(m_GlyphScalarArray, m_NumberOfGlyphs, 1);
+
+    m_PolyData->SetPoints(points);
+    m_PolyData->GetPointData()->SetScalars(scalars);
+}
+
+void mvModelFeatures::UpdateGlyphs()
+{
+    BuildGlyphs();
+    SetDisplayOrderForGlyphs();
+    if (m_SubgridIsActivated)
+    {
+        SubgridOn();
+    }
+}
+
+void mvModelFeatures::BuildFeatureOffsets()
+{
+    if (m_FeatureOffset != 0)
+    {
+        delete[] m_FeatureOffset;
+    }
+    if (m_GlyphOffset != 0)
+    {
+        delete[] m_GlyphOffset;
+    }
+    m_FeatureOffset = new int[m_NumberOfModelFeatureTypes];
+    m_GlyphOffset   = new int[m_NumberOfModelFeatureTypes];
+    int k           = 0;
+    int m           = 0;
+    for (int i = 0; i < m_NumberOfModelFeatureTypes; i++)
+    {
+        m_FeatureOffset[i] = k;
+        m_GlyphOffset[i]   = m;
+        if (m_ModelFeatureArray[k] > 0)
+        {
+            m += m_ModelFeatureArray[k];
+            k += m_ModelFeatureArray[k];
+        }
+        k++;
+    }
+}
+
 void mvModelFeatures::SetDisplayOrderForGlyphs()
 {
     int i, j, k, m, p, q;
@@ -489,49 +581,64 @@ void mvModelFeatures::SetDisplayOrderForGlyphs()
     }
 
     // Turn on glyphs respresnting features that are displayed
+    int *featureByOrder = FeaturesByDisplayOrder();
     for (p = 0; p < m_NumberOfModelFeatureTypes; p++)
     {
-        // p is the display order
-        for (j = 0; j < m_NumberOfModelFeatureTypes; j++)
+        // p is the display order, and j is the index of the model feature to be displayed
+        j = featureByOrder[p];
+        if (j < 0)
         {
-            if (m_DisplayOrder[j] == p)
+            continue;
+        }
+        // m is the starting index of the glyph scalar array where
+        // the scalar is to be modified to indicate that the glyph is shown.
+        // k is the index of the model feature array containing the
+        // number of glyphs representing the feature that is displayed
+        m = m_GlyphOffset[j];
+        k = m_FeatureOffset[j];
+        for (i = m, q = 1; i < m + m_ModelFeatureArray[k]; i++, q++)
+        {
+            // Display a glyph only when the node is unoccupied.
+            int mp = m_ModelFeatureArray[k + q];
+            if (mp >= 0 && marker[mp] == 0)
             {
-                // j is the index of the model feature to be displayed
-                k = 0;
-                m = 0;
-                for (i = 0; i < j; i++)
+                // mark the node as occupied.
+                marker[mp] = 1;
+                if (m_GlyphScalarArray[i] > 0)
                 {
-                    m += m_ModelFeatureArray[k];
-                    k += m_ModelFeatureArray[k] + 1;
+                    m_GlyphScalarArray[i] -= m_NumberOfModelFeatureTypes;
                 }
-                // m is the starting index of the glyph scalar array where
-                // the scalar is to be modified to indicate that the glyph is shown.
-                // k is the index of the model feature array containing the
-                // number of glyphs representing the feature that is displayed
-                for (i = m, q = 1; i < m + m_ModelFeatureArray[k]; i++, q++)
+                else
                 {
-                    // Display a glyph only when the node is unoccupied.
-                    int mp = m_ModelFeatureArray[k + q];
-                    if (marker[mp] == 0)
-                    {
-                        // mark the node as occupied.
-                        marker[mp] = 1;
-                        if (m_GlyphScalarArray[i] > 0)
-                        {
-                            m_GlyphScalarArray[i] -= m_NumberOfModelFeatureTypes;
-                        }
-                        else
-                        {
-                            m_GlyphScalarArray[i] += m_NumberOfModelFeatureTypes;
-                        }
-                    }
+                    m_GlyphScalarArray[i] += m_NumberOfModelFeatureTypes;
                 }
             }
         }
     }
+    delete[] featureByOrder;
     delete[] marker;
 }
 
+// Returns a new array holding, for each display order, the index of the
+// feature type shown at that order, or -1 if no feature type is shown there.
+int *mvModelFeatures::FeaturesByDisplayOrder()
+{
+    int *featureByOrder = new int[m_NumberOfModelFeatureTypes];
+    for (int p = 0; p < m_NumberOfModelFeatureTypes; p++)
+    {
+        featureByOrder[p] = -1;
+    }
+    for (int j = 0; j < m_NumberOfModelFeatureTypes; j++)
+    {
+        int p = m_DisplayOrder[j];
+        if (p >= 0 && p < m_NumberOfModelFeatureTypes)
+        {
+            featureByOrder[p] = j;
+        }
+    }
+    return featureByOrder;
+}
+
 void mvModelFeatures::SetDisplayOrderForCells()
 {
     int i, j, k, m, p;
@@ -548,38 +655,30 @@ void mvModelFeatures::SetDisplayOrderForCells()
         m_UnstructuredGrid->Modified();
     }
 
-    // Turn on cells respresnting features that are displayed,
-    // starting from last in order toward first
-    for (p = m_NumberOfModelFeatureTypes - 1; p >= 0; p--)
+    // Turn on cells respresnting features that are displayed. A cell
+    // shared by several features shows the one first in order.
+    int *featureByOrder = FeaturesByDisplayOrder();
+    for (p = 0; p < m_NumberOfModelFeatureTypes; p++)
     {
-        // p is the display order
-        for (j = 0; j < m_NumberOfModelFeatureTypes; j++)
+        // p is the display order, and j is the index of the model feature to be displayed
+        j = featureByOrder[p];
+        if (j < 0)
+        {
+            continue;
+        }
+        // k is the index of the model feature array containing
+        // how many cells represent the feature that is displayed
+        k = m_FeatureOffset[j];
+        for (i = 1; i <= m_ModelFeatureArray[k]; i++)
         {
-            if (m_DisplayOrder[j] == p)
+            m = m_ModelFeatureArray[k + i];
+            if (m >= 0 && m_CellScalarArray[m] == 0)
             {
-                // j is the index of the model feature to be displayed
-                k = 0;
-                for (i = 0; i < j; i++)
-                {
-                    if (m_ModelFeatureArray[k] > 0)
-                    {
-                        k += m_ModelFeatureArray[k];
-                    }
-                    k++;
-                }
-                // k is the index of the model feature array containing
-                // how many cells represent the feature that is displayed
-                for (i = 1; i <= m_ModelFeatureArray[k]; i++)
-                {
-                    m = m_ModelFeatureArray[k + i];
-                    if (m >= 0)
-                    {
-                        m_CellScalarArray[m] = j + 1;
-                    }
-                }
+                m_CellScalarArray[m] = j + 1;
             }
         }
     }
+    delete[] featureByOrder;
     if (m_SubgridIsActivated)
     {
         SubgridOn();
@@ -613,6 +712,11 @@ void mvModelFeatures::Update()
 {
     if (m_DisplayMode == MV_DISPLAY_MODEL_FEATURES_AS_GLYPHS)
     {
+        // The grid points have changed, so the glyphs must be moved.
+        if (m_ModelFeatureArray != 0 && m_DisplayOrder != 0)
+        {
+            UpdateGlyphs();
+        }
     }
     else
     {
@@ -8,7 +8,7 @@
 #define MV_DISPLAY_MODEL_FEATURES_AS_GLYPHS 2
 
 class vtkCubeSource;
-class vtkGlyph3D;
+class vtkGlyph3DMapper;
 class vtkPoints;
 class vtkPolyData;
 class vtkStructuredGrid;
@@ -63,6 +63,10 @@ protected:
     int                                         m_NumberOfModelFeatureTypes;
     int                                        *m_ModelFeatureArray;
     int                                        *m_DisplayOrder;
+    // For each feature type, the index in m_ModelFeatureArray of the count that
+    // begins the type's block, and the index of its first glyph
+    int                                        *m_FeatureOffset;
+    int                                        *m_GlyphOffset;
     double                                     *m_CellScalarArray;
     int                                         m_NumberOfGlyphs;
     int                                         m_NumberOfCells;
@@ -80,7 +84,7 @@ protected:
 
     vtkSmartPointer<vtkPoints>                  m_GridPoints;
     vtkSmartPointer<vtkPolyData>                m_PolyData;
-    vtkSmartPointer<vtkGlyph3D>                 m_Glyph;
+    vtkSmartPointer<vtkGlyph3DMapper>           m_GlyphMapper;
     vtkSmartPointer<vtkCubeSource>              m_CubeSource;
     vtkSmartPointer<vtkThresholdPoints>         m_ThresholdPoints;
     vtkSmartPointer<vtkTransform>               m_Transform;
@@ -90,8 +94,12 @@ protected:
     vtkIdTypeArray                             *m_CellLocations;
     vtkCellArray                               *m_Cells;
 
+    void                                        BuildFeatureOffsets();
+    void                                        BuildGlyphs();
+    void                                        UpdateGlyphs();
     void                                        SetDisplayOrderForGlyphs();
     void                                        SetDisplayOrderForCells();
+    int                                        *FeaturesByDisplayOrder();
 };
 
 #endif
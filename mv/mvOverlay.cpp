@@ -5,10 +5,15 @@
 #include "vtkClipPolyData.h"
 #include "vtkPlane.h"
 #include "vtkStructuredGrid.h"
-#include "vtkStructuredGridGeometryFilter.h"
-#include "vtkCellLocator.h"
 #include "vtkCellArray.h"
 #include "mvDxfReader.h"
+#include "mvDrapeIndex.h"
+#include "mvDataSource.h"
+
+#include <algorithm>
+#include <future>
+#include <thread>
+#include <vector>
 
 // This must be below vtkStandardNewMacro
 #if defined(_MSC_VER) && defined(_DEBUG) && defined(MV_DEBUG_MEMORY_LEAKS)
@@ -18,6 +23,16 @@
 static char THIS_FILE[] = __FILE__;
 #endif
 
+// Overlays with fewer vertices than this per available thread are
+// transformed and draped in fewer threads
+#define MV_OVERLAY_VERTICES_PER_THREAD 65536
+
+// Limits on the number of segments in one arc, and on the number of
+// vertices in all arcs of an overlay. The tolerance is increased for
+// overlays with more arcs.
+#define MV_OVERLAY_MAX_ARC_SEGMENTS    1024
+#define MV_OVERLAY_MAX_ARC_VERTICES    (1 << 22)
+
 mvOverlay::mvOverlay()
 {
     m_FileName      = 0;
@@ -30,8 +45,12 @@ mvOverlay::mvOverlay()
     m_YMax          = 0;
     m_XCoord        = 0;
     m_YCoord        = 0;
-    m_NumVert       = 0;
     m_NumEntities   = 0;
+    m_Filtered      = 0;
+    m_Arcs          = 0;
+    m_NumArcs       = 0;
+    m_NumPolylines  = 0;
+    m_ArcTolerance  = 0;
     m_Elevation     = 0;
     m_Angle         = 0;
     m_Scale         = 1.0;
@@ -41,6 +60,20 @@ mvOverlay::mvOverlay()
     m_DrapeGap      = 0;
     m_Type          = MV_ESRI_SHAPEFILE_OVERLAY;
     m_Lines         = 0;
+    m_VertexOffset  = 0;
+    m_XGrid         = 0;
+    m_YGrid         = 0;
+    m_TopZ          = 0;
+    m_Inside        = 0;
+    m_KeepEntity    = 0;
+    m_VerticesValid = 0;
+    m_VerticesDrape = 0;
+    m_VerticesTrim  = 0;
+    m_DrapeGrid     = 0;
+    m_DrapeGridTime = 0;
+    m_DrapeIndex    = new mvDrapeIndex;
+    m_TopIsPlanar   = 0;
+    m_PlanarTop     = 0;
     m_ClipXMin      = vtkClipPolyData::New();
     m_PlaneXMin     = vtkPlane::New();
     m_PlaneXMin->SetNormal(1, 0, 0);
@@ -65,8 +98,12 @@ mvOverlay::mvOverlay()
     m_ClipYMax->SetInputConnection(m_ClipYMin->GetOutputPort());
     m_FullGrid           = 0;
     m_Subgrid            = 0;
+    m_DataSource         = 0;
     m_SubgridIsActivated = 0;
 
+    // no arcs have been tessellated
+    m_TessellationTolerance = -1;
+
     // The vertical cropping planes. By default, 2 cropping planes
     // are normal to the x axis, and 2 are normal to the y axis. However
     // they can be rotated.
@@ -99,6 +136,7 @@ mvOverlay::~mvOverlay()
         m_FileName = 0;
     }
     ClearData();
+    delete m_DrapeIndex;
     m_ClipXMin->Delete();
     m_ClipXMax->Delete();
     m_ClipYMin->Delete();
@@ -116,7 +154,6 @@ mvOverlay::~mvOverlay()
 
 void mvOverlay::ClearData()
 {
-    int i;
     if (m_Lines)
     {
         m_Lines->Delete();
@@ -124,31 +161,34 @@ void mvOverlay::ClearData()
     }
     if (m_XCoord)
     {
-        for (i = 0; i < m_NumEntities; i++)
-        {
-            if (m_XCoord[i]) delete[] m_XCoord[i];
-        }
         delete[] m_XCoord;
         m_XCoord = 0;
     }
     if (m_YCoord)
     {
-        for (i = 0; i < m_NumEntities; i++)
-        {
-            if (m_YCoord[i]) delete[] m_YCoord[i];
-        }
         delete[] m_YCoord;
         m_YCoord = 0;
     }
-    if (m_NumVert)
+    if (m_VertexOffset)
+    {
+        delete[] m_VertexOffset;
+        m_VertexOffset = 0;
+    }
+    if (m_Arcs)
     {
-        delete[] m_NumVert;
-        m_NumVert = 0;
+        delete[] m_Arcs;
+        m_Arcs = 0;
     }
-    m_XMin = 0;
-    m_XMax = 0;
-    m_YMin = 0;
-    m_YMax = 0;
+    ClearVertices();
+    m_NumEntities           = 0;
+    m_Filtered              = 0;
+    m_NumArcs               = 0;
+    m_NumPolylines          = 0;
+    m_TessellationTolerance = -1;
+    m_XMin                  = 0;
+    m_XMax                  = 0;
+    m_YMin                  = 0;
+    m_YMax                  = 0;
 }
 
 void mvOverlay::SetFileName(const char *filename)
@@ -193,6 +233,7 @@ void mvOverlay::SetCoordinatesAtGridOrigin(double xorig, double yorig)
     }
     m_XAtGridOrigin = xorig;
     m_YAtGridOrigin = yorig;
+    m_VerticesValid = 0;
 }
 
 void mvOverlay::SetAngle(double angle)
@@ -201,7 +242,8 @@ void mvOverlay::SetAngle(double angle)
     {
         return;
     }
-    m_Angle = angle;
+    m_Angle         = angle;
+    m_VerticesValid = 0;
 }
 
 void mvOverlay::SetElevation(double elev)
@@ -215,7 +257,12 @@ void mvOverlay::SetElevation(double elev)
 
 void mvOverlay::SetOverlayToGridScale(double scale)
 {
-    m_Scale = scale;
+    if (m_Scale == scale)
+    {
+        return;
+    }
+    m_Scale         = scale;
+    m_VerticesValid = 0;
 }
 
 void mvOverlay::SetDrape(int b)
@@ -238,18 +285,46 @@ void mvOverlay::SetDrapeGap(double gap)
     m_DrapeGap = gap;
 }
 
-void mvOverlay::SetSubgrid(vtkStructuredGrid *sg)
+void mvOverlay::SetArcTolerance(double tolerance)
+{
+    if (tolerance == m_ArcTolerance)
+    {
+        return;
+    }
+    m_ArcTolerance = tolerance;
+    if (m_NumArcs > 0 && HasData())
+    {
+        Build();
+    }
+}
+
+void mvOverlay::SetSubgrid(vtkPointSet *sg)
 {
     m_Subgrid = sg;
 }
 
-void mvOverlay::SetFullGrid(vtkStructuredGrid *fg)
+void mvOverlay::SetFullGrid(vtkPointSet *fg)
 {
     m_FullGrid = fg;
 }
 
+void mvOverlay::SetDataSource(mvDataSource *dataSource)
+{
+    m_DataSource = dataSource;
+    // the top is read again from the new data source
+    m_DrapeGrid  = 0;
+}
+
 int mvOverlay::Update(const char *errMsg)
 {
+    // A shape file that was read only around the grid is read again if
+    // the grid now covers shapes that were skipped
+    double bounds[4];
+    if (!m_NewFile && m_Filtered && m_Type == MV_ESRI_SHAPEFILE_OVERLAY)
+    {
+        m_NewFile = !GetFilterBounds(bounds) || bounds[0] < m_FilterBounds[0] || bounds[1] > m_FilterBounds[1] ||
+                    bounds[2] < m_FilterBounds[2] || bounds[3] > m_FilterBounds[3];
+    }
     if (m_NewFile)
     {
         switch (m_Type)
@@ -374,11 +449,23 @@ void mvOverlay::SubgridOff()
     }
 }
 
+void mvOverlay::ClearVertices()
+{
+    delete[] m_XGrid;
+    delete[] m_YGrid;
+    delete[] m_TopZ;
+    delete[] m_Inside;
+    delete[] m_KeepEntity;
+    m_XGrid         = 0;
+    m_YGrid         = 0;
+    m_TopZ          = 0;
+    m_Inside        = 0;
+    m_KeepEntity    = 0;
+    m_VerticesValid = 0;
+}
+
 void mvOverlay::Build()
 {
-    double ec, es, x, y;
-    ec = cos(m_Angle * 3.14159265358979 / 180.0);
-    es = sin(m_Angle * 3.14159265358979 / 180.0);
     if (m_Lines)
     {
         m_Lines->Delete();
@@ -401,196 +488,374 @@ void mvOverlay::Build()
     }
     SetColor(0, 0, 0);
 
-    vtkStructuredGridGeometryFilter *geom    = 0;
-    vtkCellLocator                  *locator = 0;
-    double                           p1[3], p2[3], t, ptline[3], pcoords[3];
-    int                              subId, i, j;
-    if (m_Drape)
-    {
-        geom = vtkStructuredGridGeometryFilter::New();
-        int dim[3];
-        m_FullGrid->GetDimensions(dim);
-        geom->SetInputData(m_FullGrid);
-        geom->SetExtent(0, dim[0] - 1, 0, dim[1] - 1, dim[2] - 1, dim[2] - 1);
-        geom->Update();
+    if (m_NumArcs > 0)
+    {
+        double tolerance = (m_ArcTolerance > 0) ? m_ArcTolerance / m_Scale
+                                                : 1.0e-3 * std::max(m_XMax - m_XMin, m_YMax - m_YMin);
+        if (tolerance != m_TessellationTolerance)
+        {
+            TessellateArcs(tolerance);
+        }
+    }
+    if (m_NumEntities == 0 || m_VertexOffset == 0)
+    {
+        return;
+    }
+
+    // The overlay can only be draped once a grid has been loaded
+    int hasGrid = (m_FullGrid && m_FullGrid->GetPoints());
+    int drape   = (m_Drape && hasGrid);
+    int trim    = (m_Trim && hasGrid && m_DataSource && m_DataSource->GetGridType() != GridType::MV_STRUCTURED_GRID);
+    if ((drape || trim) && (m_FullGrid != m_DrapeGrid || m_FullGrid->GetPoints()->GetMTime() != m_DrapeGridTime))
+    {
+        BuildDrapeIndex();
+        m_VerticesValid = 0;
+    }
+    if (!m_VerticesValid || drape != m_VerticesDrape || trim != m_VerticesTrim)
+    {
+        m_VerticesDrape = drape;
+        m_VerticesTrim  = trim;
+        ComputeVertices();
+    }
+
+    // Each line is a run of vertices of an entity, first to last - 1.
+    // Unless the overlay is trimmed to the grid outline, a run is a whole
+    // entity. Otherwise runs are split where both ends of a segment are
+    // outside the grid.
+    std::vector<int> runs;
+    int              i, j;
+    for (i = 0; i < m_NumEntities; i++)
+    {
+        if (!m_KeepEntity[i])
+        {
+            continue;
+        }
+        int first = m_VertexOffset[i];
+        int last  = m_VertexOffset[i + 1];
+        if (!trim)
+        {
+            runs.push_back(first);
+            runs.push_back(last);
+            continue;
+        }
+        int start = -1;
+        for (j = first; j < last; j++)
+        {
+            bool keep = (j + 1 < last && (m_Inside[j] || m_Inside[j + 1]));
+            if (keep && start < 0)
+            {
+                start = j;
+            }
+            else if (!keep && start >= 0)
+            {
+                runs.push_back(start);
+                runs.push_back(j + 1);
+                start = -1;
+            }
+        }
+    }
+
+    vtkIdType numPoints = 0;
+    for (size_t r = 0; r < runs.size(); r += 2)
+    {
+        numPoints += runs[r + 1] - runs[r];
+    }
+    points->SetNumberOfPoints(numPoints);
+    lines->AllocateExact(runs.size() / 2, numPoints);
+
+    vtkIdType ip = 0;
+    for (size_t r = 0; r < runs.size(); r += 2)
+    {
+        lines->InsertNextCell(runs[r + 1] - runs[r]);
+        for (j = runs[r]; j < runs[r + 1]; j++)
+        {
+            double z = drape ? m_TopZ[j] + m_DrapeGap : m_Elevation;
+            points->SetPoint(ip, m_XGrid[j], m_YGrid[j], z);
+            lines->InsertCellPoint(ip);
+            ip++;
+        }
+    }
+}
+
+void mvOverlay::BuildDrapeIndex()
+{
+    m_DrapeIndex->Clear();
+    m_DrapeGrid     = m_FullGrid;
+    m_DrapeGridTime = m_FullGrid->GetPoints()->GetMTime();
+    m_TopIsPlanar   = 1;
+
+    std::vector<double> xyz;
+    std::vector<int>    polygons;
+    int                 dim[3];
+    vtkStructuredGrid  *sg = vtkStructuredGrid::SafeDownCast(m_FullGrid);
+    if (sg)
+    {
+        // the grid top is the last layer of points
+        sg->GetDimensions(dim);
+        int       n      = dim[0] * dim[1];
+        vtkIdType offset = (vtkIdType)(dim[2] - 1) * n;
+        xyz.resize(3 * (size_t)n);
+        for (int i = 0; i < n; i++)
+        {
+            sg->GetPoint(offset + i, &xyz[3 * (size_t)i]);
+        }
+    }
+    else if (m_DataSource == 0 || !m_DataSource->GetTopSurface(xyz, polygons))
+    {
+        // Without the top, the overlay is draped on the top of the bounds
         double bounds[6];
-        geom->GetOutput()->GetBounds(bounds);
-        if (bounds[5] - bounds[4] != 0)
+        m_FullGrid->GetBounds(bounds);
+        m_PlanarTop = bounds[5];
+        return;
+    }
+
+    double zmin = xyz[2];
+    double zmax = xyz[2];
+    for (size_t i = 2; i < xyz.size(); i += 3)
+    {
+        zmin = std::min(zmin, xyz[i]);
+        zmax = std::max(zmax, xyz[i]);
+    }
+    m_TopIsPlanar = (zmax - zmin == 0);
+    m_PlanarTop   = zmin;
+
+    if (sg)
+    {
+        if (!m_TopIsPlanar)
         {
-            // Grid top is non planar
-            locator = vtkCellLocator::New();
-            locator->SetDataSet(geom->GetOutput());
-            locator->BuildLocator();
-            m_FullGrid->GetBounds(bounds);
-            double thick = bounds[5] - bounds[4];
-            p1[2]        = bounds[4] - thick;
-            p2[2]        = bounds[5] + thick;
+            m_DrapeIndex->SetStructuredSurface(dim[0], dim[1], xyz.data());
         }
-        else
+        return;
+    }
+
+    // The index of a DISV or DISU top is also needed to trim to the grid
+    // outline. Polygons are split into fans of triangles.
+    m_DrapeIndex->Initialize((int)(xyz.size() / 3), xyz.data());
+    for (size_t p = 0; p < polygons.size(); p += polygons[p] + 1)
+    {
+        const int *pts = &polygons[p + 1];
+        for (int j = 1; j + 1 < polygons[p]; j++)
         {
-            // Grid Top is planar
-            p1[2] = bounds[4];
+            m_DrapeIndex->AddTriangle(pts[0], pts[j], pts[j + 1]);
         }
     }
+    m_DrapeIndex->SetOverlapping(m_DataSource->GetGridType() == GridType::MV_UNSTRUCTURED_GRID);
+    m_DrapeIndex->Build();
+}
 
-    int ip = 0;
-    for (i = 0; i < m_NumEntities; i++)
+void mvOverlay::ComputeVertices()
+{
+    ClearVertices();
+    int numVertices = m_VertexOffset[m_NumEntities];
+    m_XGrid         = new double[numVertices];
+    m_YGrid         = new double[numVertices];
+    m_TopZ          = new double[numVertices];
+    m_Inside        = new char[numVertices];
+    m_KeepEntity    = new char[m_NumEntities];
+
+    // Entities are independent, so they are divided among threads
+    // by number of vertices
+    int numThreads = (int)std::max(1u, std::thread::hardware_concurrency());
+    numThreads     = std::max(1, std::min(numThreads, numVertices / MV_OVERLAY_VERTICES_PER_THREAD));
+    if (numThreads == 1)
     {
-        vtkIdType *pts    = new vtkIdType[m_NumVert[i]];
-        double    *xp     = new double[m_NumVert[i]];
-        double    *yp     = new double[m_NumVert[i]];
-        double    *zp     = new double[m_NumVert[i]];
-        int       *inside = new int[m_NumVert[i]];
-        int        keep   = 0;
-        for (j = 0; j < m_NumVert[i]; j++)
+        ComputeEntityVertices(0, m_NumEntities);
+    }
+    else
+    {
+        std::vector<std::future<void>> workers;
+        int                            first = 0;
+        for (int t = 1; t <= numThreads; t++)
         {
-            if (i == 0 && j == 0)
+            int last = m_NumEntities;
+            if (t < numThreads)
             {
-                m_XMin = m_XMax = m_XCoord[i][j];
-                m_YMin = m_YMax = m_YCoord[i][j];
+                int target = (int)((long long)numVertices * t / numThreads);
+                last       = (int)(std::lower_bound(m_VertexOffset, m_VertexOffset + m_NumEntities, target) - m_VertexOffset);
             }
-            else
+            if (last > first)
             {
-                if (m_XCoord[i][j] < m_XMin)
-                {
-                    m_XMin = m_XCoord[i][j];
-                }
-                else if (m_XCoord[i][j] > m_XMax)
-                {
-                    m_XMax = m_XCoord[i][j];
-                }
-                if (m_YCoord[i][j] < m_YMin)
-                {
-                    m_YMin = m_YCoord[i][j];
-                }
-                else if (m_YCoord[i][j] > m_YMax)
-                {
-                    m_YMax = m_YCoord[i][j];
-                }
+                workers.push_back(std::async(std::launch::async, &mvOverlay::ComputeEntityVertices, this, first, last));
+                first = last;
             }
+        }
+        for (auto &w : workers)
+        {
+            w.get();
+        }
+    }
+    m_VerticesValid = 1;
+}
 
-            x     = m_Scale * (m_XCoord[i][j] - m_XAtGridOrigin);
-            y     = m_Scale * (m_YCoord[i][j] - m_YAtGridOrigin);
+void mvOverlay::ComputeEntityVertices(int first, int last)
+{
+    double ec, es, x, y;
+    ec                = cos(m_Angle * 3.14159265358979 / 180.0);
+    es                = sin(m_Angle * 3.14159265358979 / 180.0);
+    // Whether vertices get the elevation of the grid top below them, and
+    // whether the index is needed to find which vertices are over the grid
+    bool drapeOnIndex = m_VerticesDrape && !m_TopIsPlanar && !m_DrapeIndex->IsEmpty();
+    bool findInside   = drapeOnIndex || (m_VerticesTrim && !m_DrapeIndex->IsEmpty());
+
+    std::vector<int> previous;
+    for (int i = first; i < last; i++)
+    {
+        int     n      = m_VertexOffset[i + 1] - m_VertexOffset[i];
+        double *xc     = m_XCoord + m_VertexOffset[i];
+        double *yc     = m_YCoord + m_VertexOffset[i];
+        double *xp     = m_XGrid + m_VertexOffset[i];
+        double *yp     = m_YGrid + m_VertexOffset[i];
+        double *zp     = m_TopZ + m_VertexOffset[i];
+        char   *inside = m_Inside + m_VertexOffset[i];
+        int     keep   = 0;
+        int     j;
+        for (j = 0; j < n; j++)
+        {
+            x     = m_Scale * (xc[j] - m_XAtGridOrigin);
+            y     = m_Scale * (yc[j] - m_YAtGridOrigin);
             xp[j] = x * ec + y * es;
             yp[j] = -x * es + y * ec;
-            if (m_Drape)
+            zp[j] = m_VerticesDrape ? m_PlanarTop : 0;
+            if (findInside)
             {
-                if (locator)
+                // find the top surface of the grid directly above or below the point
+                double z;
+                inside[j] = m_DrapeIndex->GetElevation(xp[j], yp[j], z);
+                if (inside[j])
                 {
-                    // project the point vertically to see if it intersects the
-                    // top surface of the grid
-                    p1[0]       = xp[j];
-                    p1[1]       = yp[j];
-                    p2[0]       = xp[j];
-                    p2[1]       = yp[j];
-                    int iresult = locator->IntersectWithLine(p1, p2, 0.001, t, ptline, pcoords, subId);
-                    if (iresult)
-                    {
-                        // Point intersects the top surface of grid
-                        zp[j]     = ptline[2];
-                        inside[j] = 1;
-                        keep      = 1;
-                    }
-                    else
+                    keep = 1;
+                    if (drapeOnIndex)
                     {
-                        // Point does not intersect top surface of grid
-                        zp[j]     = 0;
-                        inside[j] = 0;
+                        zp[j] = z;
                     }
                 }
-                else
-                {
-                    zp[j] = p1[2];
-                    keep  = 1;
-                }
             }
             else
             {
-                zp[j] = m_Elevation;
-                keep  = 1;
+                inside[j] = 1;
+                keep      = 1;
             }
         }
-        if (keep)
+        // Entities with no vertex over the grid are dropped when draping on
+        // a non planar top or trimming to the outline
+        m_KeepEntity[i] = keep;
+        if (!drapeOnIndex || !keep)
+        {
+            continue;
+        }
+
+        // A point outside the grid gets the elevation of the nearest point
+        // in the same entity that is inside the grid, preferring the
+        // previous point in a tie.
+        previous.resize(n);
+        int m1 = -1;
+        for (j = 0; j < n; j++)
         {
-            int k, m1, m2;
-            for (j = 0; j < m_NumVert[i]; j++)
+            previous[j] = m1;
+            if (inside[j])
             {
-                if (m_Drape && locator && !inside[j])
-                {
-                    m1 = -1;
-                    for (k = j - 1; k >= 0; k--)
-                    {
-                        if (inside[k])
-                        {
-                            m1 = k;
-                            break;
-                        }
-                    }
-                    m2 = -1;
-                    for (k = j + 1; k < m_NumVert[i]; k++)
-                    {
-                        if (inside[k])
-                        {
-                            m2 = k;
-                            break;
-                        }
-                    }
-                    if (m1 == -1 && m2 != -1)
-                    {
-                        zp[j] = zp[m2];
-                    }
-                    else if (m2 == -1 && m1 != -1)
-                    {
-                        zp[j] = zp[m1];
-                    }
-                    else if (m1 != -1 && m2 != -1)
-                    {
-                        if (j - m1 <= m2 - j)
-                        {
-                            zp[j] = zp[m1];
-                        }
-                        else
-                        {
-                            zp[j] = zp[m2];
-                        }
-                    }
-                    else
-                    {
-                        break; // should not happen
-                    }
-                }
-                if (m_Drape)
-                {
-                    zp[j] += m_DrapeGap;
-                }
-                points->InsertNextPoint(xp[j], yp[j], zp[j]);
-                pts[j] = ip;
-                ip++;
+                m1 = j;
+            }
+        }
+        int m2 = -1;
+        for (j = n - 1; j >= 0; j--)
+        {
+            if (inside[j])
+            {
+                m2 = j;
+                continue;
             }
+            m1 = previous[j];
+            if (m1 == -1 || (m2 != -1 && j - m1 > m2 - j))
+            {
+                zp[j] = zp[m2];
+            }
+            else
+            {
+                zp[j] = zp[m1];
+            }
+        }
+    }
+}
 
-            lines->InsertNextCell(m_NumVert[i], pts);
+// Reads the bounds of shape i from its record header, without reading
+// the vertices. Returns false for a null shape.
+static bool ReadShapeBounds(SHPHandle hSHP, int i, double *bounds)
+{
+    unsigned char record[44];
+    if (hSHP->panRecSize[i] < 36 || fseek(hSHP->fpSHP, hSHP->panRecOffset[i], SEEK_SET) != 0 ||
+        fread(record, sizeof(record), 1, hSHP->fpSHP) != 1)
+    {
+        return false;
+    }
+    // The shape type and the bounds are little endian
+    const int one = 1;
+    if (*(const char *)&one == 0)
+    {
+        for (int k = 8; k < 44; k += (k == 8) ? 4 : 8)
+        {
+            std::reverse(record + k, record + k + ((k == 8) ? 4 : 8));
         }
-        delete[] pts;
-        delete[] xp;
-        delete[] yp;
-        delete[] zp;
-        delete[] inside;
     }
+    int shapeType;
+    memcpy(&shapeType, record + 8, 4);
+    if (shapeType == SHPT_NULL)
+    {
+        return false;
+    }
+    memcpy(bounds, record + 12, 4 * sizeof(double));
+    return true;
+}
 
-    if (geom)
+// Gets the bounds of the full grid in overlay coordinates. Shapes outside
+// these bounds are trimmed, so they do not need to be read. Returns 0 if
+// the overlay is not trimmed or the grid has not been loaded.
+int mvOverlay::GetFilterBounds(double *bounds)
+{
+    if (!m_Trim || m_FullGrid == 0 || m_FullGrid->GetPoints() == 0 || m_Scale == 0)
     {
-        geom->Delete();
+        return 0;
+    }
+    double gridBounds[6];
+    m_FullGrid->GetBounds(gridBounds);
+    if (gridBounds[0] > gridBounds[1])
+    {
+        return 0;
     }
-    if (locator)
+    double ec = cos(m_Angle * 3.14159265358979 / 180.0);
+    double es = sin(m_Angle * 3.14159265358979 / 180.0);
+    for (int c = 0; c < 4; c++)
     {
-        locator->Delete();
+        double xg = gridBounds[c % 2];
+        double yg = gridBounds[2 + c / 2];
+        double x  = (xg * ec - yg * es) / m_Scale + m_XAtGridOrigin;
+        double y  = (xg * es + yg * ec) / m_Scale + m_YAtGridOrigin;
+        if (c == 0)
+        {
+            bounds[0] = bounds[1] = x;
+            bounds[2] = bounds[3] = y;
+        }
+        else
+        {
+            bounds[0] = std::min(bounds[0], x);
+            bounds[1] = std::max(bounds[1], x);
+            bounds[2] = std::min(bounds[2], y);
+            bounds[3] = std::max(bounds[3], y);
+        }
     }
+    // allow for round off in the transformation
+    double tol = 1.0e-9 * std::max(bounds[1] - bounds[0], bounds[3] - bounds[2]);
+    bounds[0] -= tol;
+    bounds[1] += tol;
+    bounds[2] -= tol;
+    bounds[3] += tol;
+    return 1;
 }
 
 int mvOverlay::ReadESRIShapeFile(const char *errMsg)
 {
     SHPHandle hSHP;
-    int       nShapeType, nEntities, i, iPart;
+    int       nShapeType, nEntities, i;
     double    adfMinBound[4], adfMaxBound[4];
 
     hSHP = SHPOpen(m_FileName, "rb");
@@ -604,6 +869,7 @@ int mvOverlay::ReadESRIShapeFile(const char *errMsg)
     SHPGetInfo(hSHP, &nEntities, &nShapeType, adfMinBound, adfMaxBound);
     if (nShapeType != SHPT_ARC && nShapeType != SHPT_POLYGON)
     {
+        SHPClose(hSHP);
         errMsg = "Shape file does not contain arcs or polygon";
         return 0;
     }
@@ -612,21 +878,31 @@ int mvOverlay::ReadESRIShapeFile(const char *errMsg)
     // for the purpose of vtk, polygon data can be treated in the same
     // way as polyline data, because the figure will be closed.
     ClearData();
-    m_XCoord  = new double *[nEntities];
-    m_YCoord  = new double *[nEntities];
-    m_NumVert = new int[nEntities];
+
+    // When the overlay is trimmed, only the shapes whose bounds overlap
+    // the grid are read. The bounds are in the record headers, which are
+    // found from the offsets in the .shx file, so the skipped shapes are
+    // never read.
+    double           filter[4];
+    int              filtered = GetFilterBounds(filter);
+    std::vector<int> shapes;
     for (i = 0; i < nEntities; i++)
     {
-        m_XCoord[i]  = 0;
-        m_YCoord[i]  = 0;
-        m_NumVert[i] = 0;
+        double b[4];
+        if (!filtered || (ReadShapeBounds(hSHP, i, b) && b[0] <= filter[1] && b[2] >= filter[0] &&
+                          b[1] <= filter[3] && b[3] >= filter[2]))
+        {
+            shapes.push_back(i);
+        }
     }
-    for (i = 0; i < nEntities; i++)
-    {
-        int        j;
-        SHPObject *psShape;
 
-        psShape = SHPReadObject(hSHP, i);
+    int                 numShapes = (int)shapes.size();
+    std::vector<double> x, y;
+    m_VertexOffset    = new int[numShapes + 1];
+    m_VertexOffset[0] = 0;
+    for (i = 0; i < numShapes; i++)
+    {
+        SHPObject *psShape = SHPReadObject(hSHP, shapes[i]);
 
         if (!psShape)
         {
@@ -636,44 +912,125 @@ int mvOverlay::ReadESRIShapeFile(const char *errMsg)
             return 0;
         }
 
-        m_NumVert[i] = psShape->nVertices;
-        m_XCoord[i]  = new double[psShape->nVertices];
-        m_YCoord[i]  = new double[psShape->nVertices];
-
-        for (j = 0, iPart = 1; j < psShape->nVertices; j++)
-        {
-            const char *pszPartType = "";
-
-            if (j == 0 && psShape->nParts > 0)
-            {
-                pszPartType = SHPPartTypeName(psShape->panPartType[0]);
-            }
-
-            if (iPart < psShape->nParts && psShape->panPartStart[iPart] == j)
-            {
-                pszPartType = SHPPartTypeName(psShape->panPartType[iPart]);
-                iPart++;
-            }
-
-            m_XCoord[i][j] = psShape->padfX[j];
-            m_YCoord[i][j] = psShape->padfY[j];
-        }
+        x.insert(x.end(), psShape->padfX, psShape->padfX + psShape->nVertices);
+        y.insert(y.end(), psShape->padfY, psShape->padfY + psShape->nVertices);
+        m_VertexOffset[i + 1] = (int)x.size();
 
         SHPDestroyObject(psShape);
     }
 
     SHPClose(hSHP);
 
+    m_XCoord = new double[x.size()];
+    m_YCoord = new double[y.size()];
+    std::copy(x.begin(), x.end(), m_XCoord);
+    std::copy(y.begin(), y.end(), m_YCoord);
+
     m_XMin        = adfMinBound[0];
     m_YMin        = adfMinBound[1];
     m_XMax        = adfMaxBound[0];
     m_YMax        = adfMaxBound[1];
-    m_NumEntities = nEntities;
-    m_NewFile     = 0;
-    errMsg        = nullptr;
+    m_NumEntities = numShapes;
+    m_Filtered    = filtered;
+    if (filtered)
+    {
+        std::copy(filter, filter + 4, m_FilterBounds);
+    }
+    m_NewFile = 0;
+    errMsg    = nullptr;
     return 1;
 }
 
+// Replaces array a by an array of the given size that starts with the
+// first n values of a
+template <class T>
+static void ResizeArray(T *&a, int n, int size)
+{
+    T *b = new T[size];
+    std::copy(a, a + n, b);
+    delete[] a;
+    a = b;
+}
+
+// Replaces the entities after the first m_NumPolylines by the arcs,
+// tessellated so that no point on a chord is farther than tolerance from
+// the arc (in overlay coordinates). If the vertices have been computed,
+// only those of the arcs are computed again.
+void mvOverlay::TessellateArcs(double tolerance)
+{
+    const double pi         = 3.14159265358979;
+    m_TessellationTolerance = tolerance;
+
+    // A chord spanning angle a is at most r (1 - cos(a / 2)) from the arc.
+    // There is at least one segment per quarter turn, so small circles
+    // are still drawn.
+    std::vector<int> segments(m_NumArcs);
+    long long        numArcVertices = 0;
+    for (int pass = 0; pass < 8; pass++)
+    {
+        numArcVertices = 0;
+        for (int a = 0; a < m_NumArcs; a++)
+        {
+            double radius = m_Arcs[5 * a + 2];
+            double sweep  = fabs(m_Arcs[5 * a + 4]);
+            double angle  = (tolerance < radius) ? 2 * acos(1 - tolerance / radius) : pi;
+            double n      = std::max(ceil(sweep / angle), ceil(sweep / (pi / 2) - 1.0e-9));
+            segments[a]   = (int)std::max(1.0, std::min(n, (double)MV_OVERLAY_MAX_ARC_SEGMENTS));
+            numArcVertices += segments[a] + 1;
+        }
+        if (numArcVertices <= MV_OVERLAY_MAX_ARC_VERTICES)
+        {
+            break;
+        }
+        // the number of segments varies as the inverse square root of
+        // the tolerance
+        double ratio = (double)numArcVertices / MV_OVERLAY_MAX_ARC_VERTICES;
+        tolerance *= ratio * ratio;
+    }
+
+    int     numPolylineVertices = m_VertexOffset[m_NumPolylines];
+    int     numVertices         = numPolylineVertices + (int)numArcVertices;
+    int     numEntities         = m_NumPolylines + m_NumArcs;
+    double *x                   = new double[numVertices];
+    double *y                   = new double[numVertices];
+    int    *offset              = new int[numEntities + 1];
+    std::copy(m_XCoord, m_XCoord + numPolylineVertices, x);
+    std::copy(m_YCoord, m_YCoord + numPolylineVertices, y);
+    std::copy(m_VertexOffset, m_VertexOffset + m_NumPolylines + 1, offset);
+    int j = numPolylineVertices;
+    for (int a = 0; a < m_NumArcs; a++)
+    {
+        const double *arc = m_Arcs + 5 * a;
+        for (int k = 0; k <= segments[a]; k++)
+        {
+            double angle = arc[3] + arc[4] * k / segments[a];
+            x[j]         = arc[0] + arc[2] * cos(angle);
+            y[j]         = arc[1] + arc[2] * sin(angle);
+            j++;
+        }
+        offset[m_NumPolylines + a + 1] = j;
+    }
+    delete[] m_XCoord;
+    delete[] m_YCoord;
+    delete[] m_VertexOffset;
+    m_XCoord       = x;
+    m_YCoord       = y;
+    m_VertexOffset = offset;
+
+    if (m_VerticesValid)
+    {
+        // keep the vertices of the polylines
+        ResizeArray(m_XGrid, numPolylineVertices, numVertices);
+        ResizeArray(m_YGrid, numPolylineVertices, numVertices);
+        ResizeArray(m_TopZ, numPolylineVertices, numVertices);
+        ResizeArray(m_Inside, numPolylineVertices, numVertices);
+        ResizeArray(m_KeepEntity, m_NumPolylines, numEntities);
+        m_NumEntities = numEntities;
+        ComputeEntityVertices(m_NumPolylines, m_NumEntities);
+    }
+    m_NumEntities = numEntities;
+}
+
 int mvOverlay::ReadDxfFile(const char *errMsg)
 {
     int          i;
@@ -685,24 +1042,57 @@ int mvOverlay::ReadDxfFile(const char *errMsg)
         delete dxf;
         return 0;
     }
-    m_NumEntities = dxf->GetNumberOfEntities();
-    m_XCoord      = new double *[m_NumEntities];
-    m_YCoord      = new double *[m_NumEntities];
-    m_NumVert     = new int[m_NumEntities];
+    ClearData();
+    m_NumEntities     = dxf->GetNumberOfEntities();
+    m_VertexOffset    = new int[m_NumEntities + 1];
+    m_VertexOffset[0] = 0;
     for (i = 0; i < m_NumEntities; i++)
     {
-        m_XCoord[i]  = 0;
-        m_YCoord[i]  = 0;
-        m_NumVert[i] = 0;
+        m_VertexOffset[i + 1] = m_VertexOffset[i] + dxf->GetNumberOfVerticesInEntity(i);
     }
+    m_XCoord = new double[m_VertexOffset[m_NumEntities]];
+    m_YCoord = new double[m_VertexOffset[m_NumEntities]];
     for (i = 0; i < m_NumEntities; i++)
     {
-        m_NumVert[i] = dxf->GetNumberOfVerticesInEntity(i);
-        m_XCoord[i]  = new double[m_NumVert[i]];
-        m_YCoord[i]  = new double[m_NumVert[i]];
-        for (int j = 0; j < m_NumVert[i]; j++)
+        for (int j = m_VertexOffset[i]; j < m_VertexOffset[i + 1]; j++)
+        {
+            dxf->GetCoordinates(i, j - m_VertexOffset[i], m_XCoord[j], m_YCoord[j]);
+            if (j == 0)
+            {
+                m_XMin = m_XMax = m_XCoord[j];
+                m_YMin = m_YMax = m_YCoord[j];
+            }
+            else
+            {
+                m_XMin = std::min(m_XMin, m_XCoord[j]);
+                m_XMax = std::max(m_XMax, m_XCoord[j]);
+                m_YMin = std::min(m_YMin, m_YCoord[j]);
+                m_YMax = std::max(m_YMax, m_YCoord[j]);
+            }
+        }
+    }
+    m_NumPolylines = m_NumEntities;
+
+    // The arcs are tessellated by Build
+    m_NumArcs = dxf->GetNumberOfArcs();
+    m_Arcs    = new double[5 * m_NumArcs];
+    for (i = 0; i < m_NumArcs; i++)
+    {
+        double *a = m_Arcs + 5 * i;
+        dxf->GetArc(i, a[0], a[1], a[2], a[3], a[4]);
+        if (i == 0 && m_NumPolylines == 0)
+        {
+            m_XMin = a[0] - a[2];
+            m_XMax = a[0] + a[2];
+            m_YMin = a[1] - a[2];
+            m_YMax = a[1] + a[2];
+        }
+        else
         {
-            dxf->GetCoordinates(i, j, m_XCoord[i][j], m_YCoord[i][j]);
+            m_XMin = std::min(m_XMin, a[0] - a[2]);
+            m_XMax = std::max(m_XMax, a[0] + a[2]);
+            m_YMin = std::min(m_YMin, a[1] - a[2]);
+            m_YMax = std::max(m_YMax, a[1] + a[2]);
         }
     }
     delete dxf;
@@ -2,14 +2,17 @@
 #define __mvOverlay_h
 
 #include "mvDisplayObject.h"
+#include "vtkType.h"
 
 #define MV_ESRI_SHAPEFILE_OVERLAY 1
 #define MV_DXF_ASCII_OVERLAY      2
 
 class vtkPolyData;
 class vtkClipPolyData;
-class vtkStructuredGrid;
+class vtkPointSet;
 class vtkPlane;
+class mvDataSource;
+class mvDrapeIndex;
 
 class MV_EXPORT mvOverlay : public mvDisplayObject
 {
@@ -27,6 +30,10 @@ public:
     void  SetTrim(int b);
     void  SetCrop(int b);
     void  SetDrapeGap(double gap);
+    // Arcs and circles are drawn with chords that are within this
+    // distance of the curve, in grid units. Zero uses a tolerance based
+    // on the size of the overlay.
+    void  SetArcTolerance(double tolerance);
 
     char *GetFileName() { return m_FileName; }
     int   GetType() { return m_Type; }
@@ -53,8 +60,10 @@ public:
     int  Update(const char *errMsg);
     void ClearData();
     int  HasData();
-    void SetFullGrid(vtkStructuredGrid *fg);
-    void SetSubgrid(vtkStructuredGrid *sg);
+    void SetFullGrid(vtkPointSet *fg);
+    void SetSubgrid(vtkPointSet *sg);
+    // The data source gives the top of DISV and DISU grids
+    void SetDataSource(mvDataSource *dataSource);
     void SubgridOn();
     void SubgridOff();
     void SetCropperPlaneOrigin(int i, double x, double y, double z);
@@ -71,10 +80,24 @@ protected:
     double             m_Elevation;
     double             m_Scale;
     double             m_DrapeGap;
-    double           **m_XCoord;
-    double           **m_YCoord;
-    int               *m_NumVert;
+    // Coordinates of the entities, in one buffer. Vertex j of entity i
+    // is at m_VertexOffset[i] + j.
+    double            *m_XCoord;
+    double            *m_YCoord;
+    int               *m_VertexOffset;
     int                m_NumEntities;
+    // If m_Filtered = 1, only the shapes that overlap m_FilterBounds
+    // (xmin, xmax, ymin, ymax in overlay coordinates) have been read
+    int                m_Filtered;
+    double             m_FilterBounds[4];
+    // Arcs and circles of a DXF file: center x, center y, radius, start
+    // angle and sweep of each. They are tessellated into the entities
+    // after the first m_NumPolylines, whenever the tolerance changes.
+    double            *m_Arcs;
+    int                m_NumArcs;
+    int                m_NumPolylines;
+    double             m_ArcTolerance;
+    double             m_TessellationTolerance;
     int                m_NewFile;
     char              *m_FileName;
     int                m_Drape;
@@ -83,8 +106,9 @@ protected:
     int                m_Type;
     int                m_SubgridIsActivated;
     vtkPolyData       *m_Lines;
-    vtkStructuredGrid *m_FullGrid;
-    vtkStructuredGrid *m_Subgrid;
+    vtkPointSet       *m_FullGrid;
+    vtkPointSet       *m_Subgrid;
+    mvDataSource      *m_DataSource;
     // objects for trimming
     vtkClipPolyData   *m_ClipXMin;
     vtkClipPolyData   *m_ClipXMax;
@@ -98,9 +122,36 @@ protected:
     vtkPlane          *m_Plane[4];
     vtkClipPolyData   *m_Cropper[4];
 
+    // Vertices in grid coordinates, the elevation of the grid top at each
+    // vertex, and whether each vertex is over the grid, computed by
+    // ComputeVertices and indexed like the coordinates. Changes to the
+    // drape gap or the elevation only offset these, so they do not need
+    // to be recomputed.
+    double            *m_XGrid;
+    double            *m_YGrid;
+    double            *m_TopZ;
+    char              *m_Inside;
+    char              *m_KeepEntity;
+    int                m_VerticesValid;
+    int                m_VerticesDrape;
+    // Overlays on DISV and DISU grids are also trimmed to the outline of
+    // the grid, which is found from the index of the grid top
+    int                m_VerticesTrim;
+    vtkPointSet       *m_DrapeGrid;
+    vtkMTimeType       m_DrapeGridTime;
+    mvDrapeIndex      *m_DrapeIndex;
+    int                m_TopIsPlanar;
+    double             m_PlanarTop;
+
     int                ReadESRIShapeFile(const char *errMsg);
+    int                GetFilterBounds(double *bounds);
     int                ReadDxfFile(const char *errMsg);
+    void               TessellateArcs(double tolerance);
     void               Build();
+    void               BuildDrapeIndex();
+    void               ComputeVertices();
+    void               ComputeEntityVertices(int first, int last);
+    void               ClearVertices();
 };
 
 #endif
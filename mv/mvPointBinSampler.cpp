@@ -0,0 +1,174 @@
+#include "mvPointBinSampler.h"
+#include "vtkCellArray.h"
+#include "vtkDataSet.h"
+#include "vtkInformation.h"
+#include "vtkInformationVector.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+
+#include <vtkObjectFactory.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+vtkStandardNewMacro(mvPointBinSampler);
+
+// This must be below vtkStandardNewMacro
+#if defined(_MSC_VER) && defined(_DEBUG) && defined(MV_DEBUG_MEMORY_LEAKS)
+#include <afx.h>
+#define new DEBUG_NEW
+#undef THIS_FILE
+static char THIS_FILE[] = __FILE__;
+#endif
+
+mvPointBinSampler::mvPointBinSampler()
+{
+    m_BinSize  = 0;
+    m_Scale[0] = 1;
+    m_Scale[1] = 1;
+    m_Scale[2] = 1;
+}
+
+mvPointBinSampler::~mvPointBinSampler()
+{
+}
+
+void mvPointBinSampler::SetBinSize(double binSize)
+{
+    if (binSize != m_BinSize)
+    {
+        m_BinSize = binSize;
+        Modified();
+    }
+}
+
+void mvPointBinSampler::SetScale(double xScale, double yScale, double zScale)
+{
+    if (xScale != m_Scale[0] || yScale != m_Scale[1] || zScale != m_Scale[2])
+    {
+        m_Scale[0] = xScale;
+        m_Scale[1] = yScale;
+        m_Scale[2] = zScale;
+        Modified();
+    }
+}
+
+int mvPointBinSampler::FillInputPortInformation(int port, vtkInformation *info)
+{
+    info->Set(vtkAlgorithm::INPUT_REQUIRED_DATA_TYPE(), "vtkDataSet");
+    return 1;
+}
+
+int mvPointBinSampler::RequestData(vtkInformation *request, vtkInformationVector **inputVector,
+                                   vtkInformationVector *outputVector)
+{
+    vtkDataSet  *input  = vtkDataSet::GetData(inputVector[0]);
+    vtkPolyData *output = vtkPolyData::GetData(outputVector);
+    if (input == nullptr || output == nullptr)
+    {
+        return 0;
+    }
+
+    vtkIdType np = input->GetNumberOfPoints();
+    if (np == 0)
+    {
+        return 1;
+    }
+
+    std::vector<vtkIdType> keep;
+    double                 x[3];
+    if (m_BinSize <= 0)
+    {
+        keep.resize(np);
+        for (vtkIdType i = 0; i < np; i++)
+        {
+            keep[i] = i;
+        }
+    }
+    else
+    {
+        double    bounds[6];
+        double    origin[3];
+        double    extent[3];
+        vtkIdType nbin[3];
+        input->GetBounds(bounds);
+        for (int i = 0; i < 3; i++)
+        {
+            origin[i] = bounds[2 * i] * m_Scale[i];
+            extent[i] = (bounds[2 * i + 1] - bounds[2 * i]) * m_Scale[i];
+        }
+
+        // At a deep zoom the bins are made larger, if needed, so that the
+        // number of bins along each side is small enough for the bin keys
+        // to fit in a vtkIdType
+        double maxBins = std::floor(std::cbrt(static_cast<double>(std::numeric_limits<vtkIdType>::max()))) - 1;
+        double binSize = m_BinSize;
+        for (int i = 0; i < 3; i++)
+        {
+            binSize = std::max(binSize, extent[i] / maxBins);
+        }
+        for (int i = 0; i < 3; i++)
+        {
+            nbin[i] = std::min(static_cast<vtkIdType>(extent[i] / binSize) + 1, static_cast<vtkIdType>(maxBins));
+        }
+
+        // For each occupied bin, the point closest to the bin center
+        // and its squared distance from the center
+        std::unordered_map<vtkIdType, std::pair<vtkIdType, double>> bins;
+        bins.reserve(np);
+        for (vtkIdType i = 0; i < np; i++)
+        {
+            input->GetPoint(i, x);
+            vtkIdType ijk[3];
+            double    d2 = 0;
+            for (int j = 0; j < 3; j++)
+            {
+                double s = (x[j] * m_Scale[j] - origin[j]) / binSize;
+                ijk[j]   = std::min(static_cast<vtkIdType>(s), nbin[j] - 1);
+                double d = s - ijk[j] - 0.5;
+                d2 += d * d;
+            }
+            vtkIdType key = ijk[0] + nbin[0] * (ijk[1] + nbin[1] * ijk[2]);
+            auto      it  = bins.find(key);
+            if (it == bins.end())
+            {
+                bins[key] = std::make_pair(i, d2);
+            }
+            else if (d2 < it->second.second)
+            {
+                it->second = std::make_pair(i, d2);
+            }
+        }
+        keep.reserve(bins.size());
+        for (auto &bin : bins)
+        {
+            keep.push_back(bin.second.first);
+        }
+        // keep the input order so the output does not depend on hashing
+        std::sort(keep.begin(), keep.end());
+    }
+
+    vtkIdType                    n      = static_cast<vtkIdType>(keep.size());
+    vtkSmartPointer<vtkPoints>    points = vtkSmartPointer<vtkPoints>::New();
+    vtkSmartPointer<vtkCellArray> verts  = vtkSmartPointer<vtkCellArray>::New();
+    points->SetNumberOfPoints(n);
+    verts->AllocateExact(n, n);
+    vtkPointData *inPD  = input->GetPointData();
+    vtkPointData *outPD = output->GetPointData();
+    outPD->CopyAllocate(inPD, n);
+    for (vtkIdType i = 0; i < n; i++)
+    {
+        input->GetPoint(keep[i], x);
+        points->SetPoint(i, x);
+        outPD->CopyData(inPD, keep[i], i);
+        verts->InsertNextCell(1, &i);
+    }
+    output->SetPoints(points);
+    output->SetVerts(verts);
+    return 1;
+}
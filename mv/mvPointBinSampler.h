@@ -0,0 +1,37 @@
+#ifndef __mvPointBinSampler_h
+#define __mvPointBinSampler_h
+
+#include "mvHeader.h"
+#include "vtkPolyDataAlgorithm.h"
+
+/**
+ * Thins a set of points by dividing space into a uniform grid of cubic
+ * bins and keeping, for each occupied bin, the point nearest the bin
+ * center. Coordinates are multiplied by the scale before binning so the
+ * bin size refers to displayed (exaggerated) distances. Point data are
+ * passed for the kept points, and each kept point is given a vertex cell.
+ * If the bin size is not positive, all points are passed.
+ */
+class MV_EXPORT mvPointBinSampler : public vtkPolyDataAlgorithm
+{
+public:
+    vtkTypeMacro(mvPointBinSampler, vtkPolyDataAlgorithm);
+    static mvPointBinSampler *New();
+
+    void   SetBinSize(double binSize);
+    double GetBinSize() const { return m_BinSize; }
+    void   SetScale(double xScale, double yScale, double zScale);
+
+protected:
+    mvPointBinSampler();
+    ~mvPointBinSampler() override;
+
+    int    FillInputPortInformation(int port, vtkInformation *info) override;
+    int    RequestData(vtkInformation *request, vtkInformationVector **inputVector,
+                       vtkInformationVector *outputVector) override;
+
+    double m_BinSize;
+    double m_Scale[3];
+};
+
+#endif